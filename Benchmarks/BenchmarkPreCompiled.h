@@ -0,0 +1,15 @@
+#pragma once
+// The engine headers expect the standard headers from the engine's precompiled header, which also pulls in D3D12. This
+// is forced into every file of the benchmarks instead so that they build on any platform
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <algorithm>
+
+#include "Defines.h"
+#include "Types.h"
\ No newline at end of file
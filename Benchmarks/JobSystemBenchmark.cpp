@@ -0,0 +1,145 @@
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <thread>
+
+#include "Core/JobSystem.h"
+#include "Application/Log.h"
+
+/*
+* NullOutputDevice - The engine's console is not created here. The JobSystem logs every time it is initialized, which
+* would break up the results, so the log is dropped
+*/
+
+class NullOutputDevice : public GenericOutputDevice
+{
+public:
+	virtual void Print(const std::string&) override
+	{
+	}
+
+	virtual void Clear() override
+	{
+	}
+
+	virtual void SetTitle(const std::string&) override
+	{
+	}
+
+	virtual void SetColor(EConsoleColor) override
+	{
+	}
+};
+
+GenericOutputDevice* GlobalOutputDevices::Console = nullptr;
+
+/*
+* Workloads
+*/
+
+struct Workload
+{
+	const Char*	Name;
+	UInt32		Count;
+	UInt32		BatchSize;
+	UInt32		Iterations;
+};
+
+// A fixed amount of floating point work for each element, the result is stored so that it cannot be optimized away
+static FORCEINLINE Float ProcessElement(UInt32 Index, UInt32 Iterations)
+{
+	Float Value = static_cast<Float>(Index & 1023) * 0.001f;
+	for (UInt32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		Value = std::sqrt(Value * Value + 1.0f) * 0.5f;
+	}
+
+	return Value;
+}
+
+static Double RunWorkload(const Workload& CurrentWorkload, TArray<Float>& Results)
+{
+	const auto Start = std::chrono::high_resolution_clock::now();
+	ParallelForBatch(CurrentWorkload.Count, [&](UInt32 Begin, UInt32 End)
+	{
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			Results[Index] = ProcessElement(Index, CurrentWorkload.Iterations);
+		}
+	}, CurrentWorkload.BatchSize);
+
+	const auto End = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<Double, std::milli>(End - Start).count();
+}
+
+/*
+* Main - Runs every workload with 1 to N threads, N is the first argument or the number of hardware threads
+*/
+
+int main(int Argc, char** Argv)
+{
+	UInt32 MaxThreads = (Argc > 1) ? static_cast<UInt32>(atoi(Argv[1])) : std::thread::hardware_concurrency();
+	MaxThreads = std::max(MaxThreads, 1u);
+
+	constexpr UInt32 NumRuns = 11;
+
+	const Workload Workloads[] =
+	{
+		{ "Compute, 1M elements, batches of 1024",	1024 * 1024,	1024,	8 },
+		{ "Fine grained, 1M elements, batches of 64",	1024 * 1024,	64,		4 },
+	};
+
+	NullOutputDevice OutputDevice;
+	GlobalOutputDevices::Console = &OutputDevice;
+
+	printf("Hardware threads: %u\n", std::thread::hardware_concurrency());
+
+	Int32 NumErrors = 0;
+	for (const Workload& CurrentWorkload : Workloads)
+	{
+		printf("\n%s\n", CurrentWorkload.Name);
+		printf("%8s %12s %10s %12s\n", "Threads", "Median ms", "Speedup", "Efficiency");
+
+		TArray<Float> Expected(CurrentWorkload.Count);
+		for (UInt32 Index = 0; Index < CurrentWorkload.Count; Index++)
+		{
+			Expected[Index] = ProcessElement(Index, CurrentWorkload.Iterations);
+		}
+
+		Double SingleThreadTime = 0.0;
+		for (UInt32 NumThreads = 1; NumThreads <= MaxThreads; NumThreads++)
+		{
+			JobSystem::Initialize(NumThreads - 1);
+
+			TArray<Float> Results(CurrentWorkload.Count);
+			RunWorkload(CurrentWorkload, Results);
+
+			Double Times[NumRuns];
+			for (UInt32 Run = 0; Run < NumRuns; Run++)
+			{
+				Times[Run] = RunWorkload(CurrentWorkload, Results);
+			}
+
+			JobSystem::Release();
+
+			if (memcmp(Results.Data(), Expected.Data(), sizeof(Float) * CurrentWorkload.Count) != 0)
+			{
+				printf("Results with %u threads differ from the serial results\n", NumThreads);
+				NumErrors++;
+			}
+
+			std::sort(Times, Times + NumRuns);
+			const Double Median = Times[NumRuns / 2];
+			if (NumThreads == 1)
+			{
+				SingleThreadTime = Median;
+			}
+
+			const Double Speedup = SingleThreadTime / Median;
+			printf("%8u %12.3f %9.2fx %11.0f%%\n", NumThreads, Median, Speedup, (Speedup / NumThreads) * 100.0);
+		}
+	}
+
+	GlobalOutputDevices::Console = nullptr;
+	return NumErrors;
+}
@@ -5,10 +5,48 @@
 #include "Utilities/TUtilities.h"
 
 /*
-* Dynamic Array similar to std::vector
+* TDefaultArrayAllocator - Allocates the elements of a TArray on the heap. An allocator can also provide inline storage
+* that is used as long as the array fits in it, see TInlineArrayAllocator.
 */
 template<typename T>
-class TArray
+class TDefaultArrayAllocator
+{
+public:
+	FORCEINLINE T* GetInlineElements() noexcept
+	{
+		return nullptr;
+	}
+
+	FORCEINLINE UInt32 GetInlineCapacity() const noexcept
+	{
+		return 0;
+	}
+
+	FORCEINLINE T* AllocateElements(UInt32 Capacity) noexcept
+	{
+		return reinterpret_cast<T*>(malloc(static_cast<size_t>(sizeof(T)) * Capacity));
+	}
+
+	FORCEINLINE void FreeElements(T* Elements) noexcept
+	{
+		free(Elements);
+	}
+
+	// Allocators that can change the size of an allocation without moving it return true
+	FORCEINLINE bool ResizeElements(T* Elements, UInt32 OldCapacity, UInt32 NewCapacity) noexcept
+	{
+		UNREFERENCED_VARIABLE(Elements);
+		UNREFERENCED_VARIABLE(OldCapacity);
+		UNREFERENCED_VARIABLE(NewCapacity);
+		return false;
+	}
+};
+
+/*
+* Dynamic Array similar to std::vector
+*/
+template<typename T, typename TAllocator = TDefaultArrayAllocator<T>>
+class TArray : private TAllocator
 {
 public:
 	typedef UInt32 SizeType;
@@ -245,57 +283,64 @@ public:
 	*/
 public:
 	FORCEINLINE TArray() noexcept
-		: ArrayPtr(nullptr)
+		: TAllocator()
+		, ArrayPtr(TAllocator::GetInlineElements())
 		, ArraySize(0)
-		, ArrayCapacity(0)
+		, ArrayCapacity(TAllocator::GetInlineCapacity())
 	{
 	}
 
 	FORCEINLINE explicit TArray(SizeType Size) noexcept
-		: ArrayPtr(nullptr)
+		: TAllocator()
+		, ArrayPtr(TAllocator::GetInlineElements())
 		, ArraySize(0)
-		, ArrayCapacity(0)
+		, ArrayCapacity(TAllocator::GetInlineCapacity())
 	{
 		InternalConstruct(Size);
 	}
 
 	FORCEINLINE explicit TArray(SizeType Size, const T& Value) noexcept
-		: ArrayPtr(nullptr)
+		: TAllocator()
+		, ArrayPtr(TAllocator::GetInlineElements())
 		, ArraySize(0)
-		, ArrayCapacity(0)
+		, ArrayCapacity(TAllocator::GetInlineCapacity())
 	{
 		InternalConstruct(Size, Value);
 	}
 
 	template<typename TInputIt>
 	FORCEINLINE explicit TArray(TInputIt InBegin, TInputIt InEnd) noexcept
-		: ArrayPtr(nullptr)
+		: TAllocator()
+		, ArrayPtr(TAllocator::GetInlineElements())
 		, ArraySize(0)
-		, ArrayCapacity(0)
+		, ArrayCapacity(TAllocator::GetInlineCapacity())
 	{
 		InternalConstruct(InBegin, InEnd);
 	}
 
 	FORCEINLINE TArray(std::initializer_list<T> IList) noexcept
-		: ArrayPtr(nullptr)
+		: TAllocator()
+		, ArrayPtr(TAllocator::GetInlineElements())
 		, ArraySize(0)
-		, ArrayCapacity(0)
+		, ArrayCapacity(TAllocator::GetInlineCapacity())
 	{
 		InternalConstruct(IList.begin(), IList.end());
 	}
 
 	FORCEINLINE TArray(const TArray& Other) noexcept
-		: ArrayPtr(nullptr)
+		: TAllocator(Other)
+		, ArrayPtr(TAllocator::GetInlineElements())
 		, ArraySize(0)
-		, ArrayCapacity(0)
+		, ArrayCapacity(TAllocator::GetInlineCapacity())
 	{
 		InternalConstruct(Other.begin(), Other.end());
 	}
 
 	FORCEINLINE TArray(TArray&& Other) noexcept
-		: ArrayPtr(nullptr)
+		: TAllocator(Other)
+		, ArrayPtr(TAllocator::GetInlineElements())
 		, ArraySize(0)
-		, ArrayCapacity(0)
+		, ArrayCapacity(TAllocator::GetInlineCapacity())
 	{
 		InternalMove(::Move(Other));
 	}
@@ -380,6 +425,12 @@ public:
 
 	FORCEINLINE void Reserve(SizeType InCapacity) noexcept
 	{
+		InCapacity = InternalGetAllocationCapacity(InCapacity);
+		if (InCapacity != ArrayCapacity && InCapacity >= ArraySize && InternalTryResize(InCapacity))
+		{
+			return;
+		}
+
 		if (InCapacity != ArrayCapacity)
 		{
 			SizeType OldSize = ArraySize;
@@ -535,7 +586,7 @@ public:
 	FORCEINLINE Iterator Insert(ConstIterator Pos, TInputIt InBegin, TInputIt InEnd) noexcept
 	{
 		// Insert at InEnd
-		if (Pos == ConstEnd())
+		if (Pos == cend())
 		{
 			const SizeType OldSize = ArraySize;
 			for (TInputIt It = InBegin; It != InEnd; It++)
@@ -640,7 +691,19 @@ public:
 
 	FORCEINLINE void Swap(TArray& Other) noexcept
 	{
-		if (this != std::addressof(Other))
+		if (this == std::addressof(Other))
+		{
+			return;
+		}
+
+		// Elements in inline storage cannot change owner, so they are moved instead
+		if (InternalIsInline() || Other.InternalIsInline())
+		{
+			TArray Temp(::Move(Other));
+			Other = ::Move(*this);
+			(*this) = ::Move(Temp);
+		}
+		else
 		{
 			T* tempPtr = ArrayPtr;
 			SizeType tempSize = ArraySize;
@@ -886,7 +949,7 @@ private:
 		}
 		else
 		{
-			return static_cast<SizeType>(std::Distance(InBegin, InEnd));
+			return static_cast<SizeType>(std::distance(InBegin, InEnd));
 		}
 	}
 
@@ -906,19 +969,51 @@ private:
 		return BaseSize + (ArrayCapacity / 2) + 1;
 	}
 
+	// Arrays never use less than the inline storage
+	FORCEINLINE SizeType InternalGetAllocationCapacity(SizeType InCapacity)
+	{
+		const SizeType InlineCapacity = TAllocator::GetInlineCapacity();
+		return (InCapacity > InlineCapacity) ? InCapacity : InlineCapacity;
+	}
+
+	FORCEINLINE bool InternalIsInline()
+	{
+		return (ArrayPtr == TAllocator::GetInlineElements());
+	}
+
+	// Keeps the elements where they are if the allocator can resize the allocation, never used for inline storage
+	FORCEINLINE bool InternalTryResize(SizeType InCapacity)
+	{
+		if (InternalIsInline() || InCapacity <= TAllocator::GetInlineCapacity())
+		{
+			return false;
+		}
+
+		if (TAllocator::ResizeElements(ArrayPtr, ArrayCapacity, InCapacity))
+		{
+			ArrayCapacity = InCapacity;
+			return true;
+		}
+
+		return false;
+	}
+
 	FORCEINLINE T* InternalAllocateElements(SizeType InCapacity)
 	{
-		constexpr SizeType ElementByteSize = sizeof(T);
-		const SizeType SizeInBytes = ElementByteSize * InCapacity;
-		return reinterpret_cast<T*>(malloc(static_cast<size_t>(SizeInBytes)));
+		if (InCapacity <= TAllocator::GetInlineCapacity())
+		{
+			return TAllocator::GetInlineElements();
+		}
+
+		return TAllocator::AllocateElements(InCapacity);
 	}
 
 	FORCEINLINE void InternalReleaseData()
 	{
-		if (ArrayPtr)
+		if (!InternalIsInline())
 		{
-			free(ArrayPtr);
-			ArrayPtr = nullptr;
+			TAllocator::FreeElements(ArrayPtr);
+			ArrayPtr = TAllocator::GetInlineElements();
 		}
 	}
 
@@ -934,6 +1029,12 @@ private:
 
 	FORCEINLINE void InternalRealloc(SizeType InCapacity)
 	{
+		InCapacity = InternalGetAllocationCapacity(InCapacity);
+		if (InCapacity == ArrayCapacity || InternalTryResize(InCapacity))
+		{
+			return;
+		}
+
 		T* TempData = InternalAllocateElements(InCapacity);
 		InternalMoveEmplace(ArrayPtr, ArrayPtr + ArraySize, TempData);
 		InternalDestructRange(ArrayPtr, ArrayPtr + ArraySize);
@@ -948,6 +1049,12 @@ private:
 	{
 		VALIDATE(InCapacity >= ArraySize + Count);
 
+		InCapacity = InternalGetAllocationCapacity(InCapacity);
+		if (EmplacePos == ArrayPtr + ArraySize && InternalTryResize(InCapacity))
+		{
+			return;
+		}
+
 		const SizeType Index = InternalIndex(EmplacePos);
 		T* TempData = InternalAllocateElements(InCapacity);
 		InternalMoveEmplace(ArrayPtr, EmplacePos, TempData);
@@ -1001,13 +1108,26 @@ private:
 	{
 		InternalReleaseData();
 
-		ArrayPtr = Other.ArrayPtr;
-		ArraySize = Other.ArraySize;
-		ArrayCapacity = Other.ArrayCapacity;
+		if (Other.InternalIsInline())
+		{
+			// Both arrays have the same inline capacity so the elements always fit
+			ArrayCapacity = TAllocator::GetInlineCapacity();
+			InternalMoveEmplace(Other.ArrayPtr, Other.ArrayPtr + Other.ArraySize, ArrayPtr);
+			InternalDestructRange(Other.ArrayPtr, Other.ArrayPtr + Other.ArraySize);
+			ArraySize = Other.ArraySize;
+
+			Other.ArraySize = 0;
+		}
+		else
+		{
+			ArrayPtr = Other.ArrayPtr;
+			ArraySize = Other.ArraySize;
+			ArrayCapacity = Other.ArrayCapacity;
 
-		Other.ArrayPtr = nullptr;
-		Other.ArraySize = 0;
-		Other.ArrayCapacity = 0;
+			Other.ArrayPtr = Other.TAllocator::GetInlineElements();
+			Other.ArraySize = 0;
+			Other.ArrayCapacity = Other.TAllocator::GetInlineCapacity();
+		}
 	}
 
 	// Emplace
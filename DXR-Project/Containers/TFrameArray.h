@@ -0,0 +1,43 @@
+#pragma once
+#include "TArray.h"
+
+#include "Memory/FrameAllocator.h"
+
+/*
+* TFrameArrayAllocator - Allocates the elements of a TArray with the FrameAllocator, nothing is freed until the frame
+* memory is recycled
+*/
+template<typename T>
+class TFrameArrayAllocator
+{
+public:
+	FORCEINLINE T* GetInlineElements() noexcept
+	{
+		return nullptr;
+	}
+
+	FORCEINLINE UInt32 GetInlineCapacity() const noexcept
+	{
+		return 0;
+	}
+
+	FORCEINLINE T* AllocateElements(UInt32 Capacity) noexcept
+	{
+		return reinterpret_cast<T*>(FrameAllocator::Malloc(static_cast<UInt64>(sizeof(T)) * Capacity, alignof(T)));
+	}
+
+	FORCEINLINE void FreeElements(T*) noexcept
+	{
+	}
+
+	FORCEINLINE bool ResizeElements(T* Elements, UInt32 OldCapacity, UInt32 NewCapacity) noexcept
+	{
+		return FrameAllocator::TryResize(Elements, static_cast<UInt64>(sizeof(T)) * OldCapacity, static_cast<UInt64>(sizeof(T)) * NewCapacity);
+	}
+};
+
+/*
+* TFrameArray - TArray for temporary data that is thrown away at the end of the frame, can be used from any thread
+*/
+template<typename T>
+using TFrameArray = TArray<T, TFrameArrayAllocator<T>>;
@@ -0,0 +1,90 @@
+#pragma once
+#include "THashTable.h"
+
+/*
+* TPair - Element of a THashMap, the key must not be changed while the pair is in the map
+*/
+template<typename TKey, typename TValue>
+struct TPair
+{
+	TPair() = default;
+
+	template<typename TKeyArg, typename... TArgs, typename = std::enable_if_t<!std::is_same<std::decay_t<TKeyArg>, TPair>::value>>
+	FORCEINLINE TPair(TKeyArg&& InKey, TArgs&&... Args)
+		: Key(Forward<TKeyArg>(InKey))
+		, Value(Forward<TArgs>(Args)...)
+	{
+	}
+
+	TKey	Key;
+	TValue	Value;
+};
+
+template<typename TKey, typename TValue>
+struct TPairKeyFuncs
+{
+	static FORCEINLINE const TKey& GetKey(const TPair<TKey, TValue>& Pair)
+	{
+		return Pair.Key;
+	}
+};
+
+/*
+* THashMap - Hashmap similar to std::unordered_map without a node per element, see THashTable
+*/
+template<typename TKey, typename TValue, typename THasher = std::hash<TKey>, typename TKeyEqual = std::equal_to<TKey>>
+class THashMap : public THashTable<TKey, TPair<TKey, TValue>, TPairKeyFuncs<TKey, TValue>, THasher, TKeyEqual>
+{
+	typedef THashTable<TKey, TPair<TKey, TValue>, TPairKeyFuncs<TKey, TValue>, THasher, TKeyEqual> Super;
+
+public:
+	typedef TPair<TKey, TValue>		ElementType;
+	typedef typename Super::SizeType	SizeType;
+
+	using Super::Super;
+
+	// Inserts a new value or replaces the existing value for the key
+	template<typename TKeyArg, typename... TArgs>
+	FORCEINLINE TValue& Emplace(TKeyArg&& Key, TArgs&&... Args) noexcept
+	{
+		const UInt32	Hash	= Super::InternalHash(Key);
+		const SizeType	Slot	= (Super::NumElements > 0) ? Super::InternalFind(Key, Hash) : Super::InvalidSlot;
+		if (Slot != Super::InvalidSlot)
+		{
+			TValue& Value = Super::Elements[Slot].Value;
+			Value = TValue(Forward<TArgs>(Args)...);
+			return Value;
+		}
+
+		// The insert can reallocate the elements
+		const SizeType NewSlot = Super::InternalInsert(Hash, Forward<TKeyArg>(Key), Forward<TArgs>(Args)...);
+		return Super::Elements[NewSlot].Value;
+	}
+
+	// Returns the value for the key, a default constructed value is inserted if the key is not in the map
+	FORCEINLINE TValue& operator[](const TKey& Key) noexcept
+	{
+		const UInt32	Hash	= Super::InternalHash(Key);
+		const SizeType	Slot	= (Super::NumElements > 0) ? Super::InternalFind(Key, Hash) : Super::InvalidSlot;
+		if (Slot != Super::InvalidSlot)
+		{
+			return Super::Elements[Slot].Value;
+		}
+
+		const SizeType NewSlot = Super::InternalInsert(Hash, Key);
+		return Super::Elements[NewSlot].Value;
+	}
+
+	// Returns nullptr if the key is not in the map
+	FORCEINLINE TValue* Find(const TKey& Key) noexcept
+	{
+		const SizeType Slot = Super::InternalFind(Key);
+		return (Slot != Super::InvalidSlot) ? &Super::Elements[Slot].Value : nullptr;
+	}
+
+	FORCEINLINE const TValue* Find(const TKey& Key) const noexcept
+	{
+		const SizeType Slot = Super::InternalFind(Key);
+		return (Slot != Super::InvalidSlot) ? &Super::Elements[Slot].Value : nullptr;
+	}
+};
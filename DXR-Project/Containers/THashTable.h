@@ -0,0 +1,460 @@
+#pragma once
+#include "Defines.h"
+#include "Types.h"
+
+#include "Utilities/TUtilities.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+
+/*
+* THashTable - Open addressing hashtable with Robin Hood probing and backward shift deletion, used by THashMap and
+* TSet. All elements are stored in one allocation together with 32 bits of the hash for each slot. The top bit of the
+* stored hash marks the slot as occupied, the rest skips most of the key comparisons and gives the probe distance
+* without hashing the key again. Pointers and iterators are invalidated when the table grows or an element is removed.
+*/
+template<typename TKey, typename TElement, typename TKeyFuncs, typename THasher, typename TKeyEqual>
+class THashTable
+{
+public:
+	typedef UInt32 SizeType;
+
+	/*
+	* TIterator - Visits the occupied slots, the order is unspecified
+	*/
+	template<typename TTable, typename TIteratorType>
+	class TIterator
+	{
+	public:
+		FORCEINLINE TIterator(TTable* InTable, SizeType InSlot)
+			: Table(InTable)
+			, Slot(InSlot)
+		{
+			SkipEmptySlots();
+		}
+
+		FORCEINLINE TIteratorType& operator*() const
+		{
+			return Table->Elements[Slot];
+		}
+
+		FORCEINLINE TIteratorType* operator->() const
+		{
+			return &Table->Elements[Slot];
+		}
+
+		FORCEINLINE TIterator& operator++()
+		{
+			Slot++;
+			SkipEmptySlots();
+			return *this;
+		}
+
+		FORCEINLINE bool operator==(const TIterator& Other) const
+		{
+			return (Slot == Other.Slot) && (Table == Other.Table);
+		}
+
+		FORCEINLINE bool operator!=(const TIterator& Other) const
+		{
+			return !(*this == Other);
+		}
+
+	private:
+		FORCEINLINE void SkipEmptySlots()
+		{
+			while (Slot < Table->NumSlots && Table->Hashes[Slot] == 0)
+			{
+				Slot++;
+			}
+		}
+
+		TTable*		Table;
+		SizeType	Slot;
+	};
+
+	typedef TIterator<THashTable, TElement>				Iterator;
+	typedef TIterator<const THashTable, const TElement>	ConstIterator;
+
+	FORCEINLINE THashTable() noexcept
+		: Elements(nullptr)
+		, Hashes(nullptr)
+		, NumElements(0)
+		, NumSlots(0)
+		, Hasher()
+		, KeyEqual()
+	{
+	}
+
+	FORCEINLINE explicit THashTable(const THasher& InHasher, const TKeyEqual& InKeyEqual = TKeyEqual()) noexcept
+		: Elements(nullptr)
+		, Hashes(nullptr)
+		, NumElements(0)
+		, NumSlots(0)
+		, Hasher(InHasher)
+		, KeyEqual(InKeyEqual)
+	{
+	}
+
+	FORCEINLINE THashTable(const THashTable& Other) noexcept
+		: Elements(nullptr)
+		, Hashes(nullptr)
+		, NumElements(0)
+		, NumSlots(0)
+		, Hasher(Other.Hasher)
+		, KeyEqual(Other.KeyEqual)
+	{
+		InternalCopy(Other);
+	}
+
+	FORCEINLINE THashTable(THashTable&& Other) noexcept
+		: Elements(Other.Elements)
+		, Hashes(Other.Hashes)
+		, NumElements(Other.NumElements)
+		, NumSlots(Other.NumSlots)
+		, Hasher(Move(Other.Hasher))
+		, KeyEqual(Move(Other.KeyEqual))
+	{
+		Other.Elements		= nullptr;
+		Other.Hashes		= nullptr;
+		Other.NumElements	= 0;
+		Other.NumSlots		= 0;
+	}
+
+	FORCEINLINE ~THashTable()
+	{
+		InternalRelease();
+	}
+
+	FORCEINLINE THashTable& operator=(const THashTable& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			Clear();
+			Hasher		= Other.Hasher;
+			KeyEqual	= Other.KeyEqual;
+			InternalCopy(Other);
+		}
+
+		return *this;
+	}
+
+	FORCEINLINE THashTable& operator=(THashTable&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			InternalRelease();
+
+			Elements	= Other.Elements;
+			Hashes		= Other.Hashes;
+			NumElements	= Other.NumElements;
+			NumSlots	= Other.NumSlots;
+			Hasher		= Move(Other.Hasher);
+			KeyEqual	= Move(Other.KeyEqual);
+
+			Other.Elements		= nullptr;
+			Other.Hashes		= nullptr;
+			Other.NumElements	= 0;
+			Other.NumSlots		= 0;
+		}
+
+		return *this;
+	}
+
+	// Makes room for Count elements without growing again
+	FORCEINLINE void Reserve(SizeType Count) noexcept
+	{
+		const SizeType RequiredSlots = InternalGetSlotCount(Count);
+		if (RequiredSlots > NumSlots)
+		{
+			InternalRehash(RequiredSlots);
+		}
+	}
+
+	// Destroys all elements but keeps the memory
+	FORCEINLINE void Clear() noexcept
+	{
+		for (SizeType Slot = 0; Slot < NumSlots; Slot++)
+		{
+			if (Hashes[Slot] != 0)
+			{
+				Elements[Slot].~TElement();
+				Hashes[Slot] = 0;
+			}
+		}
+
+		NumElements = 0;
+	}
+
+	FORCEINLINE bool Remove(const TKey& Key) noexcept
+	{
+		const SizeType Slot = InternalFind(Key);
+		if (Slot == InvalidSlot)
+		{
+			return false;
+		}
+
+		InternalRemoveAt(Slot);
+		return true;
+	}
+
+	FORCEINLINE bool Contains(const TKey& Key) const noexcept
+	{
+		return (InternalFind(Key) != InvalidSlot);
+	}
+
+	FORCEINLINE SizeType Size() const noexcept
+	{
+		return NumElements;
+	}
+
+	FORCEINLINE bool IsEmpty() const noexcept
+	{
+		return (NumElements == 0);
+	}
+
+	// Number of elements that fit before the table grows
+	FORCEINLINE SizeType Capacity() const noexcept
+	{
+		return InternalGetMaxElements(NumSlots);
+	}
+
+	FORCEINLINE Iterator begin() noexcept
+	{
+		return Iterator(this, 0);
+	}
+
+	FORCEINLINE Iterator end() noexcept
+	{
+		return Iterator(this, NumSlots);
+	}
+
+	FORCEINLINE ConstIterator begin() const noexcept
+	{
+		return ConstIterator(this, 0);
+	}
+
+	FORCEINLINE ConstIterator end() const noexcept
+	{
+		return ConstIterator(this, NumSlots);
+	}
+
+protected:
+	static constexpr SizeType InvalidSlot	= ~0u;
+	static constexpr SizeType MinSlots		= 8;
+
+	// Std::hash is the identity for integers and pointers on some platforms, multiplying spreads the bits over the upper
+	// half which is what the table uses
+	FORCEINLINE UInt32 InternalHash(const TKey& Key) const
+	{
+		const UInt64 Hash = static_cast<UInt64>(Hasher(Key)) * 0x9e3779b97f4a7c15ull;
+		return static_cast<UInt32>(Hash >> 32) | 0x80000000u;
+	}
+
+	FORCEINLINE SizeType InternalFind(const TKey& Key) const
+	{
+		if (NumElements == 0)
+		{
+			return InvalidSlot;
+		}
+
+		return InternalFind(Key, InternalHash(Key));
+	}
+
+	FORCEINLINE SizeType InternalFind(const TKey& Key, UInt32 Hash) const
+	{
+		const SizeType Mask = NumSlots - 1;
+
+		SizeType Slot		= Hash & Mask;
+		SizeType Distance	= 0;
+		for (;;)
+		{
+			const UInt32 SlotHash = Hashes[Slot];
+
+			// The element would have displaced anything closer to its home slot
+			if (SlotHash == 0 || ((Slot - SlotHash) & Mask) < Distance)
+			{
+				return InvalidSlot;
+			}
+
+			if (SlotHash == Hash && KeyEqual(TKeyFuncs::GetKey(Elements[Slot]), Key))
+			{
+				return Slot;
+			}
+
+			Slot = (Slot + 1) & Mask;
+			Distance++;
+		}
+	}
+
+	// Inserts an element with a key that is not in the table yet and returns its slot
+	template<typename... TArgs>
+	FORCEINLINE SizeType InternalInsert(UInt32 Hash, TArgs&&... Args)
+	{
+		if (NumElements >= InternalGetMaxElements(NumSlots))
+		{
+			InternalRehash((NumSlots > 0) ? (NumSlots * 2) : MinSlots);
+		}
+
+		return InternalEmplace(Hash, Forward<TArgs>(Args)...);
+	}
+
+	// Same as InternalInsert but expects that there is room for the element
+	template<typename... TArgs>
+	FORCEINLINE SizeType InternalEmplace(UInt32 Hash, TArgs&&... Args)
+	{
+		const SizeType Mask = NumSlots - 1;
+
+		SizeType Slot		= Hash & Mask;
+		SizeType Distance	= 0;
+		while (Hashes[Slot] != 0)
+		{
+			const SizeType SlotDistance = (Slot - Hashes[Slot]) & Mask;
+			if (SlotDistance < Distance)
+			{
+				break;
+			}
+
+			Slot = (Slot + 1) & Mask;
+			Distance++;
+		}
+
+		// Take the slot from an element that is closer to its home slot, it and everything after it moves one step
+		const SizeType InsertSlot = Slot;
+		if (Hashes[Slot] != 0)
+		{
+			TElement	Displaced		= Move(Elements[Slot]);
+			UInt32		DisplacedHash	= Hashes[Slot];
+			Elements[Slot].~TElement();
+
+			Distance = (Slot - DisplacedHash) & Mask;
+			for (;;)
+			{
+				Slot = (Slot + 1) & Mask;
+				Distance++;
+
+				if (Hashes[Slot] == 0)
+				{
+					new(reinterpret_cast<Void*>(&Elements[Slot])) TElement(Move(Displaced));
+					Hashes[Slot] = DisplacedHash;
+					break;
+				}
+
+				const SizeType SlotDistance = (Slot - Hashes[Slot]) & Mask;
+				if (SlotDistance < Distance)
+				{
+					std::swap(Displaced, Elements[Slot]);
+					std::swap(DisplacedHash, Hashes[Slot]);
+					Distance = SlotDistance;
+				}
+			}
+		}
+
+		new(reinterpret_cast<Void*>(&Elements[InsertSlot])) TElement(Forward<TArgs>(Args)...);
+		Hashes[InsertSlot] = Hash;
+		NumElements++;
+		return InsertSlot;
+	}
+
+	// Shifts the following elements back until one is found that is empty or already in its home slot
+	FORCEINLINE void InternalRemoveAt(SizeType Slot)
+	{
+		const SizeType Mask = NumSlots - 1;
+
+		Elements[Slot].~TElement();
+		for (;;)
+		{
+			const SizeType Next = (Slot + 1) & Mask;
+			if (Hashes[Next] == 0 || ((Next - Hashes[Next]) & Mask) == 0)
+			{
+				break;
+			}
+
+			new(reinterpret_cast<Void*>(&Elements[Slot])) TElement(Move(Elements[Next]));
+			Elements[Next].~TElement();
+			Hashes[Slot] = Hashes[Next];
+			Slot = Next;
+		}
+
+		Hashes[Slot] = 0;
+		NumElements--;
+	}
+
+	// The table is kept at most 7/8 full
+	static FORCEINLINE SizeType InternalGetMaxElements(SizeType SlotCount)
+	{
+		return SlotCount - (SlotCount / 8);
+	}
+
+	static FORCEINLINE SizeType InternalGetSlotCount(SizeType Count)
+	{
+		SizeType SlotCount = MinSlots;
+		while (InternalGetMaxElements(SlotCount) < Count)
+		{
+			SlotCount *= 2;
+		}
+
+		return SlotCount;
+	}
+
+	FORCEINLINE void InternalRehash(SizeType NewNumSlots)
+	{
+		VALIDATE((NewNumSlots & (NewNumSlots - 1)) == 0);
+
+		TElement*		OldElements	= Elements;
+		UInt32*			OldHashes	= Hashes;
+		const SizeType	OldNumSlots	= NumSlots;
+
+		// The hashes are stored after the elements in the same allocation
+		const UInt64 ElementsSize = ((static_cast<UInt64>(sizeof(TElement)) * NewNumSlots) + 3) & ~3ull;
+		Byte* Memory = reinterpret_cast<Byte*>(malloc(static_cast<size_t>(ElementsSize + sizeof(UInt32) * NewNumSlots)));
+		Elements	= reinterpret_cast<TElement*>(Memory);
+		Hashes		= reinterpret_cast<UInt32*>(Memory + ElementsSize);
+		NumSlots	= NewNumSlots;
+		NumElements	= 0;
+		memset(Hashes, 0, sizeof(UInt32) * NewNumSlots);
+
+		for (SizeType Slot = 0; Slot < OldNumSlots; Slot++)
+		{
+			if (OldHashes[Slot] != 0)
+			{
+				InternalEmplace(OldHashes[Slot], Move(OldElements[Slot]));
+				OldElements[Slot].~TElement();
+			}
+		}
+
+		free(OldElements);
+	}
+
+	FORCEINLINE void InternalCopy(const THashTable& Other)
+	{
+		Reserve(Other.NumElements);
+		for (SizeType Slot = 0; Slot < Other.NumSlots; Slot++)
+		{
+			if (Other.Hashes[Slot] != 0)
+			{
+				InternalInsert(Other.Hashes[Slot], Other.Elements[Slot]);
+			}
+		}
+	}
+
+	FORCEINLINE void InternalRelease()
+	{
+		Clear();
+		free(Elements);
+
+		Elements	= nullptr;
+		Hashes		= nullptr;
+		NumSlots	= 0;
+	}
+
+	TElement*	Elements;
+	UInt32*		Hashes;
+	SizeType	NumElements;
+	SizeType	NumSlots;
+	THasher		Hasher;
+	TKeyEqual	KeyEqual;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "TArray.h"
+
+/*
+* TInlineArrayAllocator - Stores up to InlineCapacity elements inside the array itself and only allocates on the heap
+* when the array grows beyond that
+*/
+template<typename T, UInt32 InlineCapacity>
+class TInlineArrayAllocator : public TDefaultArrayAllocator<T>
+{
+	static_assert(InlineCapacity > 0, "TInlineArrayAllocator needs room for at least one element");
+
+public:
+	TInlineArrayAllocator() = default;
+
+	// The inline storage belongs to the array, nothing is copied
+	FORCEINLINE TInlineArrayAllocator(const TInlineArrayAllocator&) noexcept
+		: TDefaultArrayAllocator<T>()
+	{
+	}
+
+	FORCEINLINE TInlineArrayAllocator& operator=(const TInlineArrayAllocator&) noexcept
+	{
+		return *this;
+	}
+
+	FORCEINLINE T* GetInlineElements() noexcept
+	{
+		return reinterpret_cast<T*>(InlineElements);
+	}
+
+	FORCEINLINE UInt32 GetInlineCapacity() const noexcept
+	{
+		return InlineCapacity;
+	}
+
+private:
+	alignas(T) Byte InlineElements[sizeof(T) * InlineCapacity];
+};
+
+/*
+* TInlineArray - TArray for arrays that are usually small. Moving an array that fits in the inline storage moves the
+* elements one by one, so pointers to the elements are invalidated.
+*/
+template<typename T, UInt32 InlineCapacity>
+using TInlineArray = TArray<T, TInlineArrayAllocator<T, InlineCapacity>>;
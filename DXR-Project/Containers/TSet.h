@@ -0,0 +1,48 @@
+#pragma once
+#include "THashTable.h"
+
+template<typename T>
+struct TSetKeyFuncs
+{
+	static FORCEINLINE const T& GetKey(const T& Element)
+	{
+		return Element;
+	}
+};
+
+/*
+* TSet - Hashset similar to std::unordered_set without a node per element, see THashTable. The elements must not be
+* changed while they are in the set.
+*/
+template<typename T, typename THasher = std::hash<T>, typename TKeyEqual = std::equal_to<T>>
+class TSet : public THashTable<T, T, TSetKeyFuncs<T>, THasher, TKeyEqual>
+{
+	typedef THashTable<T, T, TSetKeyFuncs<T>, THasher, TKeyEqual> Super;
+
+public:
+	typedef T							ElementType;
+	typedef typename Super::SizeType	SizeType;
+
+	using Super::Super;
+
+	// Returns false if the element already was in the set
+	template<typename TElementArg>
+	FORCEINLINE bool Insert(TElementArg&& Element) noexcept
+	{
+		const UInt32 Hash = Super::InternalHash(Element);
+		if (Super::NumElements > 0 && Super::InternalFind(Element, Hash) != Super::InvalidSlot)
+		{
+			return false;
+		}
+
+		Super::InternalInsert(Hash, Forward<TElementArg>(Element));
+		return true;
+	}
+
+	// Returns nullptr if the element is not in the set
+	FORCEINLINE const T* Find(const T& Element) const noexcept
+	{
+		const SizeType Slot = Super::InternalFind(Element);
+		return (Slot != Super::InvalidSlot) ? &Super::Elements[Slot] : nullptr;
+	}
+};
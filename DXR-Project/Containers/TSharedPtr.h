@@ -1,12 +1,16 @@
 #pragma once
 #include "TUniquePtr.h"
 
+#include "Memory/PoolAllocator.h"
+
 /*
 * Struct Counting references in TWeak- and TSharedPtr
 */
 
 struct PtrControlBlock
 {
+	POOL_ALLOCATED(PtrControlBlock);
+
 public:
 	typedef UInt32 RefType;
 
@@ -232,7 +236,7 @@ protected:
 	FORCEINLINE void InternalConstructStrong(T* InPtr)
 	{
 		Ptr		= InPtr;
-		Counter	= DBG_NEW PtrControlBlock();
+		Counter	= new PtrControlBlock();
 		InternalAddStrongRef();
 	}
 
@@ -242,7 +246,7 @@ protected:
 		static_assert(std::is_convertible<TOther*, T*>());
 
 		Ptr		= static_cast<T*>(InPtr);
-		Counter	= DBG_NEW PtrControlBlock();
+		Counter	= new PtrControlBlock();
 		InternalAddStrongRef();
 	}
 
@@ -283,7 +287,7 @@ protected:
 	FORCEINLINE void InternalConstructWeak(T* InPtr)
 	{
 		Ptr		= InPtr;
-		Counter	= DBG_NEW PtrControlBlock();
+		Counter	= new PtrControlBlock();
 		InternalAddWeakRef();
 	}
 
@@ -293,7 +297,7 @@ protected:
 		static_assert(std::is_convertible<TOther*, T*>());
 
 		Ptr		= static_cast<T*>(InPtr);
-		Counter	= DBG_NEW PtrControlBlock();
+		Counter	= new PtrControlBlock();
 		InternalAddWeakRef();
 	}
 
@@ -1,20 +1,102 @@
 #include "ClassType.h"
 
+#include "Containers/TArray.h"
+#include "Containers/TUniquePtr.h"
+
+#include <mutex>
+
+/*
+* Registry
+*/
+
+struct ClassRegistry
+{
+	std::mutex Mutex;
+	TArray<ClassType*> Classes;
+	// Readers can still hold an older numbering, so all of them are kept until the registry is destroyed at exit
+	TArray<TUniquePtr<ClassNumbering>> Numberings;
+};
+
+static ClassRegistry& GetClassRegistry()
+{
+	static ClassRegistry Registry;
+	return Registry;
+}
+
+/*
+* ClassType
+*/
+
+std::atomic<const ClassNumbering*> ClassType::CurrentNumbering(nullptr);
+
 ClassType::ClassType(const Char* InName, const ClassType* InSuperClass)
 	: Name(InName)
 	, SuperClass(InSuperClass)
 {
+	ClassRegistry& Registry = GetClassRegistry();
+	std::lock_guard<std::mutex> Lock(Registry.Mutex);
+
+	Index = Registry.Classes.Size();
+	Registry.Classes.EmplaceBack(this);
+	NumberClasses();
 }
 
-bool ClassType::IsSubClassOf(const ClassType* Class) const
+void ClassType::NumberClasses()
 {
-	for (const ClassType* Current = this; Current; Current = Current->GetSuperClass())
+	ClassRegistry& Registry = GetClassRegistry();
+	const TArray<ClassType*>& Classes = Registry.Classes;
+	const UInt32 NumClasses = Classes.Size();
+
+	// Build the lists of subclasses once. Going backwards keeps the subclasses in the order they were registered
+	constexpr UInt32 NoClass = ~0u;
+	TArray<UInt32> FirstChild(NumClasses);
+	TArray<UInt32> NextSibling(NumClasses);
+	for (UInt32 ClassIndex = 0; ClassIndex < NumClasses; ClassIndex++)
+	{
+		FirstChild[ClassIndex] = NoClass;
+	}
+
+	UInt32 FirstRoot = NoClass;
+	for (UInt32 ClassIndex = NumClasses; ClassIndex-- > 0;)
 	{
-		if (Current == Class)
+		const ClassType* Super = Classes[ClassIndex]->SuperClass;
+		UInt32& ListHead = Super ? FirstChild[Super->Index] : FirstRoot;
+		NextSibling[ClassIndex]	= ListHead;
+		ListHead				= ClassIndex;
+	}
+
+	// Depth first traversal without recursion, a class is numbered when it is entered and when it is left
+	TUniquePtr<ClassNumbering> Numbering = MakeUnique<ClassNumbering>();
+	Numbering->Orders.Resize(NumClasses);
+
+	TArray<UInt32> Stack;
+	Stack.Reserve(NumClasses);
+
+	UInt32 Counter = 0;
+	for (UInt32 Root = FirstRoot; Root != NoClass; Root = NextSibling[Root])
+	{
+		Numbering->Orders[Root].PreOrder = Counter++;
+		Stack.EmplaceBack(Root);
+
+		// FirstChild is used as the cursor for the next subclass to visit
+		while (!Stack.IsEmpty())
 		{
-			return true;
+			const UInt32 Current = Stack.Back();
+			const UInt32 Child = FirstChild[Current];
+			if (Child != NoClass)
+			{
+				FirstChild[Current] = NextSibling[Child];
+				Numbering->Orders[Child].PreOrder = Counter++;
+				Stack.EmplaceBack(Child);
+			}
+			else
+			{
+				Numbering->Orders[Current].PostOrder = Counter++;
+				Stack.PopBack();
+			}
 		}
 	}
 
-	return false;
-}
+	CurrentNumbering.store(Numbering.Get(), std::memory_order_release);
+	Registry.Numberings.EmplaceBack(Move(Numbering));
+}
\ No newline at end of file
@@ -2,8 +2,31 @@
 #include "Defines.h"
 #include "Types.h"
 
+#include "Containers/TArray.h"
+
+#include <atomic>
+
+/*
+* ClassNumbering - Pre- and post-order numbers from a traversal of the class hierarchy, indexed by ClassType::GetIndex.
+* A numbering is never changed after it has been published.
+*/
+
+struct ClassNumbering
+{
+	struct Order
+	{
+		UInt32 PreOrder;
+		UInt32 PostOrder;
+	};
+
+	TArray<Order> Orders;
+};
+
 /*
-* Class for storing ClassInfo
+* Class for storing ClassInfo. Each class is numbered with a pre- and post-order traversal of the class hierarchy, which
+* makes subclass checks two compares instead of walking the superclasses. Classes are registered lazily, so every
+* registration builds a new numbering and publishes it through an atomic pointer. Readers on other threads always see
+* a complete numbering that contains every class they can reach.
 */
 
 class ClassType
@@ -12,7 +35,15 @@ public:
 	ClassType(const Char* InName, const ClassType* InSuperClass);
 	~ClassType() = default;
 
-	bool IsSubClassOf(const ClassType* Class) const;
+	FORCEINLINE bool IsSubClassOf(const ClassType* Class) const
+	{
+		VALIDATE(Class != nullptr);
+
+		const ClassNumbering* Numbering = CurrentNumbering.load(std::memory_order_acquire);
+		const ClassNumbering::Order& ThisOrder	= Numbering->Orders[Index];
+		const ClassNumbering::Order& ClassOrder	= Numbering->Orders[Class->Index];
+		return (ThisOrder.PreOrder >= ClassOrder.PreOrder) && (ThisOrder.PostOrder <= ClassOrder.PostOrder);
+	}
 
 	template<typename T>
 	FORCEINLINE bool IsSubClassOf() const
@@ -30,7 +61,18 @@ public:
 		return SuperClass;
 	}
 
+	// Position in the order that classes were registered, superclasses are always registered before their subclasses
+	FORCEINLINE UInt32 GetIndex() const
+	{
+		return Index;
+	}
+
 private:
+	static void NumberClasses();
+
+	static std::atomic<const ClassNumbering*> CurrentNumbering;
+
 	const Char* Name;
 	const ClassType* SuperClass;
+	UInt32 Index = 0;
 };
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "JobSystem.h"
+
+#include "Application/Log.h"
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*
+* JobQueue - Fixed size Chase-Lev deque. The owning thread pushes and pops at the bottom, other threads steal from the top
+*/
+
+class JobQueue
+{
+public:
+	static constexpr Int64 Capacity	= 4096;
+	static constexpr Int64 Mask		= Capacity - 1;
+
+	JobQueue()
+		: Top(0)
+		, Bottom(0)
+	{
+	}
+
+	// Only called from the owning thread, returns false if the queue is full
+	bool Push(const Job& InJob)
+	{
+		const Int64 CurrentBottom	= Bottom.load(std::memory_order_relaxed);
+		const Int64 CurrentTop		= Top.load(std::memory_order_acquire);
+		if (CurrentBottom - CurrentTop >= Capacity)
+		{
+			return false;
+		}
+
+		Jobs[CurrentBottom & Mask] = InJob;
+		Bottom.store(CurrentBottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Only called from the owning thread
+	bool Pop(Job& OutJob)
+	{
+		const Int64 CurrentBottom = Bottom.load(std::memory_order_relaxed) - 1;
+		Bottom.store(CurrentBottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		Int64 CurrentTop = Top.load(std::memory_order_relaxed);
+		if (CurrentTop > CurrentBottom)
+		{
+			Bottom.store(CurrentBottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		OutJob = Jobs[CurrentBottom & Mask];
+		if (CurrentTop == CurrentBottom)
+		{
+			// Last job, race against thieves
+			const bool Result = Top.compare_exchange_strong(CurrentTop, CurrentTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			Bottom.store(CurrentBottom + 1, std::memory_order_relaxed);
+			return Result;
+		}
+
+		return true;
+	}
+
+	// Can be called from any thread
+	bool Steal(Job& OutJob)
+	{
+		Int64 CurrentTop = Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const Int64 CurrentBottom = Bottom.load(std::memory_order_acquire);
+		if (CurrentTop >= CurrentBottom)
+		{
+			return false;
+		}
+
+		// The slot can be overwritten by the owner while it is copied, but only after another thread took this job, in which
+		// case the exchange fails and the copy is thrown away. Race detectors still report the copy.
+		OutJob = Jobs[CurrentTop & Mask];
+		return Top.compare_exchange_strong(CurrentTop, CurrentTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+private:
+	alignas(64) std::atomic<Int64> Top;
+	alignas(64) std::atomic<Int64> Bottom;
+	Job Jobs[Capacity];
+};
+
+/*
+* JobSystem Globals
+*/
+
+static TArray<JobQueue*>	GlobalQueues;
+static TArray<std::thread>	GlobalWorkers;
+
+static std::mutex				GlobalSleepMutex;
+static std::condition_variable	GlobalWakeCondition;
+
+static std::atomic<Int32>	GlobalPendingJobs(0);
+static std::atomic<Int32>	GlobalNumSleeping(0);
+static std::atomic<bool>	GlobalIsRunning(false);
+
+static thread_local UInt32 GlobalThreadIndex = 0;
+
+/*
+* Helpers
+*/
+
+static bool GetNextJob(Job& OutJob)
+{
+	const UInt32 ThreadIndex	= GlobalThreadIndex;
+	const UInt32 NumQueues		= GlobalQueues.Size();
+
+	bool Result = GlobalQueues[ThreadIndex]->Pop(OutJob);
+	for (UInt32 Offset = 1; !Result && Offset < NumQueues; Offset++)
+	{
+		Result = GlobalQueues[(ThreadIndex + Offset) % NumQueues]->Steal(OutJob);
+	}
+
+	if (Result)
+	{
+		GlobalPendingJobs.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	return Result;
+}
+
+static void RunJob(const Job& InJob)
+{
+	InJob.Func(InJob.Context, InJob.Begin, InJob.End);
+	if (InJob.Counter)
+	{
+		InJob.Counter->Decrement();
+	}
+}
+
+static void WorkerThreadMain(UInt32 ThreadIndex)
+{
+	GlobalThreadIndex = ThreadIndex;
+
+	constexpr UInt32 SpinCount = 64;
+
+	UInt32 NumFailedAttempts = 0;
+	while (GlobalIsRunning.load(std::memory_order_acquire))
+	{
+		Job CurrentJob;
+		if (GetNextJob(CurrentJob))
+		{
+			RunJob(CurrentJob);
+			NumFailedAttempts = 0;
+			continue;
+		}
+
+		if (++NumFailedAttempts < SpinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Nothing to do, go to sleep until new jobs are scheduled
+		std::unique_lock<std::mutex> Lock(GlobalSleepMutex);
+		GlobalNumSleeping.fetch_add(1, std::memory_order_seq_cst);
+		GlobalWakeCondition.wait(Lock, []
+		{
+			return (GlobalPendingJobs.load(std::memory_order_seq_cst) > 0) || !GlobalIsRunning.load(std::memory_order_seq_cst);
+		});
+		GlobalNumSleeping.fetch_sub(1, std::memory_order_relaxed);
+
+		NumFailedAttempts = 0;
+	}
+}
+
+/*
+* JobSystem
+*/
+
+bool JobSystem::Initialize(UInt32 NumWorkers)
+{
+	VALIDATE(!IsInitialized());
+
+	if (NumWorkers == 0)
+	{
+		const UInt32 NumHardwareThreads = std::thread::hardware_concurrency();
+		NumWorkers = (NumHardwareThreads > 1) ? (NumHardwareThreads - 1) : 0;
+	}
+
+	GlobalThreadIndex = 0;
+
+	const UInt32 NumThreads = NumWorkers + 1;
+	GlobalQueues.Reserve(NumThreads);
+	for (UInt32 Index = 0; Index < NumThreads; Index++)
+	{
+		GlobalQueues.EmplaceBack(new JobQueue());
+	}
+
+	GlobalIsRunning.store(true, std::memory_order_release);
+
+	GlobalWorkers.Reserve(NumWorkers);
+	for (UInt32 Index = 0; Index < NumWorkers; Index++)
+	{
+		GlobalWorkers.EmplaceBack(WorkerThreadMain, Index + 1);
+	}
+
+	LOG_INFO("[JobSystem]: Initialized with " + std::to_string(NumThreads) + " threads");
+	return true;
+}
+
+void JobSystem::Release()
+{
+	if (!IsInitialized())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(GlobalSleepMutex);
+		GlobalIsRunning.store(false, std::memory_order_seq_cst);
+	}
+	GlobalWakeCondition.notify_all();
+
+	for (std::thread& Worker : GlobalWorkers)
+	{
+		Worker.join();
+	}
+	GlobalWorkers.Clear();
+
+	for (JobQueue* Queue : GlobalQueues)
+	{
+		SAFEDELETE(Queue);
+	}
+	GlobalQueues.Clear();
+}
+
+void JobSystem::Execute(const Job& InJob)
+{
+	VALIDATE(InJob.Func != nullptr);
+
+	if (InJob.Counter)
+	{
+		InJob.Counter->Increment();
+	}
+
+	if (!IsInitialized() || !GlobalQueues[GlobalThreadIndex]->Push(InJob))
+	{
+		// No queue available or the queue is full, run on the calling thread
+		RunJob(InJob);
+		return;
+	}
+
+	GlobalPendingJobs.fetch_add(1, std::memory_order_seq_cst);
+	if (GlobalNumSleeping.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> Lock(GlobalSleepMutex);
+		GlobalWakeCondition.notify_one();
+	}
+}
+
+void JobSystem::Wait(JobCounter& Counter)
+{
+	while (!Counter.IsDone())
+	{
+		Job CurrentJob;
+		if (IsInitialized() && GetNextJob(CurrentJob))
+		{
+			RunJob(CurrentJob);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+UInt32 JobSystem::GetNumThreads()
+{
+	return IsInitialized() ? GlobalQueues.Size() : 1;
+}
+
+UInt32 JobSystem::GetCurrentThreadIndex()
+{
+	return GlobalThreadIndex;
+}
+
+bool JobSystem::IsInitialized()
+{
+	return GlobalIsRunning.load(std::memory_order_acquire);
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include "Defines.h"
+#include "Types.h"
+
+#include "Containers/TArray.h"
+
+#include <atomic>
+
+/*
+* JobCounter - Tracks a group of jobs so that a thread can wait for all of them to finish
+*/
+
+class JobCounter
+{
+public:
+	FORCEINLINE JobCounter()
+		: Count(0)
+	{
+	}
+
+	JobCounter(const JobCounter& Other) = delete;
+	JobCounter& operator=(const JobCounter& Other) = delete;
+
+	FORCEINLINE void Increment(UInt32 Amount = 1)
+	{
+		Count.fetch_add(Amount, std::memory_order_relaxed);
+	}
+
+	FORCEINLINE void Decrement()
+	{
+		Count.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	FORCEINLINE bool IsDone() const
+	{
+		return (Count.load(std::memory_order_acquire) == 0);
+	}
+
+private:
+	std::atomic<UInt32> Count;
+};
+
+/*
+* Job - Executes Func on the range [Begin, End)
+*/
+
+typedef void(*JobFunc)(Void* Context, UInt32 Begin, UInt32 End);
+
+struct Job
+{
+	JobFunc		Func	= nullptr;
+	Void*		Context	= nullptr;
+	JobCounter*	Counter	= nullptr;
+	UInt32		Begin	= 0;
+	UInt32		End		= 0;
+};
+
+/*
+* JobSystem - Work-stealing job system, each thread owns a deque that the other threads can steal from
+*/
+
+class JobSystem
+{
+public:
+	// NumWorkers is the number of threads created in addition to the calling thread, zero means one per hardware thread
+	static bool Initialize(UInt32 NumWorkers = 0);
+	static void Release();
+
+	// Increments the job's counter and schedules it on the calling thread's deque, must be called from the main thread or from a job
+	static void Execute(const Job& InJob);
+
+	// Helps executing jobs until the counter reaches zero
+	static void Wait(JobCounter& Counter);
+
+	// Number of threads that execute jobs, including the thread that called Initialize
+	static UInt32 GetNumThreads();
+
+	// Index in the range [0, GetNumThreads()), threads not owned by the JobSystem return zero
+	static UInt32 GetCurrentThreadIndex();
+
+	static bool IsInitialized();
+};
+
+/*
+* ParallelFor helpers, blocks until the whole range has been processed
+*/
+
+// Calls Func(Begin, End) for each batch of BatchSize elements in the range [0, Count)
+template<typename TFunc>
+inline void ParallelForBatch(UInt32 Count, TFunc&& Func, UInt32 BatchSize = 64)
+{
+	if (Count == 0)
+	{
+		return;
+	}
+
+	if (BatchSize == 0)
+	{
+		BatchSize = 1;
+	}
+
+	// Batches are never larger than BatchSize, callers may keep per batch scratch memory on the stack
+	if (Count <= BatchSize || JobSystem::GetNumThreads() <= 1)
+	{
+		for (UInt32 Begin = 0; Begin < Count; Begin += BatchSize)
+		{
+			const UInt32 End = (Count - Begin > BatchSize) ? (Begin + BatchSize) : Count;
+			Func(Begin, End);
+		}
+
+		return;
+	}
+
+	typedef TRemoveReference<TFunc> TCallable;
+
+	JobCounter Counter;
+
+	Job BatchJob;
+	BatchJob.Context	= const_cast<Void*>(reinterpret_cast<const Void*>(&Func));
+	BatchJob.Counter	= &Counter;
+	BatchJob.Func		= [](Void* Context, UInt32 Begin, UInt32 End)
+	{
+		(*reinterpret_cast<TCallable*>(Context))(Begin, End);
+	};
+
+	for (UInt32 Begin = 0; Begin < Count; Begin += BatchSize)
+	{
+		BatchJob.Begin	= Begin;
+		BatchJob.End	= (Count - Begin > BatchSize) ? (Begin + BatchSize) : Count;
+		JobSystem::Execute(BatchJob);
+	}
+
+	JobSystem::Wait(Counter);
+}
+
+// Calls Func(Index) for each index in the range [0, Count)
+template<typename TFunc>
+inline void ParallelFor(UInt32 Count, TFunc&& Func, UInt32 BatchSize = 64)
+{
+	ParallelForBatch(Count, [&Func](UInt32 Begin, UInt32 End)
+	{
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			Func(Index);
+		}
+	}, BatchSize);
+}
+
+// Calls Func(Element) for each element in the array
+template<typename T, typename TFunc>
+inline void ParallelFor(TArray<T>& Array, TFunc&& Func, UInt32 BatchSize = 64)
+{
+	T* Elements = Array.Data();
+	ParallelForBatch(Array.Size(), [Elements, &Func](UInt32 Begin, UInt32 End)
+	{
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			Func(Elements[Index]);
+		}
+	}, BatchSize);
+}
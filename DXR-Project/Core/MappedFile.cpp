@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+
+#include "Windows/Windows.h"
+
+/*
+* MappedFile
+*/
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& Filepath)
+{
+	Close();
+
+	HANDLE File = ::CreateFileA(Filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER FileSize = { };
+	if (!::GetFileSizeEx(File, &FileSize))
+	{
+		::CloseHandle(File);
+		return false;
+	}
+
+	FileHandle	= File;
+	Size		= static_cast<UInt64>(FileSize.QuadPart);
+	IsFileOpen	= true;
+
+	// Empty files cannot be mapped
+	if (Size == 0)
+	{
+		return true;
+	}
+
+	HANDLE Mapping = ::CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!Mapping)
+	{
+		Close();
+		return false;
+	}
+
+	MappingHandle = Mapping;
+
+	Data = reinterpret_cast<const Byte*>(::MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!Data)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (Data)
+	{
+		::UnmapViewOfFile(Data);
+		Data = nullptr;
+	}
+
+	if (MappingHandle)
+	{
+		::CloseHandle(reinterpret_cast<HANDLE>(MappingHandle));
+		MappingHandle = nullptr;
+	}
+
+	if (FileHandle)
+	{
+		::CloseHandle(reinterpret_cast<HANDLE>(FileHandle));
+		FileHandle = nullptr;
+	}
+
+	Size		= 0;
+	IsFileOpen	= false;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Defines.h"
+#include "Types.h"
+
+#include <string>
+
+/*
+* MappedFile - Read-only view of a whole file that is mapped into memory. The data stays valid until the file is closed.
+*/
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile& Other) = delete;
+	MappedFile& operator=(const MappedFile& Other) = delete;
+
+	bool Open(const std::string& Filepath);
+	void Close();
+
+	FORCEINLINE const Byte* GetData() const
+	{
+		return Data;
+	}
+
+	FORCEINLINE UInt64 GetSize() const
+	{
+		return Size;
+	}
+
+	FORCEINLINE bool IsOpen() const
+	{
+		return IsFileOpen;
+	}
+
+private:
+	const Byte*	Data	= nullptr;
+	UInt64		Size	= 0;
+
+	Void* FileHandle	= nullptr;
+	Void* MappingHandle	= nullptr;
+
+	bool IsFileOpen = false;
+};
@@ -4,6 +4,8 @@
 #include "D3D12CommandAllocator.h"
 #include "D3D12DescriptorHeap.h"
 
+#include "Containers/TInlineArray.h"
+
 class D3D12Texture;
 class D3D12ComputePipelineState;
 class D3D12RootSignature;
@@ -277,7 +279,7 @@ protected:
 	UInt32	UploadBufferOffset	= 0;
 	UInt32	NumDrawCalls		= 0;
 
-	TArray<D3D12_RESOURCE_BARRIER> DeferredResourceBarriers;
+	TInlineArray<D3D12_RESOURCE_BARRIER, 16> DeferredResourceBarriers;
 	TArray<Microsoft::WRL::ComPtr<ID3D12Resource>> ResourcesPendingRelease;
 
 	// There can maximum be 8 rendertargets at one time 
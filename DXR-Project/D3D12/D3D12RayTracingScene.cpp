@@ -30,7 +30,8 @@ bool D3D12RayTracingGeometry::BuildAccelerationStructure(
 	TSharedPtr<D3D12Buffer>& InVertexBuffer, 
 	UInt32 InVertexCount, 
 	TSharedPtr<D3D12Buffer>& InIndexBuffer, 
-	UInt32 InIndexCount)
+	UInt32 InIndexCount,
+	DXGI_FORMAT InIndexFormat)
 {
 	if (!IsDirty)
 	{
@@ -46,10 +47,16 @@ bool D3D12RayTracingGeometry::BuildAccelerationStructure(
 
 	GeometryDesc.Type									= D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
 	GeometryDesc.Triangles.VertexBuffer.StartAddress	= InVertexBuffer->GetGPUVirtualAddress();
+#if ENABLE_PACKED_VERTICES
+	// The quantization of the positions is part of the instance transform
+	GeometryDesc.Triangles.VertexBuffer.StrideInBytes	= sizeof(PackedVertex);
+	GeometryDesc.Triangles.VertexFormat					= DXGI_FORMAT_R16G16B16A16_SNORM;
+#else
 	GeometryDesc.Triangles.VertexBuffer.StrideInBytes	= sizeof(Vertex);
 	GeometryDesc.Triangles.VertexFormat					= DXGI_FORMAT_R32G32B32_FLOAT;
+#endif
 	GeometryDesc.Triangles.VertexCount					= InVertexCount;
-	GeometryDesc.Triangles.IndexFormat					= DXGI_FORMAT_R32_UINT;
+	GeometryDesc.Triangles.IndexFormat					= InIndexFormat;
 	GeometryDesc.Triangles.IndexBuffer					= InIndexBuffer->GetGPUVirtualAddress();
 	GeometryDesc.Triangles.IndexCount					= InIndexCount;
 	GeometryDesc.Flags									= D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
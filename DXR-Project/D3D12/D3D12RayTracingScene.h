@@ -19,7 +19,7 @@ public:
 	D3D12RayTracingGeometry(D3D12Device* InDevice);
 	~D3D12RayTracingGeometry();
 
-	bool BuildAccelerationStructure(D3D12CommandList* CommandList, TSharedPtr<D3D12Buffer>& InVertexBuffer, UInt32 InVertexCount, TSharedPtr<D3D12Buffer>& IndexBuffer, UInt32 InIndexCount);
+	bool BuildAccelerationStructure(D3D12CommandList* CommandList, TSharedPtr<D3D12Buffer>& InVertexBuffer, UInt32 InVertexCount, TSharedPtr<D3D12Buffer>& IndexBuffer, UInt32 InIndexCount, DXGI_FORMAT InIndexFormat = DXGI_FORMAT_R32_UINT);
 
 	// DeviceChild Interface
 	virtual void SetDebugName(const std::string& Name) override;
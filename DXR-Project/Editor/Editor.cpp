@@ -7,6 +7,11 @@
 
 #include "Application/Application.h"
 
+#include "Core/JobSystem.h"
+
+#include "Memory/FrameAllocator.h"
+#include "Memory/PoolAllocator.h"
+
 #include "Scene/Scene.h"
 #include "Scene/Lights/DirectionalLight.h"
 #include "Scene/Lights/PointLight.h"
@@ -111,9 +116,30 @@ static void DrawDebugData()
 	static std::string AdapterName = RenderingAPI::Get().GetAdapterName();
 
 	const Double Delta = EngineLoop::GetDeltaTime().AsMilliSeconds();
-	DebugUI::DrawDebugString("Adapter: " + AdapterName);
-	DebugUI::DrawDebugString("Frametime: " + std::to_string(Delta) + " ms");
-	DebugUI::DrawDebugString("FPS: " + std::to_string(static_cast<UInt32>(1000 / Delta)));
+	DebugUI::DrawDebugString("Adapter: %s", AdapterName.c_str());
+	DebugUI::DrawDebugString("Frametime: %f ms", Delta);
+	DebugUI::DrawDebugString("FPS: %u", static_cast<UInt32>(1000 / Delta));
+
+	const FrameAllocatorStatistics FrameMemory = FrameAllocator::GetStatistics();
+	DebugUI::DrawDebugString(
+		"Frame Memory: %.1f KB, High Water: %.1f KB, Reserved: %.1f KB (%u Threads)",
+		FrameMemory.UsedBytes / 1024.0,
+		FrameMemory.HighWaterMark / 1024.0,
+		FrameMemory.ReservedBytes / 1024.0,
+		FrameMemory.NumThreads);
+
+	for (UInt32 Index = 0; Index < PoolAllocator::GetNumPools(); Index++)
+	{
+		const PoolAllocator& Pool = PoolAllocator::GetPool(Index);
+
+		const PoolAllocatorStatistics PoolMemory = Pool.GetStatistics();
+		DebugUI::DrawDebugString(
+			"%s Pool: %llu Objects, %.1f KB, Reserved: %.1f KB",
+			Pool.GetDebugName(),
+			PoolMemory.NumAllocations,
+			PoolMemory.AllocatedBytes / 1024.0,
+			PoolMemory.ReservedBytes / 1024.0);
+	}
 }
 
 /*
@@ -230,6 +256,7 @@ static void DrawRenderSettings()
 
 	ImGui::Indent();
 	ImGui::Text("Resolution: %d x %d", WindowShape.Width, WindowShape.Height);
+	ImGui::Text("Job Threads: %u", JobSystem::GetNumThreads());
 
 	bool Enabled = Renderer::Get()->IsPrePassEnabled();
 	if (ImGui::Checkbox("Enable Z-PrePass", &Enabled))
@@ -249,6 +276,24 @@ static void DrawRenderSettings()
 		Renderer::Get()->SetFrustumCullEnable(Enabled);
 	}
 
+	Enabled = Renderer::Get()->IsOcclusionCullEnabled();
+	if (ImGui::Checkbox("Enable Occlusion Culling", &Enabled))
+	{
+		Renderer::Get()->SetOcclusionCullEnable(Enabled);
+	}
+
+	Enabled = Renderer::Get()->IsClusterCullEnabled();
+	if (ImGui::Checkbox("Enable Cluster Culling", &Enabled))
+	{
+		Renderer::Get()->SetClusterCullEnable(Enabled);
+	}
+
+	Enabled = Renderer::Get()->IsLODEnabled();
+	if (ImGui::Checkbox("Enable Mesh LODs", &Enabled))
+	{
+		Renderer::Get()->SetLODEnable(Enabled);
+	}
+
 	Enabled = Renderer::Get()->IsDrawAABBsEnabled();
 	if (ImGui::Checkbox("Draw AABBs", &Enabled))
 	{
@@ -3,6 +3,10 @@
 
 #include "Time/Clock.h"
 
+#include "Core/JobSystem.h"
+
+#include "Memory/FrameAllocator.h"
+
 #include "Application/Application.h"
 #include "Application/Generic/GenericOutputDevice.h"
 #include "Application/Generic/GenericCursor.h"
@@ -37,6 +41,12 @@ bool EngineLoop::CoreInitialize()
 		return false;
 	}
 
+	if (!JobSystem::Initialize())
+	{
+		::MessageBox(0, "Failed to initialize JobSystem", "ERROR", MB_ICONERROR);
+		return false;
+	}
+
 	return true;
 }
 
@@ -80,6 +90,9 @@ bool EngineLoop::Initialize()
 		return false;
 	}
 
+	// Frame memory is kept alive as long as the backbuffers that may reference it
+	FrameAllocator::Initialize(RenderingAPI->GetSwapChain()->GetSurfaceCount());
+
 	// ImGui
 	if (!DebugUI::Initialize())
 	{
@@ -113,11 +126,17 @@ void EngineLoop::Tick()
 	// Update Game
 	Game::GetCurrent().Tick(GlobalClock.GetDeltaTime());
 
+	// Update scene
+	Scene::GetCurrentScene()->Tick(GlobalClock.GetDeltaTime());
+
 	// Update renderer
 	Renderer::Get()->Tick(*Scene::GetCurrentScene());
 
 	// Update editor
 	Editor::Tick();
+
+	// The renderer has waited for the GPU, so the oldest buffered frame memory can be reused
+	FrameAllocator::EndFrame();
 }
 
 void EngineLoop::Release()
@@ -133,6 +152,10 @@ void EngineLoop::Release()
 
 void EngineLoop::CoreRelease()
 {
+	JobSystem::Release();
+
+	FrameAllocator::Release();
+
 	RenderingAPI::Release();
 
 	Application::Get().Release();
@@ -40,8 +40,7 @@ bool Game::Initialize()
 	constexpr Float	 MetallicDelta	= 1.0f / SphereCountY;
 	constexpr Float	 RoughnessDelta	= 1.0f / SphereCountX;
 
-	Actor*			NewActor		= nullptr;
-	MeshComponent*	NewComponent	= nullptr;
+	Actor* NewActor = nullptr;
 	CurrentScene = Scene::LoadFromFile("../Assets/Scenes/Sponza/Sponza.obj");
 
 	// Create Spheres
@@ -105,17 +104,17 @@ bool Game::Initialize()
 
 			CurrentScene->AddActor(NewActor);
 
-			NewComponent = new MeshComponent(NewActor);
-			NewComponent->Mesh		= SphereMesh;
-			NewComponent->Material	= MakeShared<Material>(MatProperties);
+			MeshComponent NewComponent(NewActor);
+			NewComponent.Mesh		= SphereMesh;
+			NewComponent.Material	= MakeShared<Material>(MatProperties);
 
-			NewComponent->Material->AlbedoMap		= BaseTexture;
-			NewComponent->Material->NormalMap		= BaseNormal;
-			NewComponent->Material->RoughnessMap	= WhiteTexture;
-			NewComponent->Material->HeightMap		= WhiteTexture;
-			NewComponent->Material->AOMap			= WhiteTexture;
-			NewComponent->Material->MetallicMap		= WhiteTexture;
-			NewComponent->Material->Initialize();
+			NewComponent.Material->AlbedoMap		= BaseTexture;
+			NewComponent.Material->NormalMap		= BaseNormal;
+			NewComponent.Material->RoughnessMap		= WhiteTexture;
+			NewComponent.Material->HeightMap		= WhiteTexture;
+			NewComponent.Material->AOMap			= WhiteTexture;
+			NewComponent.Material->MetallicMap		= WhiteTexture;
+			NewComponent.Material->Initialize();
 
 			NewActor->AddComponent(NewComponent);
 
@@ -140,9 +139,9 @@ bool Game::Initialize()
 	MatProperties.Roughness		= 1.0f;
 	MatProperties.EnableHeight	= 1;
 
-	NewComponent = new MeshComponent(NewActor);
-	NewComponent->Mesh		= Mesh::Make(CubeMeshData);
-	NewComponent->Material	= MakeShared<Material>(MatProperties);
+	MeshComponent NewComponent(NewActor);
+	NewComponent.Mesh		= Mesh::Make(CubeMeshData);
+	NewComponent.Material	= MakeShared<Material>(MatProperties);
 
 	TSharedPtr<D3D12Texture> AlbedoMap = TSharedPtr(TextureFactory::LoadFromFile("../Assets/Textures/Gate_Albedo.png", TEXTURE_FACTORY_FLAGS_GENERATE_MIPS, DXGI_FORMAT_R8G8B8A8_UNORM));
 	if (!AlbedoMap)
@@ -204,13 +203,13 @@ bool Game::Initialize()
 		MetallicMap->SetDebugName("MetallicMap");
 	}
 
-	NewComponent->Material->AlbedoMap		= AlbedoMap;
-	NewComponent->Material->NormalMap		= NormalMap;
-	NewComponent->Material->RoughnessMap	= RoughnessMap;
-	NewComponent->Material->HeightMap		= HeightMap;
-	NewComponent->Material->AOMap			= AOMap;
-	NewComponent->Material->MetallicMap		= MetallicMap;
-	NewComponent->Material->Initialize();
+	NewComponent.Material->AlbedoMap		= AlbedoMap;
+	NewComponent.Material->NormalMap		= NormalMap;
+	NewComponent.Material->RoughnessMap		= RoughnessMap;
+	NewComponent.Material->HeightMap		= HeightMap;
+	NewComponent.Material->AOMap			= AOMap;
+	NewComponent.Material->MetallicMap		= MetallicMap;
+	NewComponent.Material->Initialize();
 	NewActor->AddComponent(NewComponent);
 
 	CurrentCamera = new Camera();
@@ -0,0 +1,171 @@
+#include "FrameAllocator.h"
+#include "MemoryArena.h"
+#include "New.h"
+
+#include "Containers/TArray.h"
+
+#include <atomic>
+#include <mutex>
+#include <cstring>
+
+/*
+* ThreadFrameArenas - The arenas of one thread, one for each buffered frame. An arena is reset the first time the
+* thread allocates from it during a new frame, so threads never touch the arenas of other threads.
+*/
+
+struct ThreadFrameArenas
+{
+	MemoryArena	Arenas[FrameAllocator::MaxBufferedFrames];
+	UInt64		FrameNumbers[FrameAllocator::MaxBufferedFrames] = { };
+
+	// The arena of the frame that the thread allocated from last
+	MemoryArena*	CurrentArena		= nullptr;
+	UInt64			CurrentFrameNumber	= 0;
+};
+
+/*
+* FrameAllocator Globals
+*/
+
+static TArray<ThreadFrameArenas*>	GlobalThreadArenas;
+static std::mutex					GlobalThreadArenasMutex;
+
+// Frame numbers start at one so that unused arenas never match the current frame
+static std::atomic<UInt64>	GlobalFrameNumber(1);
+static UInt32				GlobalNumBufferedFrames	= 2;
+static UInt64				GlobalLastUsedBytes		= 0;
+static UInt64				GlobalHighWaterMark		= 0;
+
+static thread_local ThreadFrameArenas* GlobalCurrentThreadArenas = nullptr;
+
+/*
+* Helpers
+*/
+
+static ThreadFrameArenas* GetCurrentThreadArenas()
+{
+	if (!GlobalCurrentThreadArenas)
+	{
+		GlobalCurrentThreadArenas = DBG_NEW ThreadFrameArenas();
+
+		std::lock_guard<std::mutex> Lock(GlobalThreadArenasMutex);
+		GlobalThreadArenas.EmplaceBack(GlobalCurrentThreadArenas);
+	}
+
+	return GlobalCurrentThreadArenas;
+}
+
+static void BeginThreadFrame(ThreadFrameArenas* Arenas, UInt64 FrameNumber)
+{
+	const UInt32 Index = static_cast<UInt32>(FrameNumber % GlobalNumBufferedFrames);
+	if (Arenas->FrameNumbers[Index] != FrameNumber)
+	{
+		// The frame that used this arena before is no longer in flight. Blocks that the frame did not need are freed,
+		// otherwise every thread would keep the most memory it ever used once for every buffered frame.
+		MemoryArena& Arena = Arenas->Arenas[Index];
+		Arena.Trim();
+		Arena.Reset();
+
+		Arenas->FrameNumbers[Index] = FrameNumber;
+	}
+
+	Arenas->CurrentArena		= &Arenas->Arenas[Index];
+	Arenas->CurrentFrameNumber	= FrameNumber;
+}
+
+/*
+* FrameAllocator
+*/
+
+void FrameAllocator::Initialize(UInt32 InNumBufferedFrames)
+{
+	VALIDATE(InNumBufferedFrames > 0 && InNumBufferedFrames <= MaxBufferedFrames);
+	GlobalNumBufferedFrames = InNumBufferedFrames;
+}
+
+void FrameAllocator::Release()
+{
+	std::lock_guard<std::mutex> Lock(GlobalThreadArenasMutex);
+	for (ThreadFrameArenas* Arenas : GlobalThreadArenas)
+	{
+		delete Arenas;
+	}
+
+	GlobalThreadArenas.Clear();
+	GlobalCurrentThreadArenas = nullptr;
+}
+
+Void* FrameAllocator::Malloc(UInt64 Size, UInt64 Alignment)
+{
+	ThreadFrameArenas* Arenas = GetCurrentThreadArenas();
+
+	const UInt64 FrameNumber = GlobalFrameNumber.load(std::memory_order_acquire);
+	if (Arenas->CurrentFrameNumber != FrameNumber)
+	{
+		BeginThreadFrame(Arenas, FrameNumber);
+	}
+
+	return Arenas->CurrentArena->Allocate(Size, Alignment);
+}
+
+bool FrameAllocator::TryResize(Void* Ptr, UInt64 OldSize, UInt64 NewSize)
+{
+	ThreadFrameArenas* Arenas = GetCurrentThreadArenas();
+	if (Arenas->CurrentFrameNumber != GlobalFrameNumber.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	return Arenas->CurrentArena->TryResize(Ptr, OldSize, NewSize);
+}
+
+Char* FrameAllocator::CopyString(const Char* String)
+{
+	const UInt64 Length = strlen(String) + 1;
+
+	Char* Result = reinterpret_cast<Char*>(Malloc(Length, 1));
+	memcpy(Result, String, Length);
+	return Result;
+}
+
+void FrameAllocator::EndFrame()
+{
+	const UInt64 FrameNumber	= GlobalFrameNumber.load(std::memory_order_relaxed);
+	const UInt32 Index			= static_cast<UInt32>(FrameNumber % GlobalNumBufferedFrames);
+
+	UInt64 UsedBytes = 0;
+	{
+		std::lock_guard<std::mutex> Lock(GlobalThreadArenasMutex);
+		for (const ThreadFrameArenas* Arenas : GlobalThreadArenas)
+		{
+			if (Arenas->FrameNumbers[Index] == FrameNumber)
+			{
+				UsedBytes += Arenas->Arenas[Index].GetUsedBytes();
+			}
+		}
+	}
+
+	GlobalLastUsedBytes = UsedBytes;
+	GlobalHighWaterMark = std::max(GlobalHighWaterMark, UsedBytes);
+
+	GlobalFrameNumber.store(FrameNumber + 1, std::memory_order_release);
+}
+
+FrameAllocatorStatistics FrameAllocator::GetStatistics()
+{
+	FrameAllocatorStatistics Statistics;
+	Statistics.UsedBytes		= GlobalLastUsedBytes;
+	Statistics.HighWaterMark	= GlobalHighWaterMark;
+
+	std::lock_guard<std::mutex> Lock(GlobalThreadArenasMutex);
+	for (const ThreadFrameArenas* Arenas : GlobalThreadArenas)
+	{
+		for (const MemoryArena& Arena : Arenas->Arenas)
+		{
+			Statistics.ReservedBytes += Arena.GetReservedBytes();
+		}
+	}
+
+	Statistics.NumThreads = GlobalThreadArenas.Size();
+	return Statistics;
+}
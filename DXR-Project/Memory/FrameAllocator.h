@@ -0,0 +1,46 @@
+#pragma once
+#include "Defines.h"
+#include "Types.h"
+
+/*
+* FrameAllocatorStatistics
+*/
+
+struct FrameAllocatorStatistics
+{
+	// Bytes allocated during the last finished frame, summed over all threads
+	UInt64 UsedBytes		= 0;
+	// The most bytes that have been allocated during one frame
+	UInt64 HighWaterMark	= 0;
+	// Bytes held by the arenas of all threads and buffered frames
+	UInt64 ReservedBytes	= 0;
+	UInt32 NumThreads		= 0;
+};
+
+/*
+* FrameAllocator - Linear allocator for memory that only lives for a few frames. Each thread allocates from its own
+* arena so no locks are taken. Memory allocated during a frame stays valid until NumBufferedFrames calls to EndFrame
+* have been made, which gives the frames that the GPU still works on time to finish before their memory is reused.
+*/
+
+class FrameAllocator
+{
+public:
+	static constexpr UInt32 MaxBufferedFrames = 4;
+
+	static void Initialize(UInt32 InNumBufferedFrames);
+	static void Release();
+
+	static Void* Malloc(UInt64 Size, UInt64 Alignment = 16);
+
+	// Grows or shrinks the last allocation the calling thread made during this frame, returns false for any other
+	static bool TryResize(Void* Ptr, UInt64 OldSize, UInt64 NewSize);
+
+	// Copies the string into frame memory
+	static Char* CopyString(const Char* String);
+
+	// Starts the next frame, should be called from the main thread when no jobs are running
+	static void EndFrame();
+
+	static FrameAllocatorStatistics GetStatistics();
+};
@@ -0,0 +1,103 @@
+#include "MemoryArena.h"
+#include "Memory.h"
+
+/*
+* MemoryArena
+*/
+
+// The header is stored at the start of each block
+static constexpr UInt64 BlockHeaderSize = 64;
+
+MemoryArena::MemoryArena(UInt64 InBlockSize)
+	: FirstBlock(nullptr)
+	, CurrentBlock(nullptr)
+	, BlockSize(InBlockSize)
+	, UsedBytes(0)
+	, ReservedBytes(0)
+	, HighWaterMark(0)
+{
+	static_assert(sizeof(MemoryBlock) <= BlockHeaderSize, "MemoryBlock does not fit in the header");
+}
+
+MemoryArena::~MemoryArena()
+{
+	MemoryBlock* Block = FirstBlock;
+	while (Block)
+	{
+		MemoryBlock* Next = Block->Next;
+		Memory::Free(Block);
+		Block = Next;
+	}
+}
+
+Void* MemoryArena::AllocateFromNextBlock(UInt64 Size, UInt64 Alignment)
+{
+	VALIDATE((Alignment & (Alignment - 1)) == 0);
+
+	// Blocks that are too small for this allocation are skipped until the next reset
+	while (CurrentBlock && CurrentBlock->Next)
+	{
+		CurrentBlock = CurrentBlock->Next;
+
+		const UInt64 BlockStart	= reinterpret_cast<UInt64>(CurrentBlock);
+		const UInt64 Start		= Math::AlignUp<UInt64>(BlockStart + CurrentBlock->Offset, Alignment) - BlockStart;
+		if (Start + Size <= CurrentBlock->Size)
+		{
+			return Allocate(Size, Alignment);
+		}
+	}
+
+	// Malloc only guarantees 16 byte alignment for the block itself
+	const UInt64 PaddedSize = BlockHeaderSize + Size + Alignment;
+	const UInt64 NewSize	= std::max(BlockSize, PaddedSize);
+
+	MemoryBlock* NewBlock = reinterpret_cast<MemoryBlock*>(Memory::Malloc(NewSize));
+	NewBlock->Next		= nullptr;
+	NewBlock->Size		= NewSize;
+	NewBlock->Offset	= BlockHeaderSize;
+	ReservedBytes += NewSize;
+
+	if (CurrentBlock)
+	{
+		CurrentBlock->Next = NewBlock;
+	}
+	else
+	{
+		FirstBlock = NewBlock;
+	}
+
+	CurrentBlock = NewBlock;
+	return Allocate(Size, Alignment);
+}
+
+void MemoryArena::Reset()
+{
+	HighWaterMark = GetHighWaterMark();
+
+	for (MemoryBlock* Block = FirstBlock; Block; Block = Block->Next)
+	{
+		Block->Offset = BlockHeaderSize;
+	}
+
+	CurrentBlock	= FirstBlock;
+	UsedBytes		= 0;
+}
+
+void MemoryArena::Trim()
+{
+	if (!CurrentBlock)
+	{
+		return;
+	}
+
+	MemoryBlock* Block = CurrentBlock->Next;
+	while (Block)
+	{
+		MemoryBlock* Next = Block->Next;
+		ReservedBytes -= Block->Size;
+		Memory::Free(Block);
+		Block = Next;
+	}
+
+	CurrentBlock->Next = nullptr;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "Defines.h"
+#include "Types.h"
+
+/*
+* MemoryArena - Linear allocator that hands out memory from large blocks by bumping an offset. Allocations are never
+* freed one by one, Reset releases everything at once and keeps the blocks for the next use. Not thread safe.
+*/
+class MemoryArena
+{
+public:
+	MemoryArena(UInt64 InBlockSize = 64 * 1024);
+	~MemoryArena();
+
+	MemoryArena(const MemoryArena& Other) = delete;
+	MemoryArena& operator=(const MemoryArena& Other) = delete;
+
+	FORCEINLINE Void* Allocate(UInt64 Size, UInt64 Alignment = 16)
+	{
+		if (CurrentBlock)
+		{
+			const UInt64 BlockStart	= reinterpret_cast<UInt64>(CurrentBlock);
+			const UInt64 Start		= ((BlockStart + CurrentBlock->Offset + Alignment - 1) & ~(Alignment - 1)) - BlockStart;
+			if (Start + Size <= CurrentBlock->Size)
+			{
+				UsedBytes += (Start + Size) - CurrentBlock->Offset;
+				CurrentBlock->Offset = Start + Size;
+				return reinterpret_cast<Void*>(BlockStart + Start);
+			}
+		}
+
+		return AllocateFromNextBlock(Size, Alignment);
+	}
+
+	// Only the most recent allocation can change size, returns false for any other allocation or if the block is full
+	FORCEINLINE bool TryResize(Void* Ptr, UInt64 OldSize, UInt64 NewSize)
+	{
+		if (CurrentBlock)
+		{
+			const UInt64 BlockStart	= reinterpret_cast<UInt64>(CurrentBlock);
+			const UInt64 Start		= reinterpret_cast<UInt64>(Ptr) - BlockStart;
+			if (Start + OldSize == CurrentBlock->Offset && Start + NewSize <= CurrentBlock->Size)
+			{
+				UsedBytes = (UsedBytes - OldSize) + NewSize;
+				CurrentBlock->Offset = Start + NewSize;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Every allocation made since the last reset becomes invalid
+	void Reset();
+
+	// Frees the blocks that were not needed since the last reset
+	void Trim();
+
+	FORCEINLINE UInt64 GetUsedBytes() const
+	{
+		return UsedBytes;
+	}
+
+	FORCEINLINE UInt64 GetReservedBytes() const
+	{
+		return ReservedBytes;
+	}
+
+	// The most bytes that have been used between two resets
+	FORCEINLINE UInt64 GetHighWaterMark() const
+	{
+		return (UsedBytes > HighWaterMark) ? UsedBytes : HighWaterMark;
+	}
+
+private:
+	Void* AllocateFromNextBlock(UInt64 Size, UInt64 Alignment);
+
+	struct MemoryBlock
+	{
+		MemoryBlock*	Next;
+		UInt64			Size;
+		UInt64			Offset;
+	};
+
+	MemoryBlock*	FirstBlock;
+	MemoryBlock*	CurrentBlock;
+	UInt64			BlockSize;
+	UInt64			UsedBytes;
+	UInt64			ReservedBytes;
+	UInt64			HighWaterMark;
+};
@@ -0,0 +1,358 @@
+#include "PoolAllocator.h"
+#include "Memory.h"
+#include "New.h"
+
+#include <atomic>
+
+#ifdef _WIN32
+	#include "Windows/Windows.h"
+#endif
+
+/*
+* PoolFreeElement - Free elements store the next free element in their first bytes
+*/
+
+struct PoolFreeElement
+{
+	PoolFreeElement* Next;
+};
+
+/*
+* PoolThreadCache - Free elements of one pool owned by one thread. NumAllocations is only written by the owning
+* thread, frees on other threads make it negative and the sum over all threads is the number of live elements.
+*/
+
+struct PoolThreadCache
+{
+	struct FreeList
+	{
+		PoolFreeElement*	Head		= nullptr;
+		UInt32				NumElements	= 0;
+	};
+
+	FreeList				FreeLists[PoolAllocator::NumSizeClasses];
+	std::atomic<Int64>		NumAllocations[PoolAllocator::NumSizeClasses] = { };
+	PoolThreadCache*		Next = nullptr;
+};
+
+/*
+* ThreadCacheOwner - Returns the cached elements of a thread to the pools when the thread exits
+*/
+
+struct ThreadCacheOwner
+{
+	~ThreadCacheOwner();
+};
+
+/*
+* PoolAllocator Globals
+*/
+
+alignas(PoolAllocator) static Byte	GlobalPoolStorage[sizeof(PoolAllocator) * PoolAllocator::MaxPools];
+static std::atomic<UInt32>			GlobalNumPools(0);
+static std::mutex					GlobalPoolsMutex;
+
+// Thread caches are never freed either, they are taken from chunks that belong to all pools
+static Byte*	GlobalThreadCacheCursor	= nullptr;
+static Byte*	GlobalThreadCacheEnd	= nullptr;
+
+// The caches are only created by the owning thread, so there is no need for atomics
+static thread_local PoolThreadCache*	GlobalThreadCaches[PoolAllocator::MaxPools] = { };
+static thread_local ThreadCacheOwner	GlobalThreadCacheOwner;
+
+/*
+* Helpers
+*/
+
+FORCEINLINE static UInt32 GetSizeClassIndex(UInt64 Size)
+{
+	return (Size > 0) ? static_cast<UInt32>((Size - 1) / PoolAllocator::SizeClassGranularity) : 0;
+}
+
+FORCEINLINE static UInt64 GetElementSize(UInt32 SizeClassIndex)
+{
+	return static_cast<UInt64>(SizeClassIndex + 1) * PoolAllocator::SizeClassGranularity;
+}
+
+// Number of elements moved between a thread cache and the shared free list, a thread caches at most twice as many
+FORCEINLINE static UInt32 GetBatchSize(UInt32 SizeClassIndex)
+{
+	const UInt64 BatchSize = 4096 / GetElementSize(SizeClassIndex);
+	return static_cast<UInt32>(std::max<UInt64>(BatchSize, 8));
+}
+
+static Void* AllocateChunk()
+{
+	// Chunks come from the OS on windows so the CRT leak check does not report them at exit
+#ifdef _WIN32
+	return ::VirtualAlloc(nullptr, PoolAllocator::ChunkSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	return Memory::Malloc(PoolAllocator::ChunkSize);
+#endif
+}
+
+/*
+* ThreadCacheOwner
+*/
+
+ThreadCacheOwner::~ThreadCacheOwner()
+{
+	const UInt32 NumPools = GlobalNumPools.load(std::memory_order_acquire);
+	for (UInt32 Index = 0; Index < NumPools; Index++)
+	{
+		if (GlobalThreadCaches[Index])
+		{
+			PoolAllocator::GetPool(Index).ReleaseThreadCache(GlobalThreadCaches[Index]);
+		}
+	}
+}
+
+/*
+* PoolAllocator
+*/
+
+PoolAllocator::PoolAllocator(const Char* InDebugName, UInt32 InPoolIndex)
+	: SizeClasses()
+	, DebugName(InDebugName)
+	, PoolIndex(InPoolIndex)
+	, ThreadCachesMutex()
+{
+}
+
+PoolAllocator& PoolAllocator::Create(const Char* InDebugName)
+{
+	std::lock_guard<std::mutex> Lock(GlobalPoolsMutex);
+
+	const UInt32 Index = GlobalNumPools.load(std::memory_order_relaxed);
+	VALIDATE(Index < MaxPools);
+
+	PoolAllocator* Pool = reinterpret_cast<PoolAllocator*>(GlobalPoolStorage) + Index;
+	new(reinterpret_cast<Void*>(Pool)) PoolAllocator(InDebugName, Index);
+
+	GlobalNumPools.store(Index + 1, std::memory_order_release);
+	return *Pool;
+}
+
+UInt32 PoolAllocator::GetNumPools()
+{
+	return GlobalNumPools.load(std::memory_order_acquire);
+}
+
+PoolAllocator& PoolAllocator::GetPool(UInt32 Index)
+{
+	VALIDATE(Index < GetNumPools());
+	return reinterpret_cast<PoolAllocator*>(GlobalPoolStorage)[Index];
+}
+
+Void* PoolAllocator::Allocate(UInt64 Size)
+{
+	if (Size > MaxElementSize)
+	{
+		return Memory::Malloc(Size);
+	}
+
+	PoolThreadCache* Cache = GlobalThreadCaches[PoolIndex];
+	if (!Cache)
+	{
+		Cache = CreateThreadCache();
+	}
+
+	const UInt32 SizeClassIndex = GetSizeClassIndex(Size);
+
+	PoolThreadCache::FreeList& FreeList = Cache->FreeLists[SizeClassIndex];
+	if (!FreeList.Head)
+	{
+		RefillThreadCache(Cache, SizeClassIndex);
+	}
+
+	PoolFreeElement* Element = FreeList.Head;
+	FreeList.Head = Element->Next;
+	FreeList.NumElements--;
+
+	std::atomic<Int64>& NumAllocations = Cache->NumAllocations[SizeClassIndex];
+	NumAllocations.store(NumAllocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	return Element;
+}
+
+void PoolAllocator::Free(Void* Ptr, UInt64 Size)
+{
+	if (!Ptr)
+	{
+		return;
+	}
+
+	if (Size > MaxElementSize)
+	{
+		Memory::Free(Ptr);
+		return;
+	}
+
+	PoolThreadCache* Cache = GlobalThreadCaches[PoolIndex];
+	if (!Cache)
+	{
+		Cache = CreateThreadCache();
+	}
+
+	const UInt32 SizeClassIndex = GetSizeClassIndex(Size);
+
+	PoolFreeElement* Element = reinterpret_cast<PoolFreeElement*>(Ptr);
+	PoolThreadCache::FreeList& FreeList = Cache->FreeLists[SizeClassIndex];
+	Element->Next = FreeList.Head;
+	FreeList.Head = Element;
+	FreeList.NumElements++;
+
+	std::atomic<Int64>& NumAllocations = Cache->NumAllocations[SizeClassIndex];
+	NumAllocations.store(NumAllocations.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+
+	const UInt32 BatchSize = GetBatchSize(SizeClassIndex);
+	if (FreeList.NumElements > BatchSize * 2)
+	{
+		FlushThreadCache(Cache, SizeClassIndex, BatchSize);
+	}
+}
+
+PoolAllocatorStatistics PoolAllocator::GetStatistics() const
+{
+	PoolAllocatorStatistics Statistics;
+	{
+		std::lock_guard<std::mutex> Lock(ThreadCachesMutex);
+		for (const PoolThreadCache* Cache = ThreadCaches; Cache; Cache = Cache->Next)
+		{
+			for (UInt32 Index = 0; Index < NumSizeClasses; Index++)
+			{
+				const Int64 NumAllocations = Cache->NumAllocations[Index].load(std::memory_order_relaxed);
+				Statistics.NumAllocations	+= NumAllocations;
+				Statistics.AllocatedBytes	+= NumAllocations * GetElementSize(Index);
+			}
+		}
+
+		Statistics.NumThreads = NumThreadCaches;
+	}
+
+	for (const SizeClass& Class : SizeClasses)
+	{
+		std::lock_guard<std::mutex> Lock(Class.Mutex);
+		Statistics.ReservedBytes += Class.NumChunks * ChunkSize;
+	}
+
+	return Statistics;
+}
+
+void PoolAllocator::ReleaseThreadCache(PoolThreadCache* Cache)
+{
+	// The cache stays in the list since its allocation count is still needed for the statistics
+	for (UInt32 Index = 0; Index < NumSizeClasses; Index++)
+	{
+		const UInt32 NumElements = Cache->FreeLists[Index].NumElements;
+		if (NumElements > 0)
+		{
+			FlushThreadCache(Cache, Index, NumElements);
+		}
+	}
+}
+
+PoolThreadCache* PoolAllocator::CreateThreadCache()
+{
+	// Makes sure that the owner is constructed so that the cache is released when the thread exits
+	UNREFERENCED_VARIABLE(GlobalThreadCacheOwner);
+
+	PoolThreadCache* Cache = nullptr;
+	{
+		std::lock_guard<std::mutex> Lock(GlobalPoolsMutex);
+		if (static_cast<UInt64>(GlobalThreadCacheEnd - GlobalThreadCacheCursor) < sizeof(PoolThreadCache))
+		{
+			GlobalThreadCacheCursor	= reinterpret_cast<Byte*>(AllocateChunk());
+			GlobalThreadCacheEnd	= GlobalThreadCacheCursor + ChunkSize;
+			VALIDATE(GlobalThreadCacheCursor != nullptr);
+		}
+
+		Cache = new(reinterpret_cast<Void*>(GlobalThreadCacheCursor)) PoolThreadCache();
+		GlobalThreadCacheCursor += Math::AlignUp<UInt64>(sizeof(PoolThreadCache), alignof(PoolThreadCache));
+	}
+
+	GlobalThreadCaches[PoolIndex] = Cache;
+
+	std::lock_guard<std::mutex> Lock(ThreadCachesMutex);
+	Cache->Next		= ThreadCaches;
+	ThreadCaches	= Cache;
+	NumThreadCaches++;
+
+	return Cache;
+}
+
+void PoolAllocator::RefillThreadCache(PoolThreadCache* Cache, UInt32 SizeClassIndex)
+{
+	const UInt64 ElementSize	= GetElementSize(SizeClassIndex);
+	const UInt32 BatchSize		= GetBatchSize(SizeClassIndex);
+
+	PoolThreadCache::FreeList& FreeList = Cache->FreeLists[SizeClassIndex];
+	SizeClass& Class = SizeClasses[SizeClassIndex];
+
+	std::lock_guard<std::mutex> Lock(Class.Mutex);
+	while (FreeList.NumElements < BatchSize && Class.FreeList)
+	{
+		PoolFreeElement* Element = Class.FreeList;
+		Class.FreeList = Element->Next;
+
+		Element->Next = FreeList.Head;
+		FreeList.Head = Element;
+		FreeList.NumElements++;
+	}
+
+	// New elements are taken from the end of the chunk in address order, so objects that are created together are
+	// next to each other in memory
+	UInt32 NumNewElements = BatchSize - FreeList.NumElements;
+	while (NumNewElements > 0)
+	{
+		if (static_cast<UInt64>(Class.ChunkEnd - Class.ChunkCursor) < ElementSize)
+		{
+			Byte* Chunk = reinterpret_cast<Byte*>(AllocateChunk());
+			VALIDATE(Chunk != nullptr);
+
+			Class.ChunkCursor	= Chunk;
+			Class.ChunkEnd		= Chunk + ChunkSize;
+			Class.NumChunks++;
+		}
+
+		const UInt64 NumAvailable	= static_cast<UInt64>(Class.ChunkEnd - Class.ChunkCursor) / ElementSize;
+		const UInt32 NumElements	= static_cast<UInt32>(std::min<UInt64>(NumAvailable, NumNewElements));
+
+		// Linked backwards so that the element with the lowest address is handed out first
+		Byte* Cursor = Class.ChunkCursor + (NumElements - 1) * ElementSize;
+		for (UInt32 Index = 0; Index < NumElements; Index++)
+		{
+			PoolFreeElement* Element = reinterpret_cast<PoolFreeElement*>(Cursor);
+			Element->Next = FreeList.Head;
+			FreeList.Head = Element;
+			Cursor -= ElementSize;
+		}
+
+		FreeList.NumElements	+= NumElements;
+		Class.ChunkCursor		+= NumElements * ElementSize;
+		NumNewElements			-= NumElements;
+	}
+}
+
+void PoolAllocator::FlushThreadCache(PoolThreadCache* Cache, UInt32 SizeClassIndex, UInt32 NumElements)
+{
+	VALIDATE(NumElements > 0);
+
+	PoolThreadCache::FreeList& FreeList = Cache->FreeLists[SizeClassIndex];
+	VALIDATE(NumElements <= FreeList.NumElements);
+
+	PoolFreeElement* First	= FreeList.Head;
+	PoolFreeElement* Last	= First;
+	for (UInt32 Index = 1; Index < NumElements; Index++)
+	{
+		Last = Last->Next;
+	}
+
+	FreeList.Head = Last->Next;
+	FreeList.NumElements -= NumElements;
+
+	SizeClass& Class = SizeClasses[SizeClassIndex];
+
+	std::lock_guard<std::mutex> Lock(Class.Mutex);
+	Last->Next		= Class.FreeList;
+	Class.FreeList	= First;
+}
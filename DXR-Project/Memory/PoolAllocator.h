@@ -0,0 +1,141 @@
+#pragma once
+#include "Defines.h"
+#include "Types.h"
+
+#include <mutex>
+
+/*
+* PoolAllocatorStatistics
+*/
+
+struct PoolAllocatorStatistics
+{
+	// Bytes in elements that are currently allocated, rounded up to the size class
+	UInt64 AllocatedBytes	= 0;
+	// Bytes in chunks, the difference to AllocatedBytes is free elements
+	UInt64 ReservedBytes	= 0;
+	UInt64 NumAllocations	= 0;
+	UInt32 NumThreads		= 0;
+};
+
+/*
+* PoolAllocator - Allocates objects from size classes with a step of SizeClassGranularity bytes. Each size class hands
+* out elements of one size from large chunks, so objects of the same type end up next to each other. Every thread
+* keeps a cache of free elements for each size class and only takes the lock of the size class to exchange a batch of
+* elements with the shared free list. Larger objects go to Memory::Malloc.
+*
+* Chunks are kept until the process exits and pools are never destroyed, objects with static storage can be released
+* after all other statics are gone.
+*/
+
+struct PoolFreeElement;
+struct PoolThreadCache;
+
+class PoolAllocator
+{
+public:
+	static constexpr UInt32 SizeClassGranularity	= 16;
+	static constexpr UInt32 NumSizeClasses			= 32;
+	static constexpr UInt32 MaxElementSize			= SizeClassGranularity * NumSizeClasses;
+	static constexpr UInt32 ChunkSize				= 64 * 1024;
+	static constexpr UInt32 MaxPools				= 16;
+
+	PoolAllocator(const PoolAllocator& Other) = delete;
+	PoolAllocator& operator=(const PoolAllocator& Other) = delete;
+
+	// Pools live until the process exits, the name is expected to be a string literal
+	static PoolAllocator& Create(const Char* InDebugName);
+
+	static UInt32			GetNumPools();
+	static PoolAllocator&	GetPool(UInt32 Index);
+
+	Void*	Allocate(UInt64 Size);
+	void	Free(Void* Ptr, UInt64 Size);
+
+	PoolAllocatorStatistics GetStatistics() const;
+
+	FORCEINLINE const Char* GetDebugName() const
+	{
+		return DebugName;
+	}
+
+	// Called when a thread exits, the elements that the thread has cached are returned to the shared free lists
+	void ReleaseThreadCache(PoolThreadCache* Cache);
+
+private:
+	PoolAllocator(const Char* InDebugName, UInt32 InPoolIndex);
+	~PoolAllocator() = default;
+
+	PoolThreadCache* CreateThreadCache();
+
+	void RefillThreadCache(PoolThreadCache* Cache, UInt32 SizeClassIndex);
+	void FlushThreadCache(PoolThreadCache* Cache, UInt32 SizeClassIndex, UInt32 NumElements);
+
+	struct SizeClass
+	{
+		mutable std::mutex	Mutex;
+		PoolFreeElement*	FreeList	= nullptr;
+		Byte*				ChunkCursor	= nullptr;
+		Byte*				ChunkEnd	= nullptr;
+		UInt64				NumChunks	= 0;
+	};
+
+	SizeClass	SizeClasses[NumSizeClasses];
+	const Char*	DebugName;
+	UInt32		PoolIndex;
+
+	mutable std::mutex	ThreadCachesMutex;
+	PoolThreadCache*	ThreadCaches	= nullptr;
+	UInt32				NumThreadCaches	= 0;
+};
+
+/*
+* Helper macros, POOL_ALLOCATED gives a class and all classes that derive from it a pool of their own. Classes with
+* virtual destructors get the size of the derived class in operator delete. The pool is not tracked by the CRT, in debug
+* builds DBG_NEW also allocates from the pool and the file and line are ignored.
+*/
+
+#ifdef _DEBUG
+	// Overload for DBG_NEW. The delete is only called when a constructor throws and does not get the size, so the element
+	// stays in use. MakeShared and MakeUnique are noexcept and terminate in that case anyway
+	#define POOL_ALLOCATED_DEBUG_NEW() \
+	FORCEINLINE static Void* operator new(size_t Size, int, const char*, int) \
+	{ \
+		return GetPoolAllocator().Allocate(Size); \
+	} \
+	\
+	FORCEINLINE static void operator delete(Void*, int, const char*, int) noexcept \
+	{ \
+	}
+#else
+	#define POOL_ALLOCATED_DEBUG_NEW()
+#endif
+
+#define POOL_ALLOCATED(TClass) \
+public: \
+	static PoolAllocator& GetPoolAllocator() \
+	{ \
+		static PoolAllocator& Allocator = PoolAllocator::Create(#TClass); \
+		return Allocator; \
+	} \
+	\
+	FORCEINLINE static Void* operator new(size_t Size) \
+	{ \
+		return GetPoolAllocator().Allocate(Size); \
+	} \
+	\
+	FORCEINLINE static void operator delete(Void* Ptr, size_t Size) noexcept \
+	{ \
+		GetPoolAllocator().Free(Ptr, Size); \
+	} \
+	\
+	FORCEINLINE static Void* operator new(size_t, Void* Where) noexcept \
+	{ \
+		return Where; \
+	} \
+	\
+	FORCEINLINE static void operator delete(Void*, Void*) noexcept \
+	{ \
+	} \
+	\
+	POOL_ALLOCATED_DEBUG_NEW()
\ No newline at end of file
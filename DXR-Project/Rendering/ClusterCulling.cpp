@@ -0,0 +1,79 @@
+#include "ClusterCulling.h"
+
+void CullMeshlets(
+	const MeshletData& Meshlets,
+	const XMFLOAT4X4& Transform,
+	const Frustum& ViewFrustum,
+	const XMFLOAT3& CameraPosition,
+	TArray<MeshletDrawRange>& OutRanges,
+	ClusterCullStatistics& OutStatistics)
+{
+	XMMATRIX World = XMMatrixTranspose(XMLoadFloat4x4(&Transform));
+
+	// The radius is scaled by the largest axis, the cones are only valid for uniform scales
+	const Float ScaleX = XMVectorGetX(XMVector3Length(World.r[0]));
+	const Float ScaleY = XMVectorGetX(XMVector3Length(World.r[1]));
+	const Float ScaleZ = XMVectorGetX(XMVector3Length(World.r[2]));
+	const Float MaxScale = std::max<Float>(ScaleX, std::max<Float>(ScaleY, ScaleZ));
+	const Float MinScale = std::min<Float>(ScaleX, std::min<Float>(ScaleY, ScaleZ));
+
+	const bool IsMirrored		= XMVectorGetX(XMMatrixDeterminant(World)) < 0.0f;
+	const bool UseNormalCones	= !IsMirrored && (MinScale > 0.0f) && (MaxScale <= MinScale * 1.01f);
+
+	XMVECTOR Camera = XMLoadFloat3(&CameraPosition);
+
+	const UInt32 FirstRange = OutRanges.Size();
+
+	OutStatistics.NumMeshlets += Meshlets.Meshlets.Size();
+	for (const Meshlet& CurrentMeshlet : Meshlets.Meshlets)
+	{
+		OutStatistics.NumTriangles += CurrentMeshlet.TriangleCount;
+
+		XMVECTOR Center		= XMVector3Transform(XMLoadFloat3(&CurrentMeshlet.SphereCenter), World);
+		const Float Radius	= CurrentMeshlet.SphereRadius * MaxScale;
+
+		XMFLOAT3 WorldCenter;
+		XMStoreFloat3(&WorldCenter, Center);
+
+		AABB Box;
+		Box.Top		= XMFLOAT3(WorldCenter.x + Radius, WorldCenter.y + Radius, WorldCenter.z + Radius);
+		Box.Bottom	= XMFLOAT3(WorldCenter.x - Radius, WorldCenter.y - Radius, WorldCenter.z - Radius);
+		if (!ViewFrustum.CheckAABB(Box))
+		{
+			OutStatistics.NumFrustumTriangles += CurrentMeshlet.TriangleCount;
+			continue;
+		}
+
+		/*
+		* All triangles face away from the camera if the direction to every point in the sphere is within 90 degrees minus
+		* the cone angle of the axis. Expanding the sphere on both sides of the test keeps it conservative.
+		*/
+		if (UseNormalCones && CurrentMeshlet.ConeCutoff < 1.0f)
+		{
+			XMVECTOR Axis		= XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&CurrentMeshlet.ConeAxis), World));
+			XMVECTOR Direction	= XMVectorSubtract(Center, Camera);
+			const Float Distance	= XMVectorGetX(XMVector3Length(Direction));
+			const Float Projected	= XMVectorGetX(XMVector3Dot(Direction, Axis));
+			if (Projected - Radius > CurrentMeshlet.ConeCutoff * (Distance + Radius))
+			{
+				OutStatistics.NumBackfaceTriangles += CurrentMeshlet.TriangleCount;
+				continue;
+			}
+		}
+
+		OutStatistics.NumVisibleMeshlets++;
+
+		// Meshlets are stored in indexbuffer order, so a meshlet that directly follows the last range extends it
+		const UInt32 IndexCount = CurrentMeshlet.TriangleCount * 3;
+		if (OutRanges.Size() > FirstRange && (OutRanges.Back().IndexOffset + OutRanges.Back().IndexCount == CurrentMeshlet.IndexOffset))
+		{
+			OutRanges.Back().IndexCount += IndexCount;
+		}
+		else
+		{
+			MeshletDrawRange& Range = OutRanges.EmplaceBack();
+			Range.IndexOffset	= CurrentMeshlet.IndexOffset;
+			Range.IndexCount	= IndexCount;
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "MeshFactory.h"
+
+#include "Scene/Frustum.h"
+
+/*
+* MeshletDrawRange - Range of the indexbuffer of a mesh, adjacent visible meshlets are merged into one range
+*/
+
+struct MeshletDrawRange
+{
+	UInt32 IndexOffset	= 0;
+	UInt32 IndexCount	= 0;
+};
+
+/*
+* ClusterCullStatistics
+*/
+
+struct ClusterCullStatistics
+{
+	FORCEINLINE void Add(const ClusterCullStatistics& Other)
+	{
+		NumMeshlets				+= Other.NumMeshlets;
+		NumVisibleMeshlets		+= Other.NumVisibleMeshlets;
+		NumTriangles			+= Other.NumTriangles;
+		NumFrustumTriangles		+= Other.NumFrustumTriangles;
+		NumBackfaceTriangles	+= Other.NumBackfaceTriangles;
+	}
+
+	UInt32 NumMeshlets			= 0;
+	UInt32 NumVisibleMeshlets	= 0;
+	UInt32 NumTriangles			= 0;
+	// Triangles rejected by the frustum test and the normal cone test
+	UInt32 NumFrustumTriangles	= 0;
+	UInt32 NumBackfaceTriangles	= 0;
+};
+
+/*
+* Tests the meshlets of a mesh against a frustum and the normal cones against the camera position. Transform is the
+* transposed world matrix, the same as Transform::GetMatrix. The normal cones are only used when the transform has a
+* uniform scale and does not mirror, since the meshlets are expected to be drawn with backface culling. Appends the
+* visible ranges to OutRanges and is threadsafe.
+*/
+
+void CullMeshlets(
+	const MeshletData& Meshlets,
+	const XMFLOAT4X4& Transform,
+	const Frustum& ViewFrustum,
+	const XMFLOAT3& CameraPosition,
+	TArray<MeshletDrawRange>& OutRanges,
+	ClusterCullStatistics& OutStatistics);
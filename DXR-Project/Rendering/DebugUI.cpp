@@ -10,6 +10,11 @@
 
 #include "Containers/TArray.h"
 
+#include "Memory/FrameAllocator.h"
+
+#include <cstdarg>
+#include <cstdio>
+
 #include "Rendering/TextureFactory.h"
 
 #include "D3D12/D3D12Device.h"
@@ -23,8 +28,10 @@
 
 #include "RenderingCore/RenderingAPI.h"
 
+// Strings drawn after the renderer has rendered the UI are shown during the next frame, which is why the frame memory
+// has to be buffered for at least two frames
 static TArray<DebugUI::UIDrawFunc>	GlobalDrawFuncs;
-static TArray<std::string>			GlobalDebugStrings;
+static TArray<const Char*>			GlobalDebugStrings;
 
 struct ImGuiState
 {
@@ -408,9 +415,35 @@ void DebugUI::DrawUI(UIDrawFunc DrawFunc)
 	GlobalDrawFuncs.EmplaceBack(DrawFunc);
 }
 
-void DebugUI::DrawDebugString(const std::string& DebugString)
+void DebugUI::DrawDebugString(const Char* Format, ...)
 {
-	GlobalDebugStrings.EmplaceBack(DebugString);
+	// Most strings fit on the stack, longer ones are formatted again directly into frame memory
+	Char Buffer[256];
+
+	va_list Args;
+	va_start(Args, Format);
+	const Int32 Length = vsnprintf(Buffer, sizeof(Buffer), Format, Args);
+	va_end(Args);
+
+	if (Length < 0)
+	{
+		return;
+	}
+
+	if (Length < static_cast<Int32>(sizeof(Buffer)))
+	{
+		GlobalDebugStrings.EmplaceBack(FrameAllocator::CopyString(Buffer));
+	}
+	else
+	{
+		Char* String = reinterpret_cast<Char*>(FrameAllocator::Malloc(Length + 1, 1));
+
+		va_start(Args, Format);
+		vsnprintf(String, Length + 1, Format, Args);
+		va_end(Args);
+
+		GlobalDebugStrings.EmplaceBack(String);
+	}
 }
 
 bool DebugUI::OnEvent(const Event& Event)
@@ -540,9 +573,9 @@ void DebugUI::Render(D3D12CommandList* CommandList)
 	ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 1.0f, 0.0f, 1.0f));
 
 	// TODO: Draw strings
-	for (const std::string& Str : GlobalDebugStrings)
+	for (const Char* Str : GlobalDebugStrings)
 	{
-		ImGui::Text(Str.c_str());
+		ImGui::TextUnformatted(Str);
 	}
 	GlobalDebugStrings.Clear();
 
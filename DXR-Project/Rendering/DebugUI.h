@@ -17,7 +17,8 @@ public:
 	static void Release();
 
 	static void DrawUI(UIDrawFunc DrawFunc);
-	static void DrawDebugString(const std::string& DebugString);
+	// Printf style, the formatted string is stored in frame memory
+	static void DrawDebugString(const Char* Format, ...);
 
 	static bool OnEvent(const Event& Event);
 	
@@ -21,9 +21,25 @@ Mesh::~Mesh()
 
 bool Mesh::Initialize(const MeshData& Data)
 {
+	MeshUploadStorage Storage;
+	return Initialize(PrepareUpload(Data, Storage));
+}
+
+bool Mesh::Initialize(const MeshUploadData& Data)
+{
+	VertexCount		= Data.VertexCount;
+	VertexStride	= Data.VertexStride;
+	IndexCount		= Data.IndexCount;
+	IndexFormat		= Data.IndexFormat;
+	Quantization	= Data.Quantization;
+	BoundingBox		= Data.BoundingBox;
+
+	// The size is aligned so that the indices can also be read as a raw buffer
+	const UInt32 IndexBufferSize = Math::AlignUp<UInt32>(IndexCount * GetIndexStride(), sizeof(UInt32));
+
 	// Create VertexBuffer
 	BufferProperties BufferProps = { };
-	BufferProps.SizeInBytes = Data.Vertices.Size() * sizeof(Vertex);
+	BufferProps.SizeInBytes = VertexCount * VertexStride;
 	BufferProps.Flags		= D3D12_RESOURCE_FLAG_NONE;
 	BufferProps.InitalState = D3D12_RESOURCE_STATE_COMMON;
 	BufferProps.MemoryType	= EMemoryType::MEMORY_TYPE_DEFAULT;
@@ -35,7 +51,7 @@ bool Mesh::Initialize(const MeshData& Data)
 	}
 
 	// Create IndexBuffer
-	BufferProps.SizeInBytes = Data.Indices.Size() * sizeof(UInt32);
+	BufferProps.SizeInBytes = IndexBufferSize;
 
 	IndexBuffer = RenderingAPI::Get().CreateBuffer(BufferProps);
 	if (!IndexBuffer)
@@ -43,19 +59,16 @@ bool Mesh::Initialize(const MeshData& Data)
 		return false;
 	}
 
-	VertexCount = static_cast<UInt32>(Data.Vertices.Size());
-	IndexCount	= static_cast<UInt32>(Data.Indices.Size());
-
 	// Upload data
 	TSharedPtr<D3D12ImmediateCommandList> CommandList = RenderingAPI::StaticGetImmediateCommandList();
 	CommandList->TransitionBarrier(VertexBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
 	CommandList->TransitionBarrier(IndexBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
 	
-	UInt32 SizeInBytes = Data.Vertices.Size() * sizeof(Vertex);
-	CommandList->UploadBufferData(VertexBuffer.Get(), 0, Data.Vertices.Data(), SizeInBytes);
+	UInt32 SizeInBytes = VertexCount * VertexStride;
+	CommandList->UploadBufferData(VertexBuffer.Get(), 0, Data.VertexData, SizeInBytes);
 	
-	SizeInBytes = Data.Indices.Size() * sizeof(UInt32);
-	CommandList->UploadBufferData(IndexBuffer.Get(), 0, Data.Indices.Data(), SizeInBytes);
+	SizeInBytes = IndexCount * GetIndexStride();
+	CommandList->UploadBufferData(IndexBuffer.Get(), 0, Data.IndexData, SizeInBytes);
 
 	CommandList->TransitionBarrier(VertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 	CommandList->TransitionBarrier(IndexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_INDEX_BUFFER);
@@ -76,13 +89,13 @@ bool Mesh::Initialize(const MeshData& Data)
 		SrvDesc.Buffer.FirstElement			= 0;
 		SrvDesc.Buffer.Flags				= D3D12_BUFFER_SRV_FLAG_NONE;
 		SrvDesc.Buffer.NumElements			= VertexCount;
-		SrvDesc.Buffer.StructureByteStride	= sizeof(Vertex);
+		SrvDesc.Buffer.StructureByteStride	= VertexStride;
 
 		VertexBuffer->SetShaderResourceView(TSharedPtr(RenderingAPI::Get().CreateShaderResourceView(VertexBuffer->GetResource(), &SrvDesc)), 0);
 
 		SrvDesc.Format						= DXGI_FORMAT_R32_TYPELESS;
 		SrvDesc.Buffer.Flags				= D3D12_BUFFER_SRV_FLAG_RAW;
-		SrvDesc.Buffer.NumElements			= static_cast<UInt32>(IndexCount);
+		SrvDesc.Buffer.NumElements			= IndexBufferSize / sizeof(UInt32);
 		SrvDesc.Buffer.StructureByteStride	= 0;
 
 		IndexBuffer->SetShaderResourceView(TSharedPtr(RenderingAPI::Get().CreateShaderResourceView(IndexBuffer->GetResource(), &SrvDesc)), 0);
@@ -93,14 +106,17 @@ bool Mesh::Initialize(const MeshData& Data)
 		DescriptorTable->CopyDescriptors();
 	}
 
-	// Create AABB
-	CreateBoundingBox(Data);
+	CreateOccluderData(Data);
+
+	Meshlets.Meshlets	= TArray<Meshlet>(Data.Meshlets, Data.Meshlets + Data.NumMeshlets);
+	Meshlets.Vertices	= TArray<UInt32>(Data.MeshletVertices, Data.MeshletVertices + Data.NumMeshletVertices);
+	Meshlets.Triangles	= TArray<UInt8>(Data.MeshletTriangles, Data.MeshletTriangles + Data.MeshletTrianglesSize);
 	return true;
 }
 
 bool Mesh::BuildAccelerationStructure(D3D12CommandList* CommandList)
 {
-	return RayTracingGeometry->BuildAccelerationStructure(CommandList, VertexBuffer, VertexCount, IndexBuffer, IndexCount);
+	return RayTracingGeometry->BuildAccelerationStructure(CommandList, VertexBuffer, VertexCount, IndexBuffer, IndexCount, IndexFormat);
 }
 
 TSharedPtr<Mesh> Mesh::Make(const MeshData& Data)
@@ -116,8 +132,51 @@ TSharedPtr<Mesh> Mesh::Make(const MeshData& Data)
 	}
 }
 
-void Mesh::CreateBoundingBox(const MeshData& Data)
+TSharedPtr<Mesh> Mesh::Make(const MeshUploadData& Data)
+{
+	TSharedPtr<Mesh> Result = MakeShared<Mesh>();
+	if (Result->Initialize(Data))
+	{
+		return Result;
+	}
+	else
+	{
+		return TSharedPtr<Mesh>(nullptr);
+	}
+}
+
+MeshUploadData Mesh::PrepareUpload(const MeshData& Data, MeshUploadStorage& OutStorage)
 {
+	MeshUploadData Result;
+	Result.VertexCount	= Data.Vertices.Size();
+	Result.IndexCount	= Data.Indices.Size();
+
+#if ENABLE_PACKED_VERTICES
+	MeshFactory::PackVertices(Data, OutStorage.PackedVertices, Result.Quantization);
+
+	Result.VertexData	= OutStorage.PackedVertices.Data();
+	Result.VertexStride	= sizeof(PackedVertex);
+#else
+	Result.VertexData	= Data.Vertices.Data();
+	Result.VertexStride	= sizeof(Vertex);
+#endif
+
+	// Every index fits in 16 bits when there are few vertices, which is the case for most meshes
+	Result.IndexData	= Data.Indices.Data();
+	Result.IndexFormat	= DXGI_FORMAT_R32_UINT;
+	if (Data.Vertices.Size() <= 65536)
+	{
+		OutStorage.ShortIndices.Resize(Data.Indices.Size());
+		for (UInt32 Index = 0; Index < Data.Indices.Size(); Index++)
+		{
+			OutStorage.ShortIndices[Index] = static_cast<UInt16>(Data.Indices[Index]);
+		}
+
+		Result.IndexData	= OutStorage.ShortIndices.Data();
+		Result.IndexFormat	= DXGI_FORMAT_R16_UINT;
+	}
+
+	// Create AABB
 	constexpr Float Inf = std::numeric_limits<Float>::infinity();
 	XMFLOAT3 Min = XMFLOAT3(Inf, Inf, Inf);
 	XMFLOAT3 Max = XMFLOAT3(-Inf, -Inf, -Inf);
@@ -135,6 +194,52 @@ void Mesh::CreateBoundingBox(const MeshData& Data)
 		Max.z = std::max<Float>(Max.z, Vertex.Position.z);
 	}
 
-	BoundingBox.Top		= Max;
-	BoundingBox.Bottom	= Min;
+	Result.BoundingBox.Top		= Max;
+	Result.BoundingBox.Bottom	= Min;
+
+	MeshFactory::CreateMeshlets(Data, OutStorage.Meshlets);
+	Result.Meshlets				= OutStorage.Meshlets.Meshlets.Data();
+	Result.MeshletVertices		= OutStorage.Meshlets.Vertices.Data();
+	Result.MeshletTriangles		= OutStorage.Meshlets.Triangles.Data();
+	Result.NumMeshlets			= OutStorage.Meshlets.Meshlets.Size();
+	Result.NumMeshletVertices	= OutStorage.Meshlets.Vertices.Size();
+	Result.MeshletTrianglesSize	= OutStorage.Meshlets.Triangles.Size();
+	return Result;
+}
+
+void Mesh::CreateOccluderData(const MeshUploadData& Data)
+{
+	OccluderPositions.Resize(VertexCount);
+
+#if ENABLE_PACKED_VERTICES
+	const PackedVertex* Vertices = reinterpret_cast<const PackedVertex*>(Data.VertexData);
+
+	XMVECTOR XmScale	= XMLoadFloat4(&Quantization.Scale);
+	XMVECTOR XmOffset	= XMLoadFloat4(&Quantization.Offset);
+	for (UInt32 Index = 0; Index < VertexCount; Index++)
+	{
+		XMVECTOR XmPosition = PackedVector::XMLoadShortN4(&Vertices[Index].Position);
+		XMStoreFloat3(&OccluderPositions[Index], XMVectorMultiplyAdd(XmPosition, XmScale, XmOffset));
+	}
+#else
+	const Vertex* Vertices = reinterpret_cast<const Vertex*>(Data.VertexData);
+	for (UInt32 Index = 0; Index < VertexCount; Index++)
+	{
+		OccluderPositions[Index] = Vertices[Index].Position;
+	}
+#endif
+
+	OccluderIndices.Resize(IndexCount);
+	if (IndexFormat == DXGI_FORMAT_R16_UINT)
+	{
+		const UInt16* Indices = reinterpret_cast<const UInt16*>(Data.IndexData);
+		for (UInt32 Index = 0; Index < IndexCount; Index++)
+		{
+			OccluderIndices[Index] = Indices[Index];
+		}
+	}
+	else
+	{
+		memcpy(OccluderIndices.Data(), Data.IndexData, IndexCount * sizeof(UInt32));
+	}
 }
@@ -9,6 +9,42 @@
 
 #include "Scene/AABB.h"
 
+/*
+* MeshUploadData - A mesh in the format that it is uploaded in. The data is not owned, it either points into a MeshData,
+* a MeshUploadStorage or directly into a mapped cache file.
+*/
+
+struct MeshUploadData
+{
+	const Void*	VertexData		= nullptr;
+	const Void*	IndexData		= nullptr;
+	UInt32		VertexCount		= 0;
+	UInt32		VertexStride	= 0;
+	UInt32		IndexCount		= 0;
+	DXGI_FORMAT	IndexFormat		= DXGI_FORMAT_R32_UINT;
+
+	VertexQuantization	Quantization;
+	AABB				BoundingBox;
+
+	const Meshlet*	Meshlets				= nullptr;
+	const UInt32*	MeshletVertices			= nullptr;
+	const UInt8*	MeshletTriangles		= nullptr;
+	UInt32			NumMeshlets				= 0;
+	UInt32			NumMeshletVertices		= 0;
+	UInt32			MeshletTrianglesSize	= 0;
+};
+
+/*
+* MeshUploadStorage - Owns the converted data that a MeshUploadData created by Mesh::PrepareUpload points to
+*/
+
+struct MeshUploadStorage
+{
+	TArray<PackedVertex>	PackedVertices;
+	TArray<UInt16>			ShortIndices;
+	MeshletData				Meshlets;
+};
+
 /*
 * Mesh
 */
@@ -20,13 +56,23 @@ public:
 	~Mesh();
 
 	bool Initialize(const MeshData& Data);
+	bool Initialize(const MeshUploadData& Data);
 	
 	bool BuildAccelerationStructure(D3D12CommandList* CommandList);
 
 	static TSharedPtr<Mesh> Make(const MeshData& Data);
+	static TSharedPtr<Mesh> Make(const MeshUploadData& Data);
+
+	// Converts the data on the CPU, does not touch the GPU and can be called from any thread
+	static MeshUploadData PrepareUpload(const MeshData& Data, MeshUploadStorage& OutStorage);
+
+	FORCEINLINE UInt32 GetIndexStride() const
+	{
+		return (IndexFormat == DXGI_FORMAT_R16_UINT) ? sizeof(UInt16) : sizeof(UInt32);
+	}
 
 public:
-	void CreateBoundingBox(const MeshData& Data);
+	void CreateOccluderData(const MeshUploadData& Data);
 
 	TSharedPtr<D3D12Buffer>				VertexBuffer;
 	TSharedPtr<D3D12Buffer>				IndexBuffer;
@@ -35,8 +81,25 @@ public:
 	
 	UInt32 VertexCount	= 0;
 	UInt32 IndexCount	= 0;
+	UInt32 VertexStride	= sizeof(Vertex);
+
+	// DXGI_FORMAT_R16_UINT when all vertices can be indexed with 16 bits
+	DXGI_FORMAT IndexFormat = DXGI_FORMAT_R32_UINT;
+
+	// Restores the positions in the vertexbuffer when ENABLE_PACKED_VERTICES is set
+	VertexQuantization Quantization;
 
 	Float ShadowOffset = 0.0f;
 
+	// Largest distance from the original mesh when this mesh is a simplified LOD, in the same units as the positions
+	Float LODError = 0.0f;
+
 	AABB BoundingBox;
+
+	// CPU copy of the geometry used when rasterizing occluders
+	TArray<XMFLOAT3>	OccluderPositions;
+	TArray<UInt32>		OccluderIndices;
+
+	// Used to cull parts of the mesh, the meshlets cover the indexbuffer in order
+	MeshletData Meshlets;
 };
\ No newline at end of file
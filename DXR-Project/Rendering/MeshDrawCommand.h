@@ -13,6 +13,8 @@ struct MeshDrawCommand
 	class Material*	Material		= nullptr;
 	class Mesh*		Mesh			= nullptr;
 	class Actor*	CurrentActor	= nullptr;
+
+	class MeshComponent* Component = nullptr;
 	
 	D3D12Buffer* VertexBuffer	= nullptr;
 	D3D12Buffer* IndexBuffer	= nullptr;
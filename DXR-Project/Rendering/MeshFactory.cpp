@@ -1,5 +1,23 @@
 #include "Rendering/MeshFactory.h"
 
+#include "Core/JobSystem.h"
+
+// The index decoder uses SSSE3 when it is enabled for the build. MSVC compiles the intrinsics without /arch, there the
+// CPU is checked when decoding. Otherwise only the scalar decoder is used
+#if defined(__SSSE3__) || defined(__AVX__)
+	#include <tmmintrin.h>
+	#define INDEX_DECODE_USE_SSSE3	1
+	#define INDEX_DECODE_CHECK_CPU	0
+#elif defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+	#include <tmmintrin.h>
+	#define INDEX_DECODE_USE_SSSE3	1
+	#define INDEX_DECODE_CHECK_CPU	1
+#else
+	#define INDEX_DECODE_USE_SSSE3	0
+	#define INDEX_DECODE_CHECK_CPU	0
+#endif
+
 //#include <assimp/Importer.hpp>
 //#include <assimp/scene.h>
 //#include <assimp/postprocess.h>
@@ -122,40 +140,40 @@ MeshData MeshFactory::CreateCube(Float Width, Float Height, Float Depth) noexcep
 	Cube.Vertices =
 	{
 		// FRONT FACE
-		{ XMFLOAT3(-HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  0.0f, -1.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) },
-		{ XMFLOAT3( HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  0.0f, -1.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) },
-		{ XMFLOAT3(-HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  0.0f, -1.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(0.0f, 1.0f) },
-		{ XMFLOAT3( HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  0.0f, -1.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(1.0f, 1.0f) },
+		{ XMFLOAT3(-HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  0.0f, -1.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
+		{ XMFLOAT3( HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  0.0f, -1.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
+		{ XMFLOAT3(-HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  0.0f, -1.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
+		{ XMFLOAT3( HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  0.0f, -1.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
 
 		// BACK FACE
-		{ XMFLOAT3( HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  0.0f,  1.0f), XMFLOAT3(-1.0f,  0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) },
-		{ XMFLOAT3(-HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  0.0f,  1.0f), XMFLOAT3(-1.0f,  0.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) },
-		{ XMFLOAT3( HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  0.0f,  1.0f), XMFLOAT3(-1.0f,  0.0f, 0.0f), XMFLOAT2(0.0f, 1.0f) },
-		{ XMFLOAT3(-HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  0.0f,  1.0f), XMFLOAT3(-1.0f,  0.0f, 0.0f), XMFLOAT2(1.0f, 1.0f) },
+		{ XMFLOAT3( HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  0.0f,  1.0f), XMFLOAT4(-1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
+		{ XMFLOAT3(-HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  0.0f,  1.0f), XMFLOAT4(-1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
+		{ XMFLOAT3( HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  0.0f,  1.0f), XMFLOAT4(-1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
+		{ XMFLOAT3(-HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  0.0f,  1.0f), XMFLOAT4(-1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
 
 		// RIGHT FACE
-		{ XMFLOAT3(HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(1.0f,  0.0f,  0.0f), XMFLOAT3(0.0f,  0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
-		{ XMFLOAT3(HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(1.0f,  0.0f,  0.0f), XMFLOAT3(0.0f,  0.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
-		{ XMFLOAT3(HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(1.0f,  0.0f,  0.0f), XMFLOAT3(0.0f,  0.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
-		{ XMFLOAT3(HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(1.0f,  0.0f,  0.0f), XMFLOAT3(0.0f,  0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
+		{ XMFLOAT3(HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(1.0f,  0.0f,  0.0f), XMFLOAT4(0.0f,  0.0f, 1.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
+		{ XMFLOAT3(HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(1.0f,  0.0f,  0.0f), XMFLOAT4(0.0f,  0.0f, 1.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
+		{ XMFLOAT3(HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(1.0f,  0.0f,  0.0f), XMFLOAT4(0.0f,  0.0f, 1.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
+		{ XMFLOAT3(HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(1.0f,  0.0f,  0.0f), XMFLOAT4(0.0f,  0.0f, 1.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
 
 		// LEFT FACE
-		{ XMFLOAT3(-HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(-1.0f,  0.0f,  0.0f), XMFLOAT3(0.0f,  0.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
-		{ XMFLOAT3(-HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(-1.0f,  0.0f,  0.0f), XMFLOAT3(0.0f,  0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
-		{ XMFLOAT3(-HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(-1.0f,  0.0f,  0.0f), XMFLOAT3(0.0f,  0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
-		{ XMFLOAT3(-HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(-1.0f,  0.0f,  0.0f), XMFLOAT3(0.0f,  0.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
+		{ XMFLOAT3(-HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(-1.0f,  0.0f,  0.0f), XMFLOAT4(0.0f,  0.0f, 1.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
+		{ XMFLOAT3(-HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(-1.0f,  0.0f,  0.0f), XMFLOAT4(0.0f,  0.0f, 1.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
+		{ XMFLOAT3(-HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(-1.0f,  0.0f,  0.0f), XMFLOAT4(0.0f,  0.0f, 1.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
+		{ XMFLOAT3(-HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(-1.0f,  0.0f,  0.0f), XMFLOAT4(0.0f,  0.0f, 1.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
 
 		// TOP FACE
-		{ XMFLOAT3(-HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  1.0f,  0.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) },
-		{ XMFLOAT3( HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  1.0f,  0.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) },
-		{ XMFLOAT3(-HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  1.0f,  0.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(0.0f, 1.0f) },
-		{ XMFLOAT3( HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  1.0f,  0.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(1.0f, 1.0f) },
+		{ XMFLOAT3(-HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  1.0f,  0.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
+		{ XMFLOAT3( HalfWidth,  HalfHeight,  HalfDepth), XMFLOAT3(0.0f,  1.0f,  0.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
+		{ XMFLOAT3(-HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  1.0f,  0.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
+		{ XMFLOAT3( HalfWidth,  HalfHeight, -HalfDepth), XMFLOAT3(0.0f,  1.0f,  0.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
 
 		// BOTTOM FACE
-		{ XMFLOAT3(-HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(0.0f, -1.0f,  0.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) },
-		{ XMFLOAT3( HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(0.0f, -1.0f,  0.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) },
-		{ XMFLOAT3(-HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(0.0f, -1.0f,  0.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(0.0f, 1.0f) },
-		{ XMFLOAT3( HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(0.0f, -1.0f,  0.0f), XMFLOAT3(1.0f,  0.0f, 0.0f), XMFLOAT2(1.0f, 1.0f) },
+		{ XMFLOAT3(-HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(0.0f, -1.0f,  0.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
+		{ XMFLOAT3( HalfWidth, -HalfHeight, -HalfDepth), XMFLOAT3(0.0f, -1.0f,  0.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
+		{ XMFLOAT3(-HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(0.0f, -1.0f,  0.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
+		{ XMFLOAT3( HalfWidth, -HalfHeight,  HalfDepth), XMFLOAT3(0.0f, -1.0f,  0.0f), XMFLOAT4(1.0f,  0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
 	};
 
 	Cube.Indices =
@@ -297,20 +315,22 @@ MeshData MeshFactory::CreateSphere(UInt32 Subdivisions, Float Radius) noexcept
 		Subdivide(Sphere, Subdivisions);
 	}
 
-	for (UInt32 i = 0; i < static_cast<UInt32>(Sphere.Vertices.Size()); i++)
+	ParallelFor(Sphere.Vertices, [Radius](Vertex& CurrentVertex)
 	{
 		// Calculate the new position, normal and tangent
-		XMVECTOR Position	= XMLoadFloat3(&Sphere.Vertices[i].Position);
+		XMVECTOR Position	= XMLoadFloat3(&CurrentVertex.Position);
 		Position			= XMVector3Normalize(Position);
-		XMStoreFloat3(&Sphere.Vertices[i].Normal, Position);
+		XMStoreFloat3(&CurrentVertex.Normal, Position);
 
 		Position = XMVectorScale(Position, Radius);
-		XMStoreFloat3(&Sphere.Vertices[i].Position, Position);
+		XMStoreFloat3(&CurrentVertex.Position, Position);
 	
 		// Calculate uvs
-		Sphere.Vertices[i].TexCoord.y = (asin(Sphere.Vertices[i].Position.y) / XM_PI) + 0.5f;
-		Sphere.Vertices[i].TexCoord.x = (atan2f(Sphere.Vertices[i].Position.z, Sphere.Vertices[i].Position.x) + XM_PI) / (2.0f * XM_PI);
-	}
+		CurrentVertex.TexCoord.y = (asin(CurrentVertex.Position.y) / XM_PI) + 0.5f;
+		CurrentVertex.TexCoord.x = (atan2f(CurrentVertex.Position.z, CurrentVertex.Position.x) + XM_PI) / (2.0f * XM_PI);
+	}, 256);
+
+	OptimizeForRendering(Sphere);
 
 	Sphere.Indices.ShrinkToFit();
 	Sphere.Vertices.ShrinkToFit();
@@ -604,235 +624,1793 @@ void MeshFactory::Subdivide(MeshData& OutData, UInt32 Subdivisions) noexcept
 		return;
 	}
 
-	Vertex TempVertices[3];
-	UInt32 IndexCount		= 0;
-	UInt32 VertexCount		= 0;
-	UInt32 OldVertexCount	= 0;
-	OutData.Vertices.Reserve((OutData.Vertices.Size() * static_cast<UInt32>(pow(2, Subdivisions))));
-	OutData.Indices.Reserve((OutData.Indices.Size() * static_cast<UInt32>(pow(4, Subdivisions))));
+	constexpr UInt32 EmptySlot = ~0u;
+
+	TArray<UInt64> EdgeKeys;
+	TArray<UInt32> EdgeTable;
+	TArray<UInt32> TriangleEdges;
+	TArray<UInt32> NewIndices;
 
 	for (UInt32 i = 0; i < Subdivisions; i++)
 	{
-		OldVertexCount	= UInt32(OutData.Vertices.Size());
-		IndexCount		= UInt32(OutData.Indices.Size());
-		for (UInt32 j = 0; j < IndexCount; j += 3)
+		const UInt32 OldVertexCount	= OutData.Vertices.Size();
+		const UInt32 IndexCount		= OutData.Indices.Size();
+
+		// Each edge can be shared by several triangles, so there is at most one edge per index
+		UInt32 TableSize = 1;
+		while (TableSize < IndexCount * 2)
 		{
-			// Calculate Position
-			XMVECTOR Position0 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j]].Position);
-			XMVECTOR Position1 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j + 1]].Position);
-			XMVECTOR Position2 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j + 2]].Position);
+			TableSize <<= 1;
+		}
 
-			XMVECTOR Position = XMVectorAdd(Position0, Position1);
-			Position = XMVectorScale(Position, 0.5f);
-			XMStoreFloat3(&TempVertices[0].Position, Position);
+		const UInt32 TableMask = TableSize - 1;
+		EdgeTable.Resize(TableSize);
+		for (UInt32& Slot : EdgeTable)
+		{
+			Slot = EmptySlot;
+		}
 
-			Position = XMVectorAdd(Position0, Position2);
-			Position = XMVectorScale(Position, 0.5f);
-			XMStoreFloat3(&TempVertices[1].Position, Position);
+		EdgeKeys.Clear();
+		if (EdgeKeys.Capacity() < IndexCount)
+		{
+			EdgeKeys.Reserve(IndexCount);
+		}
 
-			Position = XMVectorAdd(Position1, Position2);
-			Position = XMVectorScale(Position, 0.5f);
-			XMStoreFloat3(&TempVertices[2].Position, Position);
-			
-			// Calculate TexCoord
-			XMVECTOR TexCoord0 = XMLoadFloat2(&OutData.Vertices[OutData.Indices[j]].TexCoord);
-			XMVECTOR TexCoord1 = XMLoadFloat2(&OutData.Vertices[OutData.Indices[j + 1]].TexCoord);
-			XMVECTOR TexCoord2 = XMLoadFloat2(&OutData.Vertices[OutData.Indices[j + 2]].TexCoord);
+		// Find the unique edges, the midpoint of an edge becomes vertex OldVertexCount + EdgeIndex
+		auto FindOrAddEdge = [&](UInt32 Index0, UInt32 Index1) -> UInt32
+		{
+			const UInt64 Key = (Index0 < Index1) ? ((UInt64(Index0) << 32) | Index1) : ((UInt64(Index1) << 32) | Index0);
 
-			XMVECTOR TexCoord = XMVectorAdd(TexCoord0, TexCoord1);
-			TexCoord = XMVectorScale(TexCoord, 0.5f);
-			XMStoreFloat2(&TempVertices[0].TexCoord, TexCoord);
+			UInt32 Slot = static_cast<UInt32>((Key * 0x9E3779B97F4A7C15ull) >> 32) & TableMask;
+			while (EdgeTable[Slot] != EmptySlot)
+			{
+				if (EdgeKeys[EdgeTable[Slot]] == Key)
+				{
+					return OldVertexCount + EdgeTable[Slot];
+				}
 
-			TexCoord = XMVectorAdd(TexCoord0, TexCoord2);
-			TexCoord = XMVectorScale(TexCoord, 0.5f);
-			XMStoreFloat2(&TempVertices[1].TexCoord, TexCoord);
+				Slot = (Slot + 1) & TableMask;
+			}
 
-			TexCoord = XMVectorAdd(TexCoord1, TexCoord2);
-			TexCoord = XMVectorScale(TexCoord, 0.5f);
-			XMStoreFloat2(&TempVertices[2].TexCoord, TexCoord);
+			EdgeTable[Slot] = EdgeKeys.Size();
+			EdgeKeys.EmplaceBack(Key);
+			return OldVertexCount + EdgeTable[Slot];
+		};
+
+		TriangleEdges.Resize(IndexCount);
+		for (UInt32 j = 0; j < IndexCount; j += 3)
+		{
+			const UInt32 Index0 = OutData.Indices[j];
+			const UInt32 Index1 = OutData.Indices[j + 1];
+			const UInt32 Index2 = OutData.Indices[j + 2];
+			TriangleEdges[j]		= FindOrAddEdge(Index0, Index1);
+			TriangleEdges[j + 1]	= FindOrAddEdge(Index0, Index2);
+			TriangleEdges[j + 2]	= FindOrAddEdge(Index1, Index2);
+		}
 
-			// Calculate Normal
-			XMVECTOR Normal0 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j]].Normal);
-			XMVECTOR Normal1 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j + 1]].Normal);
-			XMVECTOR Normal2 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j + 2]].Normal);
+		// Now the exact sizes are known
+		const UInt32 EdgeCount = EdgeKeys.Size();
+		OutData.Vertices.Resize(OldVertexCount + EdgeCount);
 
-			XMVECTOR Normal = XMVectorAdd(Normal0, Normal1);
-			Normal = XMVectorScale(Normal, 0.5f);
-			Normal = XMVector3Normalize(Normal);
-			XMStoreFloat3(&TempVertices[0].Normal, Normal);
+		// Calculate the midpoints
+		Vertex* Vertices = OutData.Vertices.Data();
+		const UInt64* Keys = EdgeKeys.Data();
+		ParallelFor(EdgeCount, [Vertices, Keys, OldVertexCount](UInt32 Edge)
+		{
+			const Vertex& Vertex0 = Vertices[static_cast<UInt32>(Keys[Edge] >> 32)];
+			const Vertex& Vertex1 = Vertices[static_cast<UInt32>(Keys[Edge] & 0xffffffff)];
+			Vertex& Midpoint = Vertices[OldVertexCount + Edge];
 
-			Normal = XMVectorAdd(Normal0, Normal2);
-			Normal = XMVectorScale(Normal, 0.5f);
-			Normal = XMVector3Normalize(Normal);
-			XMStoreFloat3(&TempVertices[1].Normal, Normal);
+			XMVECTOR Position = XMVectorAdd(XMLoadFloat3(&Vertex0.Position), XMLoadFloat3(&Vertex1.Position));
+			Position = XMVectorScale(Position, 0.5f);
+			XMStoreFloat3(&Midpoint.Position, Position);
+
+			XMVECTOR TexCoord = XMVectorAdd(XMLoadFloat2(&Vertex0.TexCoord), XMLoadFloat2(&Vertex1.TexCoord));
+			TexCoord = XMVectorScale(TexCoord, 0.5f);
+			XMStoreFloat2(&Midpoint.TexCoord, TexCoord);
 
-			Normal = XMVectorAdd(Normal1, Normal2);
+			XMVECTOR Normal = XMVectorAdd(XMLoadFloat3(&Vertex0.Normal), XMLoadFloat3(&Vertex1.Normal));
 			Normal = XMVectorScale(Normal, 0.5f);
 			Normal = XMVector3Normalize(Normal);
-			XMStoreFloat3(&TempVertices[2].Normal, Normal);
-
-			// Calculate Tangent
-			XMVECTOR Tangent0 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j]].Tangent);
-			XMVECTOR Tangent1 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j + 1]].Tangent);
-			XMVECTOR Tangent2 = XMLoadFloat3(&OutData.Vertices[OutData.Indices[j + 2]].Tangent);
+			XMStoreFloat3(&Midpoint.Normal, Normal);
 
-			XMVECTOR Tangent = XMVectorAdd(Tangent0, Tangent1);
+			XMVECTOR Tangent = XMVectorAdd(XMLoadFloat4(&Vertex0.Tangent), XMLoadFloat4(&Vertex1.Tangent));
 			Tangent = XMVectorScale(Tangent, 0.5f);
 			Tangent = XMVector3Normalize(Tangent);
-			XMStoreFloat3(&TempVertices[0].Tangent, Tangent);
+			XMStoreFloat4(&Midpoint.Tangent, XMVectorSetW(Tangent, Vertex0.Tangent.w));
+		}, 1024);
 
-			Tangent = XMVectorAdd(Tangent0, Tangent2);
-			Tangent = XMVectorScale(Tangent, 0.5f);
-			Tangent = XMVector3Normalize(Tangent);
-			XMStoreFloat3(&TempVertices[1].Tangent, Tangent);
+		// Each triangle is split into four
+		NewIndices.Resize(IndexCount * 4);
+		for (UInt32 j = 0; j < IndexCount; j += 3)
+		{
+			const UInt32 Index0		= OutData.Indices[j];
+			const UInt32 Index1		= OutData.Indices[j + 1];
+			const UInt32 Index2		= OutData.Indices[j + 2];
+			const UInt32 Middle01	= TriangleEdges[j];
+			const UInt32 Middle02	= TriangleEdges[j + 1];
+			const UInt32 Middle12	= TriangleEdges[j + 2];
+
+			UInt32* Triangles = NewIndices.Data() + (j * 4);
+			Triangles[0]	= Middle01;
+			Triangles[1]	= Middle12;
+			Triangles[2]	= Middle02;
+
+			Triangles[3]	= Middle01;
+			Triangles[4]	= Index1;
+			Triangles[5]	= Middle12;
+
+			Triangles[6]	= Middle02;
+			Triangles[7]	= Middle12;
+			Triangles[8]	= Index2;
+
+			Triangles[9]	= Index0;
+			Triangles[10]	= Middle01;
+			Triangles[11]	= Middle02;
+		}
 
-			Tangent = XMVectorAdd(Tangent1, Tangent2);
-			Tangent = XMVectorScale(Tangent, 0.5f);
-			Tangent = XMVector3Normalize(Tangent);
-			XMStoreFloat3(&TempVertices[2].Tangent, Tangent);
+		OutData.Indices.Swap(NewIndices);
+	}
+
+	OutData.Vertices.ShrinkToFit();
+	OutData.Indices.ShrinkToFit();
+}
+
+void MeshFactory::Optimize(MeshData& OutData, UInt32 StartVertex, Float WeldEpsilon) noexcept
+{
+	const UInt32 VertexCount = static_cast<UInt32>(OutData.Vertices.Size());
+	if (StartVertex >= VertexCount)
+	{
+		return;
+	}
+
+	// Each vertex is converted into a key, with an epsilon the components are snapped to a grid with that spacing
+	constexpr UInt32 NumKeyComponents = sizeof(Vertex) / sizeof(Float);
+	static_assert(sizeof(Vertex) == NumKeyComponents * sizeof(Float), "Vertex is expected to only contain floats");
+
+	const Float InvEpsilon = (WeldEpsilon > 0.0f) ? (1.0f / WeldEpsilon) : 0.0f;
+	auto CreateKey = [InvEpsilon](const Vertex& InVertex, UInt32* OutKey)
+	{
+		const Float* Components = reinterpret_cast<const Float*>(&InVertex);
+		for (UInt32 Index = 0; Index < NumKeyComponents; Index++)
+		{
+			if (InvEpsilon > 0.0f)
+			{
+				OutKey[Index] = static_cast<UInt32>(static_cast<Int32>(floorf((Components[Index] * InvEpsilon) + 0.5f)));
+			}
+			else
+			{
+				// Adding zero turns -0.0f into 0.0f, so that they get the same key since they compare as equal
+				const Float Component = Components[Index] + 0.0f;
+				memcpy(&OutKey[Index], &Component, sizeof(Float));
+			}
+		}
+	};
+
+	auto HashKey = [](const UInt32* Key) -> UInt32
+	{
+		UInt32 Hash = 2166136261u;
+		for (UInt32 Index = 0; Index < NumKeyComponents; Index++)
+		{
+			Hash = (Hash ^ Key[Index]) * 16777619u;
+		}
+
+		return Hash ^ (Hash >> 16);
+	};
+
+	// Open addressing table that stores the index of the first vertex with a key, the size is a power of two
+	UInt32 TableSize = 1;
+	while (TableSize < VertexCount * 2)
+	{
+		TableSize <<= 1;
+	}
 
-			// Push the new Vertices
-			OutData.Vertices.EmplaceBack(TempVertices[0]);
-			OutData.Vertices.EmplaceBack(TempVertices[1]);
-			OutData.Vertices.EmplaceBack(TempVertices[2]);
+	const UInt32 TableMask = TableSize - 1;
+	constexpr UInt32 EmptySlot = ~0u;
 
-			// Push index of the new triangles
-			VertexCount = UInt32(OutData.Vertices.Size());
-			OutData.Indices.EmplaceBack(VertexCount - 3);
-			OutData.Indices.EmplaceBack(VertexCount - 1);
-			OutData.Indices.EmplaceBack(VertexCount - 2);
+	TArray<UInt32> Table(TableSize, EmptySlot);
+	TArray<UInt32> Keys(VertexCount * NumKeyComponents);
+	TArray<UInt32> Remap(VertexCount);
+
+	// Find the first vertex for each key and remap the rest to it, vertices before StartVertex are never removed
+	UInt32 NumUniqueVertices = StartVertex;
+	for (UInt32 Index = 0; Index < VertexCount; Index++)
+	{
+		UInt32* Key = Keys.Data() + (Index * NumKeyComponents);
+		CreateKey(OutData.Vertices[Index], Key);
+
+		UInt32 Slot = HashKey(Key) & TableMask;
+		while (Table[Slot] != EmptySlot)
+		{
+			const UInt32* OtherKey = Keys.Data() + (Table[Slot] * NumKeyComponents);
+			if (memcmp(Key, OtherKey, NumKeyComponents * sizeof(UInt32)) == 0)
+			{
+				break;
+			}
+
+			Slot = (Slot + 1) & TableMask;
+		}
 
-			OutData.Indices.EmplaceBack(VertexCount - 3);
-			OutData.Indices.EmplaceBack(OutData.Indices[j + 1]);
-			OutData.Indices.EmplaceBack(VertexCount - 1);
+		if (Index < StartVertex)
+		{
+			if (Table[Slot] == EmptySlot)
+			{
+				Table[Slot] = Index;
+			}
 
-			OutData.Indices.EmplaceBack(VertexCount - 2);
-			OutData.Indices.EmplaceBack(VertexCount - 1);
-			OutData.Indices.EmplaceBack(OutData.Indices[j + 2]);
+			Remap[Index] = Index;
+		}
+		else if (Table[Slot] == EmptySlot)
+		{
+			// The keys are stored separately so the vertex can be compacted right away, NewIndex is never after Index
+			const UInt32 NewIndex = NumUniqueVertices++;
+			if (NewIndex != Index)
+			{
+				OutData.Vertices[NewIndex] = OutData.Vertices[Index];
+			}
 
-			// Reassign the old indexes
-			OutData.Indices[j + 1] = VertexCount - 3;
-			OutData.Indices[j + 2] = VertexCount - 2;
+			Table[Slot]		= Index;
+			Remap[Index]	= NewIndex;
+		}
+		else
+		{
+			Remap[Index] = Remap[Table[Slot]];
 		}
+	}
 
-		Optimize(OutData, OldVertexCount);
+	if (NumUniqueVertices == VertexCount)
+	{
+		return;
 	}
 
-	OutData.Vertices.ShrinkToFit();
-	OutData.Indices.ShrinkToFit();
+	for (UInt32& Index : OutData.Indices)
+	{
+		Index = Remap[Index];
+	}
+
+	OutData.Vertices.Resize(NumUniqueVertices);
+}
+
+VertexCacheStatistics MeshFactory::AnalyzeVertexCache(const MeshData& Data, UInt32 CacheSize) noexcept
+{
+	VertexCacheStatistics Statistics;
+
+	const UInt32 IndexCount = Data.Indices.Size();
+	if (IndexCount < 3)
+	{
+		return Statistics;
+	}
+
+	// Simulates a FIFO cache, a vertex is in the cache if less than CacheSize misses happened since it was loaded
+	TArray<UInt32> CacheTimes(Data.Vertices.Size(), 0u);
+	UInt32 NumMisses = 0;
+	UInt32 NumUniqueVertices = 0;
+	for (UInt32 Index : Data.Indices)
+	{
+		if (CacheTimes[Index] == 0)
+		{
+			NumUniqueVertices++;
+		}
+
+		if (CacheTimes[Index] == 0 || (NumMisses + 1) - CacheTimes[Index] > CacheSize)
+		{
+			NumMisses++;
+			CacheTimes[Index] = NumMisses;
+		}
+	}
+
+	Statistics.ACMR = Float(NumMisses) / Float(IndexCount / 3);
+	Statistics.ATVR = Float(NumMisses) / Float(NumUniqueVertices);
+	return Statistics;
 }
 
-void MeshFactory::Optimize(MeshData& OutData, UInt32 StartVertex) noexcept
+void MeshFactory::OptimizeVertexCache(MeshData& OutData, UInt32 CacheSize) noexcept
 {
-	UInt32 VertexCount	= static_cast<UInt32>(OutData.Vertices.Size());
-	UInt32 IndexCount	= static_cast<UInt32>(OutData.Indices.Size());
-		
-	UInt32 k = 0;
-	UInt32 j = 0;
-	for (UInt32 i = StartVertex; i < VertexCount; i++)
+	const UInt32 VertexCount	= OutData.Vertices.Size();
+	const UInt32 IndexCount		= OutData.Indices.Size();
+	const UInt32 TriangleCount	= IndexCount / 3;
+	if (TriangleCount < 2)
+	{
+		return;
+	}
+
+	// Vertex to triangle adjacency
+	TArray<UInt32> LiveTriangles(VertexCount, 0u);
+	for (UInt32 Index : OutData.Indices)
+	{
+		LiveTriangles[Index]++;
+	}
+
+	TArray<UInt32> AdjacencyOffsets(VertexCount + 1);
+	AdjacencyOffsets[0] = 0;
+	for (UInt32 Index = 0; Index < VertexCount; Index++)
 	{
-		for (j = 0; j < VertexCount; j++)
+		AdjacencyOffsets[Index + 1] = AdjacencyOffsets[Index] + LiveTriangles[Index];
+	}
+
+	TArray<UInt32> Adjacency(IndexCount);
+	TArray<UInt32> WriteOffsets = AdjacencyOffsets;
+	for (UInt32 Index = 0; Index < IndexCount; Index++)
+	{
+		Adjacency[WriteOffsets[OutData.Indices[Index]]++] = Index / 3;
+	}
+
+	// Tipsify, fans around a vertex and then moves on to the candidate that is most likely to still be in the cache
+	TArray<UInt32>	CacheTimes(VertexCount, 0u);
+	TArray<UInt8>	Emitted(TriangleCount, UInt8(0));
+	TArray<UInt32>	DeadEnds;
+	TArray<UInt32>	Candidates;
+	TArray<UInt32>	NewIndices;
+	DeadEnds.Reserve(IndexCount);
+	NewIndices.Reserve(TriangleCount * 3);
+
+	UInt32 Time		= CacheSize + 1;
+	UInt32 Cursor	= 0;
+	Int32  Fanning	= 0;
+	while (Fanning >= 0)
+	{
+		Candidates.Clear();
+
+		const UInt32 Current = static_cast<UInt32>(Fanning);
+		for (UInt32 Offset = AdjacencyOffsets[Current]; Offset < AdjacencyOffsets[Current + 1]; Offset++)
+		{
+			const UInt32 Triangle = Adjacency[Offset];
+			if (Emitted[Triangle])
+			{
+				continue;
+			}
+
+			for (UInt32 Corner = 0; Corner < 3; Corner++)
+			{
+				const UInt32 Index = OutData.Indices[(Triangle * 3) + Corner];
+				NewIndices.EmplaceBack(Index);
+				DeadEnds.EmplaceBack(Index);
+				Candidates.EmplaceBack(Index);
+				LiveTriangles[Index]--;
+
+				if (Time - CacheTimes[Index] > CacheSize)
+				{
+					CacheTimes[Index] = Time;
+					Time++;
+				}
+			}
+
+			Emitted[Triangle] = 1;
+		}
+
+		// Select the candidate that will still be in the cache after its remaining triangles are emitted
+		Int32 BestPriority = -1;
+		Fanning = -1;
+		for (UInt32 Candidate : Candidates)
 		{
-			if (OutData.Vertices[i] == OutData.Vertices[j])
+			if (LiveTriangles[Candidate] > 0)
 			{
-				if (i != j)
+				Int32 Priority = 0;
+				if (Time - CacheTimes[Candidate] + (2 * LiveTriangles[Candidate]) <= CacheSize)
 				{
-					OutData.Vertices.Erase(OutData.Vertices.Begin() + i);
-					VertexCount--;
-					j--;
+					Priority = static_cast<Int32>(Time - CacheTimes[Candidate]);
+				}
 
-					for (k = 0; k < IndexCount; k++)
-					{
-						if (OutData.Indices[k] == i)
-						{
-							OutData.Indices[k] = j;
-						}
-						else if (OutData.Indices[k] > i)
-						{
-							OutData.Indices[k]--;
-						}
-					}
+				if (Priority > BestPriority)
+				{
+					BestPriority	= Priority;
+					Fanning			= static_cast<Int32>(Candidate);
+				}
+			}
+		}
 
-					i--;
-					break;
+		// Dead end, use a recently used vertex or continue with the next vertex in the input order
+		if (Fanning < 0)
+		{
+			while (!DeadEnds.IsEmpty() && Fanning < 0)
+			{
+				const UInt32 DeadEnd = DeadEnds.Back();
+				DeadEnds.PopBack();
+
+				if (LiveTriangles[DeadEnd] > 0)
+				{
+					Fanning = static_cast<Int32>(DeadEnd);
+				}
+			}
+
+			while (Cursor < VertexCount && Fanning < 0)
+			{
+				if (LiveTriangles[Cursor] > 0)
+				{
+					Fanning = static_cast<Int32>(Cursor);
 				}
+
+				Cursor++;
 			}
 		}
 	}
+
+	VALIDATE(NewIndices.Size() == TriangleCount * 3);
+	for (UInt32 Index = 0; Index < TriangleCount * 3; Index++)
+	{
+		OutData.Indices[Index] = NewIndices[Index];
+	}
 }
 
-void MeshFactory::CalculateHardNormals(MeshData& Data) noexcept
+void MeshFactory::OptimizeOverdraw(MeshData& OutData, Float Threshold, UInt32 CacheSize) noexcept
 {
-	UNREFERENCED_VARIABLE(Data);
+	const UInt32 VertexCount	= OutData.Vertices.Size();
+	const UInt32 TriangleCount	= OutData.Indices.Size() / 3;
+	if (TriangleCount < 2)
+	{
+		return;
+	}
 
-	/*
-	vec3 e1;
-	vec3 e2;
-	vec3 n;
+	// Split into clusters that are within the threshold of the ACMR of the whole mesh even when starting with a cold cache,
+	// this way the clusters can be drawn in any order
+	const Float MaxACMR = AnalyzeVertexCache(OutData, CacheSize).ACMR * Threshold;
 
-	for (size_t i = 0; i < data.Indices.GetSize(); i += 3)
+	TArray<UInt32> ClusterOffsets;
+	TArray<UInt32> CacheTimes(VertexCount, 0u);
+	UInt32 NumMisses		= 0;
+	UInt32 ClusterStart		= 0;
+	UInt32 ClusterMisses	= 0;
+	for (UInt32 Triangle = 0; Triangle < TriangleCount; Triangle++)
 	{
-		e1 = data.Vertices[data.Indices[i + 2]].Position - data.Vertices[data.Indices[i]].Position;
-		e2 = data.Vertices[data.Indices[i + 1]].Position - data.Vertices[data.Indices[i]].Position;
-		n = cross(e1, e2);
+		if (Triangle == ClusterStart)
+		{
+			ClusterOffsets.EmplaceBack(Triangle);
+			ClusterMisses = 0;
+			
+			// Make sure that all vertices are outside the cache
+			NumMisses += CacheSize;
+		}
 
-		data.Vertices[data.Indices[i]].Normal = n;
-		data.Vertices[data.Indices[i + 1]].Normal = n;
-		data.Vertices[data.Indices[i + 2]].Normal = n;
+		for (UInt32 Corner = 0; Corner < 3; Corner++)
+		{
+			const UInt32 Index = OutData.Indices[(Triangle * 3) + Corner];
+			if (CacheTimes[Index] == 0 || (NumMisses + 1) - CacheTimes[Index] > CacheSize)
+			{
+				NumMisses++;
+				ClusterMisses++;
+				CacheTimes[Index] = NumMisses;
+			}
+		}
+
+		const UInt32 ClusterTriangles = (Triangle + 1) - ClusterStart;
+		if (Float(ClusterMisses) <= MaxACMR * Float(ClusterTriangles))
+		{
+			ClusterStart = Triangle + 1;
+		}
 	}
-	*/
-}
 
-void MeshFactory::CalculateTangents(MeshData& OutData) noexcept
-{
-	auto CalculateTangentFromVectors = [](Vertex& Vertex1, const Vertex& Vertex2, const Vertex& Vertex3)
+	const UInt32 ClusterCount = ClusterOffsets.Size();
+	ClusterOffsets.EmplaceBack(TriangleCount);
+	if (ClusterCount < 2)
+	{
+		return;
+	}
+
+	// Clusters that face away from the center of the mesh are likely to occlude the others, so they are drawn first
+	XMVECTOR MeshCenter = XMVectorZero();
+	for (const Vertex& CurrentVertex : OutData.Vertices)
+	{
+		MeshCenter = XMVectorAdd(MeshCenter, XMLoadFloat3(&CurrentVertex.Position));
+	}
+
+	MeshCenter = XMVectorScale(MeshCenter, 1.0f / Float(VertexCount));
+
+	TArray<Float> SortKeys(ClusterCount);
+	for (UInt32 Cluster = 0; Cluster < ClusterCount; Cluster++)
 	{
-		XMFLOAT3 Edge1;
-		Edge1.x = Vertex2.Position.x - Vertex1.Position.x;
-		Edge1.y = Vertex2.Position.y - Vertex1.Position.y;
-		Edge1.z = Vertex2.Position.z - Vertex1.Position.z;
+		XMVECTOR Center	= XMVectorZero();
+		XMVECTOR Normal	= XMVectorZero();
+		Float Area		= 0.0f;
+		for (UInt32 Triangle = ClusterOffsets[Cluster]; Triangle < ClusterOffsets[Cluster + 1]; Triangle++)
+		{
+			const UInt32* Indices = OutData.Indices.Data() + (Triangle * 3);
+			XMVECTOR Position0 = XMLoadFloat3(&OutData.Vertices[Indices[0]].Position);
+			XMVECTOR Position1 = XMLoadFloat3(&OutData.Vertices[Indices[1]].Position);
+			XMVECTOR Position2 = XMLoadFloat3(&OutData.Vertices[Indices[2]].Position);
+
+			// The length of the cross product is twice the area, so the sum of the crosses is area weighted
+			XMVECTOR Cross = XMVector3Cross(XMVectorSubtract(Position1, Position0), XMVectorSubtract(Position2, Position0));
+			const Float TriangleArea = XMVectorGetX(XMVector3Length(Cross));
+
+			XMVECTOR TriangleCenter = XMVectorScale(XMVectorAdd(XMVectorAdd(Position0, Position1), Position2), 1.0f / 3.0f);
+			Center	= XMVectorAdd(Center, XMVectorScale(TriangleCenter, TriangleArea));
+			Normal	= XMVectorAdd(Normal, Cross);
+			Area	+= TriangleArea;
+		}
 
-		XMFLOAT3 Edge2;
-		Edge2.x = Vertex3.Position.x - Vertex1.Position.x;
-		Edge2.y = Vertex3.Position.y - Vertex1.Position.y;
-		Edge2.z = Vertex3.Position.z - Vertex1.Position.z;
+		if (Area > 0.0f)
+		{
+			Center = XMVectorScale(Center, 1.0f / Area);
+		}
+
+		Normal = XMVector3Normalize(Normal);
+		SortKeys[Cluster] = XMVectorGetX(XMVector3Dot(XMVectorSubtract(Center, MeshCenter), Normal));
+	}
 
-		XMFLOAT2 UVEdge1;
-		UVEdge1.x = Vertex2.TexCoord.x - Vertex1.TexCoord.x;
-		UVEdge1.y = Vertex2.TexCoord.y - Vertex1.TexCoord.y;
+	TArray<UInt32> SortedClusters(ClusterCount);
+	for (UInt32 Cluster = 0; Cluster < ClusterCount; Cluster++)
+	{
+		SortedClusters[Cluster] = Cluster;
+	}
 
-		XMFLOAT3 UVEdge2;
-		UVEdge2.x = Vertex3.TexCoord.x - Vertex1.TexCoord.x;
-		UVEdge2.y = Vertex3.TexCoord.y - Vertex1.TexCoord.y;
+	std::stable_sort(SortedClusters.Data(), SortedClusters.Data() + ClusterCount, [&SortKeys](UInt32 First, UInt32 Second)
+	{
+		return SortKeys[First] > SortKeys[Second];
+	});
 
-		Float Denominator = 1.0f / (UVEdge1.x * UVEdge2.y - UVEdge2.x * UVEdge1.y);
+	TArray<UInt32> NewIndices;
+	NewIndices.Reserve(TriangleCount * 3);
+	for (UInt32 Cluster : SortedClusters)
+	{
+		for (UInt32 Index = ClusterOffsets[Cluster] * 3; Index < ClusterOffsets[Cluster + 1] * 3; Index++)
+		{
+			NewIndices.EmplaceBack(OutData.Indices[Index]);
+		}
+	}
 
-		XMFLOAT3 Tangent;
-		Tangent.x = Denominator * (UVEdge2.y * Edge1.x - UVEdge1.y * Edge2.x);
-		Tangent.y = Denominator * (UVEdge2.y * Edge1.y - UVEdge1.y * Edge2.y);
-		Tangent.z = Denominator * (UVEdge2.y * Edge1.z - UVEdge1.y * Edge2.z);
+	for (UInt32 Index = 0; Index < TriangleCount * 3; Index++)
+	{
+		OutData.Indices[Index] = NewIndices[Index];
+	}
+}
 
-		Float Length = std::sqrt((Tangent.x * Tangent.x) + (Tangent.y * Tangent.y) + (Tangent.z * Tangent.z));
-		if (Length != 0.0f) 
-		{		
-			Tangent.x /= Length;
-			Tangent.y /= Length;
-			Tangent.z /= Length;
+void MeshFactory::OptimizeVertexFetch(MeshData& OutData) noexcept
+{
+	const UInt32 VertexCount = OutData.Vertices.Size();
+
+	// Vertices are stored in the order they are first used, unused vertices are removed
+	constexpr UInt32 Unused = ~0u;
+	TArray<UInt32> Remap(VertexCount, Unused);
+	TArray<Vertex> NewVertices;
+	NewVertices.Reserve(VertexCount);
+	for (UInt32& Index : OutData.Indices)
+	{
+		if (Remap[Index] == Unused)
+		{
+			Remap[Index] = NewVertices.Size();
+			NewVertices.EmplaceBack(OutData.Vertices[Index]);
 		}
 
-		Vertex1.Tangent = Tangent;
-	};
+		Index = Remap[Index];
+	}
+
+	OutData.Vertices.Swap(NewVertices);
+}
+
+void MeshFactory::OptimizeForRendering(MeshData& OutData, VertexCacheStatistics* OutBefore, VertexCacheStatistics* OutAfter) noexcept
+{
+	constexpr UInt32 CacheSize			= 16;
+	constexpr Float OverdrawThreshold	= 1.05f;
+
+	if (OutBefore)
+	{
+		*OutBefore = AnalyzeVertexCache(OutData, CacheSize);
+	}
 
-	for (UInt32 i = 0; i < OutData.Indices.Size(); i += 3)
+	OptimizeVertexCache(OutData, CacheSize);
+	OptimizeOverdraw(OutData, OverdrawThreshold, CacheSize);
+	OptimizeVertexFetch(OutData);
+
+	if (OutAfter)
 	{
-		Vertex& Vertex1 = OutData.Vertices[OutData.Indices[i + 0]];
-		Vertex& Vertex2 = OutData.Vertices[OutData.Indices[i + 1]];
-		Vertex& Vertex3 = OutData.Vertices[OutData.Indices[i + 2]];
+		*OutAfter = AnalyzeVertexCache(OutData, CacheSize);
+	}
+}
+
+void MeshFactory::CreateMeshlets(const MeshData& Data, MeshletData& OutMeshlets, UInt32 MaxVertices, UInt32 MaxTriangles) noexcept
+{
+	VALIDATE(MaxVertices >= 3 && MaxVertices <= 256);
+	VALIDATE(MaxTriangles >= 1);
+
+	OutMeshlets.Meshlets.Clear();
+	OutMeshlets.Vertices.Clear();
+	OutMeshlets.Triangles.Clear();
 
-		CalculateTangentFromVectors(Vertex1, Vertex2, Vertex3);
-		CalculateTangentFromVectors(Vertex2, Vertex3, Vertex1);
-		CalculateTangentFromVectors(Vertex3, Vertex1, Vertex2);
+	const UInt32 TriangleCount = Data.Indices.Size() / 3;
+	if (TriangleCount == 0)
+	{
+		return;
 	}
+
+	OutMeshlets.Vertices.Reserve(Data.Indices.Size());
+	OutMeshlets.Triangles.Reserve(TriangleCount * 3);
+
+	// Index of each vertex inside the current meshlet
+	constexpr UInt8 NotInMeshlet = 0xff;
+	TArray<UInt8> LocalIndices(Data.Vertices.Size(), NotInMeshlet);
+
+	Meshlet* Current = &OutMeshlets.Meshlets.EmplaceBack();
+	for (UInt32 Triangle = 0; Triangle < TriangleCount; Triangle++)
+	{
+		const UInt32* Indices = Data.Indices.Data() + (Triangle * 3);
+
+		UInt32 NumNewVertices = 0;
+		for (UInt32 Corner = 0; Corner < 3; Corner++)
+		{
+			if (LocalIndices[Indices[Corner]] == NotInMeshlet)
+			{
+				NumNewVertices++;
+			}
+		}
+
+		// Start a new meshlet when the triangle does not fit
+		if (Current->VertexCount + NumNewVertices > MaxVertices || Current->TriangleCount >= MaxTriangles)
+		{
+			for (UInt32 Index = Current->VertexOffset; Index < Current->VertexOffset + Current->VertexCount; Index++)
+			{
+				LocalIndices[OutMeshlets.Vertices[Index]] = NotInMeshlet;
+			}
+
+			const UInt32 VertexOffset	= OutMeshlets.Vertices.Size();
+			const UInt32 TriangleOffset	= OutMeshlets.Triangles.Size() / 3;
+			Current = &OutMeshlets.Meshlets.EmplaceBack();
+			Current->VertexOffset	= VertexOffset;
+			Current->TriangleOffset	= TriangleOffset;
+			Current->IndexOffset	= Triangle * 3;
+		}
+
+		for (UInt32 Corner = 0; Corner < 3; Corner++)
+		{
+			const UInt32 Index = Indices[Corner];
+			if (LocalIndices[Index] == NotInMeshlet)
+			{
+				LocalIndices[Index] = static_cast<UInt8>(Current->VertexCount++);
+				OutMeshlets.Vertices.EmplaceBack(Index);
+			}
+
+			OutMeshlets.Triangles.EmplaceBack(LocalIndices[Index]);
+		}
+
+		Current->TriangleCount++;
+	}
+
+	// Calculate bounds and normal cones
+	Meshlet* Meshlets = OutMeshlets.Meshlets.Data();
+	ParallelFor(OutMeshlets.Meshlets.Size(), [&Data, &OutMeshlets, Meshlets](UInt32 MeshletIndex)
+	{
+		Meshlet& CurrentMeshlet = Meshlets[MeshletIndex];
+
+		constexpr Float Inf = std::numeric_limits<Float>::infinity();
+		XMVECTOR Min = XMVectorReplicate(Inf);
+		XMVECTOR Max = XMVectorReplicate(-Inf);
+		for (UInt32 LocalIndex = 0; LocalIndex < CurrentMeshlet.VertexCount; LocalIndex++)
+		{
+			XMVECTOR Position = XMLoadFloat3(&Data.Vertices[OutMeshlets.Vertices[CurrentMeshlet.VertexOffset + LocalIndex]].Position);
+			Min = XMVectorMin(Min, Position);
+			Max = XMVectorMax(Max, Position);
+		}
+
+		XMStoreFloat3(&CurrentMeshlet.Bounds.Bottom, Min);
+		XMStoreFloat3(&CurrentMeshlet.Bounds.Top, Max);
+
+		XMVECTOR Center = XMVectorScale(XMVectorAdd(Min, Max), 0.5f);
+		XMStoreFloat3(&CurrentMeshlet.SphereCenter, Center);
+
+		Float RadiusSqr = 0.0f;
+		for (UInt32 LocalIndex = 0; LocalIndex < CurrentMeshlet.VertexCount; LocalIndex++)
+		{
+			XMVECTOR Position = XMLoadFloat3(&Data.Vertices[OutMeshlets.Vertices[CurrentMeshlet.VertexOffset + LocalIndex]].Position);
+			RadiusSqr = std::max<Float>(RadiusSqr, XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(Position, Center))));
+		}
+
+		CurrentMeshlet.SphereRadius = sqrtf(RadiusSqr);
+
+		// The axis is the average normal and the cone has to contain the normal that deviates the most
+		const UInt32 FirstIndex = CurrentMeshlet.IndexOffset;
+		const UInt32 LastIndex	= FirstIndex + (CurrentMeshlet.TriangleCount * 3);
+
+		XMVECTOR Axis = XMVectorZero();
+		for (UInt32 Index = FirstIndex; Index < LastIndex; Index += 3)
+		{
+			XMVECTOR Position0	= XMLoadFloat3(&Data.Vertices[Data.Indices[Index]].Position);
+			XMVECTOR Position1	= XMLoadFloat3(&Data.Vertices[Data.Indices[Index + 1]].Position);
+			XMVECTOR Position2	= XMLoadFloat3(&Data.Vertices[Data.Indices[Index + 2]].Position);
+			XMVECTOR Normal		= XMVector3Cross(XMVectorSubtract(Position1, Position0), XMVectorSubtract(Position2, Position0));
+
+			// Degenerate triangles are never rasterized
+			if (XMVectorGetX(XMVector3LengthSq(Normal)) > 0.0f)
+			{
+				Axis = XMVectorAdd(Axis, XMVector3Normalize(Normal));
+			}
+		}
+
+		CurrentMeshlet.ConeAxis		= XMFLOAT3(0.0f, 0.0f, 0.0f);
+		CurrentMeshlet.ConeCutoff	= 1.0f;
+		if (XMVectorGetX(XMVector3LengthSq(Axis)) <= 0.0f)
+		{
+			return;
+		}
+
+		Axis = XMVector3Normalize(Axis);
+
+		Float MinDot = 1.0f;
+		for (UInt32 Index = FirstIndex; Index < LastIndex; Index += 3)
+		{
+			XMVECTOR Position0	= XMLoadFloat3(&Data.Vertices[Data.Indices[Index]].Position);
+			XMVECTOR Position1	= XMLoadFloat3(&Data.Vertices[Data.Indices[Index + 1]].Position);
+			XMVECTOR Position2	= XMLoadFloat3(&Data.Vertices[Data.Indices[Index + 2]].Position);
+			XMVECTOR Normal		= XMVector3Cross(XMVectorSubtract(Position1, Position0), XMVectorSubtract(Position2, Position0));
+			if (XMVectorGetX(XMVector3LengthSq(Normal)) > 0.0f)
+			{
+				MinDot = std::min<Float>(MinDot, XMVectorGetX(XMVector3Dot(XMVector3Normalize(Normal), Axis)));
+			}
+		}
+
+		// Cones that are 90 degrees or wider always contain a front facing triangle
+		XMStoreFloat3(&CurrentMeshlet.ConeAxis, Axis);
+		if (MinDot > 0.0f)
+		{
+			CurrentMeshlet.ConeCutoff = sqrtf(1.0f - (MinDot * MinDot));
+		}
+	}, 64);
+}
+
+/*
+* Quadric - Sum of squared distances to a set of planes, weighted by the area of the triangles the planes come from
+*/
+
+struct Quadric
+{
+	void AddPlane(Float Nx, Float Ny, Float Nz, Float D, Float Weight)
+	{
+		A00 += Weight * Nx * Nx;
+		A11 += Weight * Ny * Ny;
+		A22 += Weight * Nz * Nz;
+		A01 += Weight * Nx * Ny;
+		A02 += Weight * Nx * Nz;
+		A12 += Weight * Ny * Nz;
+		B0	+= Weight * Nx * D;
+		B1	+= Weight * Ny * D;
+		B2	+= Weight * Nz * D;
+		C	+= Weight * D * D;
+		W	+= Weight;
+	}
+
+	void Add(const Quadric& Other)
+	{
+		A00 += Other.A00;
+		A11 += Other.A11;
+		A22 += Other.A22;
+		A01 += Other.A01;
+		A02 += Other.A02;
+		A12 += Other.A12;
+		B0	+= Other.B0;
+		B1	+= Other.B1;
+		B2	+= Other.B2;
+		C	+= Other.C;
+		W	+= Other.W;
+	}
+
+	// Average squared distance from the point to the planes
+	Float Evaluate(Float X, Float Y, Float Z) const
+	{
+		const Float Error =
+			(A00 * X * X) + (A11 * Y * Y) + (A22 * Z * Z) +
+			(2.0f * ((A01 * X * Y) + (A02 * X * Z) + (A12 * Y * Z))) +
+			(2.0f * ((B0 * X) + (B1 * Y) + (B2 * Z))) + C;
+
+		return (W > 0.0f) ? std::max<Float>(Error / W, 0.0f) : 0.0f;
+	}
+
+	Float A00 = 0.0f;
+	Float A11 = 0.0f;
+	Float A22 = 0.0f;
+	Float A01 = 0.0f;
+	Float A02 = 0.0f;
+	Float A12 = 0.0f;
+	Float B0 = 0.0f;
+	Float B1 = 0.0f;
+	Float B2 = 0.0f;
+	Float C = 0.0f;
+	Float W = 0.0f;
+};
+
+/*
+* Collapse
+*/
+
+struct Collapse
+{
+	UInt32 From;
+	UInt32 To;
+	Float Error;
+};
+
+Float MeshFactory::Simplify(MeshData& OutData, UInt32 TargetIndexCount, Float TargetError) noexcept
+{
+	const UInt32 VertexCount = OutData.Vertices.Size();
+	if (OutData.Indices.Size() <= TargetIndexCount || VertexCount == 0)
+	{
+		return 0.0f;
+	}
+
+	// Positions are scaled into the unit cube, so that the errors are relative to the size of the mesh
+	constexpr Float Inf = std::numeric_limits<Float>::infinity();
+	XMFLOAT3 Min = XMFLOAT3(Inf, Inf, Inf);
+	XMFLOAT3 Max = XMFLOAT3(-Inf, -Inf, -Inf);
+	for (const Vertex& CurrentVertex : OutData.Vertices)
+	{
+		Min.x = std::min<Float>(Min.x, CurrentVertex.Position.x);
+		Min.y = std::min<Float>(Min.y, CurrentVertex.Position.y);
+		Min.z = std::min<Float>(Min.z, CurrentVertex.Position.z);
+		Max.x = std::max<Float>(Max.x, CurrentVertex.Position.x);
+		Max.y = std::max<Float>(Max.y, CurrentVertex.Position.y);
+		Max.z = std::max<Float>(Max.z, CurrentVertex.Position.z);
+	}
+
+	const Float Extent		= std::max<Float>(Max.x - Min.x, std::max<Float>(Max.y - Min.y, Max.z - Min.z));
+	const Float InvExtent	= (Extent > 0.0f) ? (1.0f / Extent) : 0.0f;
+
+	TArray<XMFLOAT3> Positions(VertexCount);
+	for (UInt32 Index = 0; Index < VertexCount; Index++)
+	{
+		const XMFLOAT3& Position = OutData.Vertices[Index].Position;
+		Positions[Index] = XMFLOAT3((Position.x - Min.x) * InvExtent, (Position.y - Min.y) * InvExtent, (Position.z - Min.z) * InvExtent);
+	}
+
+	constexpr UInt32 EmptySlot = ~0u;
+
+	// Vertices with the same position form a group, vertices in a group only differ in their attributes
+	TArray<UInt32> Groups(VertexCount);
+	TArray<UInt32> NumWedges(VertexCount, 0u);
+	{
+		UInt32 TableSize = 1;
+		while (TableSize < VertexCount * 2)
+		{
+			TableSize <<= 1;
+		}
+
+		TArray<UInt32> Table(TableSize, EmptySlot);
+		for (UInt32 Index = 0; Index < VertexCount; Index++)
+		{
+			// Adding zero turns -0.0f into 0.0f
+			const XMFLOAT3& Position = OutData.Vertices[Index].Position;
+			const Float Key[3] = { Position.x + 0.0f, Position.y + 0.0f, Position.z + 0.0f };
+
+			UInt32 Hash = 2166136261u;
+			for (Float Component : Key)
+			{
+				UInt32 Bits;
+				memcpy(&Bits, &Component, sizeof(UInt32));
+				Hash = (Hash ^ Bits) * 16777619u;
+			}
+
+			UInt32 Slot = (Hash ^ (Hash >> 16)) & (TableSize - 1);
+			while (Table[Slot] != EmptySlot)
+			{
+				const XMFLOAT3& Other = OutData.Vertices[Table[Slot]].Position;
+				if (Other.x == Position.x && Other.y == Position.y && Other.z == Position.z)
+				{
+					break;
+				}
+
+				Slot = (Slot + 1) & (TableSize - 1);
+			}
+
+			if (Table[Slot] == EmptySlot)
+			{
+				Table[Slot] = Index;
+			}
+
+			Groups[Index] = Table[Slot];
+			NumWedges[Table[Slot]]++;
+		}
+	}
+
+	/*
+	* Only groups with one vertex inside a closed manifold part of the mesh are removed. Borders, seams and non-manifold
+	* edges are locked, so they are kept exactly.
+	*/
+	TArray<UInt8> IsLocked(VertexCount, UInt8(0));
+	for (UInt32 Index = 0; Index < VertexCount; Index++)
+	{
+		IsLocked[Index] = (NumWedges[Groups[Index]] > 1) ? 1 : 0;
+	}
+
+	{
+		const UInt32 NumEdges = OutData.Indices.Size();
+
+		UInt32 TableSize = 1;
+		while (TableSize < NumEdges * 2)
+		{
+			TableSize <<= 1;
+		}
+
+		// Directed edges between groups and the number of times they are used
+		TArray<UInt64> EdgeKeys(TableSize, ~0ull);
+		TArray<UInt32> EdgeCounts(TableSize, 0u);
+		auto FindEdge = [&](UInt32 Group0, UInt32 Group1) -> UInt32
+		{
+			const UInt64 Key = (UInt64(Group0) << 32) | Group1;
+
+			UInt32 Slot = static_cast<UInt32>((Key * 0x9E3779B97F4A7C15ull) >> 32) & (TableSize - 1);
+			while (EdgeKeys[Slot] != ~0ull && EdgeKeys[Slot] != Key)
+			{
+				Slot = (Slot + 1) & (TableSize - 1);
+			}
+
+			return Slot;
+		};
+
+		for (UInt32 Index = 0; Index < NumEdges; Index++)
+		{
+			const UInt32 Next = (Index % 3 == 2) ? (Index - 2) : (Index + 1);
+			const UInt32 Slot = FindEdge(Groups[OutData.Indices[Index]], Groups[OutData.Indices[Next]]);
+			EdgeKeys[Slot] = (UInt64(Groups[OutData.Indices[Index]]) << 32) | Groups[OutData.Indices[Next]];
+			EdgeCounts[Slot]++;
+		}
+
+		for (UInt32 Index = 0; Index < NumEdges; Index++)
+		{
+			const UInt32 Next	= (Index % 3 == 2) ? (Index - 2) : (Index + 1);
+			const UInt32 Group0	= Groups[OutData.Indices[Index]];
+			const UInt32 Group1	= Groups[OutData.Indices[Next]];
+
+			const UInt32 Slot			= FindEdge(Group0, Group1);
+			const UInt32 OppositeSlot	= FindEdge(Group1, Group0);
+			if (EdgeCounts[Slot] != 1 || EdgeKeys[OppositeSlot] == ~0ull || EdgeCounts[OppositeSlot] != 1)
+			{
+				IsLocked[OutData.Indices[Index]]	= 1;
+				IsLocked[OutData.Indices[Next]]		= 1;
+			}
+		}
+
+		// The lock is stored on each vertex, make sure all vertices in a group agree
+		for (UInt32 Index = 0; Index < VertexCount; Index++)
+		{
+			IsLocked[Groups[Index]] |= IsLocked[Index];
+		}
+
+		for (UInt32 Index = 0; Index < VertexCount; Index++)
+		{
+			IsLocked[Index] = IsLocked[Groups[Index]];
+		}
+	}
+
+	// The quadric of each group contains the planes of all triangles around it
+	TArray<Quadric> Quadrics(VertexCount);
+	for (UInt32 Index = 0; Index < OutData.Indices.Size(); Index += 3)
+	{
+		XMVECTOR Position0	= XMLoadFloat3(&Positions[OutData.Indices[Index]]);
+		XMVECTOR Position1	= XMLoadFloat3(&Positions[OutData.Indices[Index + 1]]);
+		XMVECTOR Position2	= XMLoadFloat3(&Positions[OutData.Indices[Index + 2]]);
+		XMVECTOR Normal		= XMVector3Cross(XMVectorSubtract(Position1, Position0), XMVectorSubtract(Position2, Position0));
+
+		const Float Area = XMVectorGetX(XMVector3Length(Normal)) * 0.5f;
+		if (Area <= 0.0f)
+		{
+			continue;
+		}
+
+		XMFLOAT3 PlaneNormal;
+		XMStoreFloat3(&PlaneNormal, XMVector3Normalize(Normal));
+		const Float Distance = -XMVectorGetX(XMVector3Dot(XMLoadFloat3(&PlaneNormal), Position0));
+
+		for (UInt32 Corner = 0; Corner < 3; Corner++)
+		{
+			Quadrics[Groups[OutData.Indices[Index + Corner]]].AddPlane(PlaneNormal.x, PlaneNormal.y, PlaneNormal.z, Distance, Area);
+		}
+	}
+
+	TArray<UInt32>		Remap(VertexCount);
+	TArray<UInt32>		AdjacencyOffsets(VertexCount + 1);
+	TArray<UInt32>		Adjacency;
+	TArray<Collapse>	Collapses;
+	TArray<Collapse>	BestCollapses(VertexCount);
+	TArray<UInt8>		IsCollapseLocked(VertexCount);
+	TArray<UInt32>		RingMarks(VertexCount, 0u);
+	UInt32 RingMark = 0;
+
+	const Float MaxErrorSqr = TargetError * TargetError;
+	Float ResultErrorSqr = 0.0f;
+
+	bool UseAllEdges = false;
+
+	UInt32 TriangleCount = OutData.Indices.Size() / 3;
+	while (TriangleCount * 3 > TargetIndexCount)
+	{
+		// Triangles around each group
+		for (UInt32& Offset : AdjacencyOffsets)
+		{
+			Offset = 0;
+		}
+
+		for (UInt32 Index : OutData.Indices)
+		{
+			AdjacencyOffsets[Groups[Index] + 1]++;
+		}
+
+		for (UInt32 Index = 0; Index < VertexCount; Index++)
+		{
+			AdjacencyOffsets[Index + 1] += AdjacencyOffsets[Index];
+		}
+
+		Adjacency.Resize(OutData.Indices.Size());
+		TArray<UInt32> WriteOffsets = AdjacencyOffsets;
+		for (UInt32 Index = 0; Index < OutData.Indices.Size(); Index++)
+		{
+			Adjacency[WriteOffsets[Groups[OutData.Indices[Index]]]++] = Index / 3;
+		}
+
+		/*
+		* An unlocked vertex can be moved to the other end of any of its edges. Only the cheapest edge of each vertex is
+		* considered, unless none of those could be collapsed in the last pass.
+		*/
+		Collapses.Clear();
+		for (Collapse& BestCollapse : BestCollapses)
+		{
+			BestCollapse.Error = Inf;
+		}
+
+		for (UInt32 Index = 0; Index < OutData.Indices.Size(); Index++)
+		{
+			const UInt32 From = OutData.Indices[Index];
+			if (IsLocked[From])
+			{
+				continue;
+			}
+
+			const UInt32 Base = Index - (Index % 3);
+			for (UInt32 Corner = 0; Corner < 3; Corner++)
+			{
+				const UInt32 To = OutData.Indices[Base + Corner];
+				if (Groups[To] != Groups[From])
+				{
+					const XMFLOAT3& Position = Positions[To];
+					const Float Error = Quadrics[Groups[From]].Evaluate(Position.x, Position.y, Position.z);
+					if (UseAllEdges)
+					{
+						if (Error <= MaxErrorSqr)
+						{
+							Collapse& NewCollapse = Collapses.EmplaceBack();
+							NewCollapse.From	= From;
+							NewCollapse.To		= To;
+							NewCollapse.Error	= Error;
+						}
+					}
+					else if (Error < BestCollapses[From].Error)
+					{
+						BestCollapses[From].From	= From;
+						BestCollapses[From].To		= To;
+						BestCollapses[From].Error	= Error;
+					}
+				}
+			}
+		}
+
+		for (const Collapse& BestCollapse : BestCollapses)
+		{
+			if (BestCollapse.Error <= MaxErrorSqr)
+			{
+				Collapses.EmplaceBack(BestCollapse);
+			}
+		}
+
+		std::sort(Collapses.Data(), Collapses.Data() + Collapses.Size(), [](const Collapse& First, const Collapse& Second)
+		{
+			return First.Error < Second.Error;
+		});
+
+		for (UInt32 Index = 0; Index < VertexCount; Index++)
+		{
+			Remap[Index] = Index;
+			IsCollapseLocked[Index] = 0;
+		}
+
+		// Collapses in the same pass never touch the same triangles, so the adjacency stays valid during the pass
+		UInt32 NumCollapses = 0;
+		for (const Collapse& CurrentCollapse : Collapses)
+		{
+			if (CurrentCollapse.Error > MaxErrorSqr || TriangleCount * 3 <= TargetIndexCount)
+			{
+				break;
+			}
+
+			const UInt32 From		= CurrentCollapse.From;
+			const UInt32 To			= CurrentCollapse.To;
+			const UInt32 FromGroup	= Groups[From];
+			const UInt32 ToGroup	= Groups[To];
+			if (IsCollapseLocked[FromGroup] || IsCollapseLocked[ToGroup])
+			{
+				continue;
+			}
+
+			bool IsValid = true;
+
+			// Mark the ring of From, the triangles around From must not be touched by another collapse in this pass
+			RingMark++;
+			for (UInt32 Offset = AdjacencyOffsets[FromGroup]; Offset < AdjacencyOffsets[FromGroup + 1] && IsValid; Offset++)
+			{
+				const UInt32* Triangle = OutData.Indices.Data() + (Adjacency[Offset] * 3);
+				for (UInt32 Corner = 0; Corner < 3; Corner++)
+				{
+					const UInt32 Group = Groups[Triangle[Corner]];
+					if (IsCollapseLocked[Group])
+					{
+						IsValid = false;
+					}
+
+					RingMarks[Group] = RingMark;
+				}
+			}
+
+			if (!IsValid)
+			{
+				continue;
+			}
+
+			// Link condition, the rings of the two vertices may only share the two vertices opposite to the edge
+			UInt32 NumShared = 0;
+			for (UInt32 Offset = AdjacencyOffsets[ToGroup]; Offset < AdjacencyOffsets[ToGroup + 1]; Offset++)
+			{
+				const UInt32* Triangle = OutData.Indices.Data() + (Adjacency[Offset] * 3);
+				for (UInt32 Corner = 0; Corner < 3; Corner++)
+				{
+					const UInt32 Group = Groups[Triangle[Corner]];
+					if (RingMarks[Group] == RingMark && Group != FromGroup && Group != ToGroup)
+					{
+						// Count each shared group once
+						RingMarks[Group] = RingMark - 1;
+						NumShared++;
+					}
+				}
+			}
+
+			// Restore the marks of the shared groups
+			for (UInt32 Offset = AdjacencyOffsets[FromGroup]; Offset < AdjacencyOffsets[FromGroup + 1]; Offset++)
+			{
+				const UInt32* Triangle = OutData.Indices.Data() + (Adjacency[Offset] * 3);
+				for (UInt32 Corner = 0; Corner < 3; Corner++)
+				{
+					RingMarks[Groups[Triangle[Corner]]] = RingMark;
+				}
+			}
+
+			if (NumShared != 2)
+			{
+				continue;
+			}
+
+			// Triangles that do not contain the edge must not flip
+			XMVECTOR NewPosition = XMLoadFloat3(&Positions[To]);
+
+			UInt32 NumRemoved = 0;
+			for (UInt32 Offset = AdjacencyOffsets[FromGroup]; Offset < AdjacencyOffsets[FromGroup + 1] && IsValid; Offset++)
+			{
+				const UInt32* Triangle = OutData.Indices.Data() + (Adjacency[Offset] * 3);
+				if (Groups[Triangle[0]] == ToGroup || Groups[Triangle[1]] == ToGroup || Groups[Triangle[2]] == ToGroup)
+				{
+					NumRemoved++;
+					continue;
+				}
+
+				XMVECTOR Position0 = XMLoadFloat3(&Positions[Triangle[0]]);
+				XMVECTOR Position1 = XMLoadFloat3(&Positions[Triangle[1]]);
+				XMVECTOR Position2 = XMLoadFloat3(&Positions[Triangle[2]]);
+				XMVECTOR Normal = XMVector3Cross(XMVectorSubtract(Position1, Position0), XMVectorSubtract(Position2, Position0));
+
+				Position0 = (Groups[Triangle[0]] == FromGroup) ? NewPosition : Position0;
+				Position1 = (Groups[Triangle[1]] == FromGroup) ? NewPosition : Position1;
+				Position2 = (Groups[Triangle[2]] == FromGroup) ? NewPosition : Position2;
+				XMVECTOR NewNormal = XMVector3Cross(XMVectorSubtract(Position1, Position0), XMVectorSubtract(Position2, Position0));
+
+				const Float Dot		= XMVectorGetX(XMVector3Dot(Normal, NewNormal));
+				const Float Length	= XMVectorGetX(XMVector3Length(Normal)) * XMVectorGetX(XMVector3Length(NewNormal));
+				if (Dot <= 0.25f * Length)
+				{
+					IsValid = false;
+				}
+			}
+
+			if (!IsValid)
+			{
+				continue;
+			}
+
+			// From only has one vertex in its group, To is the vertex that the triangles on the edge use
+			Remap[From] = To;
+			Quadrics[ToGroup].Add(Quadrics[FromGroup]);
+
+			for (UInt32 Offset = AdjacencyOffsets[FromGroup]; Offset < AdjacencyOffsets[FromGroup + 1]; Offset++)
+			{
+				const UInt32* Triangle = OutData.Indices.Data() + (Adjacency[Offset] * 3);
+				for (UInt32 Corner = 0; Corner < 3; Corner++)
+				{
+					IsCollapseLocked[Groups[Triangle[Corner]]] = 1;
+				}
+			}
+
+			ResultErrorSqr = std::max<Float>(ResultErrorSqr, CurrentCollapse.Error);
+			TriangleCount -= NumRemoved;
+			NumCollapses++;
+		}
+
+		if (NumCollapses == 0)
+		{
+			if (UseAllEdges)
+			{
+				break;
+			}
+
+			UseAllEdges = true;
+			continue;
+		}
+
+		// Apply the collapses and remove the triangles that became degenerate
+		UInt32 NumIndices = 0;
+		for (UInt32 Index = 0; Index < OutData.Indices.Size(); Index += 3)
+		{
+			const UInt32 Index0 = Remap[OutData.Indices[Index]];
+			const UInt32 Index1 = Remap[OutData.Indices[Index + 1]];
+			const UInt32 Index2 = Remap[OutData.Indices[Index + 2]];
+			if (Groups[Index0] != Groups[Index1] && Groups[Index0] != Groups[Index2] && Groups[Index1] != Groups[Index2])
+			{
+				OutData.Indices[NumIndices++] = Index0;
+				OutData.Indices[NumIndices++] = Index1;
+				OutData.Indices[NumIndices++] = Index2;
+			}
+		}
+
+		OutData.Indices.Resize(NumIndices);
+		TriangleCount = NumIndices / 3;
+	}
+
+	OptimizeVertexFetch(OutData);
+	return sqrtf(ResultErrorSqr);
+}
+
+void MeshFactory::CreateLODChain(const MeshData& Data, TArray<MeshData>& OutLODs, TArray<Float>& OutErrors, UInt32 MaxLODs, Float BaseError) noexcept
+{
+	OutLODs.Clear();
+	OutErrors.Clear();
+
+	constexpr Float Inf = std::numeric_limits<Float>::infinity();
+	XMFLOAT3 Min = XMFLOAT3(Inf, Inf, Inf);
+	XMFLOAT3 Max = XMFLOAT3(-Inf, -Inf, -Inf);
+	for (const Vertex& CurrentVertex : Data.Vertices)
+	{
+		Min.x = std::min<Float>(Min.x, CurrentVertex.Position.x);
+		Min.y = std::min<Float>(Min.y, CurrentVertex.Position.y);
+		Min.z = std::min<Float>(Min.z, CurrentVertex.Position.z);
+		Max.x = std::max<Float>(Max.x, CurrentVertex.Position.x);
+		Max.y = std::max<Float>(Max.y, CurrentVertex.Position.y);
+		Max.z = std::max<Float>(Max.z, CurrentVertex.Position.z);
+	}
+
+	const Float Extent = std::max<Float>(Max.x - Min.x, std::max<Float>(Max.y - Min.y, Max.z - Min.z));
+
+	// Each level halves the triangles and doubles the allowed error, the errors of the levels add up
+	const MeshData* Previous = &Data;
+	Float Error = 0.0f;
+	for (UInt32 Level = 0; Level < MaxLODs; Level++)
+	{
+		const UInt32 PreviousIndexCount	= Previous->Indices.Size();
+		const UInt32 TargetIndexCount	= ((PreviousIndexCount / 3) / 2) * 3;
+		const Float TargetError			= BaseError * Float(1 << Level);
+
+		MeshData LOD = *Previous;
+		const Float LevelError = Simplify(LOD, TargetIndexCount, TargetError);
+
+		// Stop when the mesh cannot be reduced further within the error
+		if (LOD.Indices.Size() == 0 || LOD.Indices.Size() > (PreviousIndexCount * 9) / 10)
+		{
+			break;
+		}
+
+		Error += LevelError * Extent;
+		OutLODs.EmplaceBack(Move(LOD));
+		OutErrors.EmplaceBack(Error);
+		Previous = &OutLODs.Back();
+	}
+}
+
+/*
+* Index compression
+*/
+
+static FORCEINLINE UInt32 ZigZagEncode(Int32 Value)
+{
+	return (static_cast<UInt32>(Value) << 1) ^ static_cast<UInt32>(Value >> 31);
+}
+
+static FORCEINLINE UInt32 ZigZagDecode(UInt32 Value)
+{
+	return (Value >> 1) ^ (0u - (Value & 1));
+}
+
+#if INDEX_DECODE_USE_SSSE3
+// Shuffle masks that move four values with the lengths given by a control byte into four 32-bit lanes
+struct IndexDecodeTables
+{
+	IndexDecodeTables()
+	{
+		for (UInt32 Control = 0; Control < 256; Control++)
+		{
+			UInt8 Offset = 0;
+			for (UInt32 Lane = 0; Lane < 4; Lane++)
+			{
+				const UInt32 Length = ((Control >> (Lane * 2)) & 3) + 1;
+				for (UInt32 Byte = 0; Byte < 4; Byte++)
+				{
+					Shuffles[Control][Lane * 4 + Byte] = (Byte < Length) ? Offset++ : 0x80;
+				}
+			}
+
+			Lengths[Control] = Offset;
+		}
+	}
+
+	alignas(16) UInt8 Shuffles[256][16];
+	UInt8 Lengths[256];
+};
+
+static const IndexDecodeTables& GetIndexDecodeTables()
+{
+	static IndexDecodeTables Tables;
+	return Tables;
+}
+
+static bool CanUseSSSE3()
+{
+#if INDEX_DECODE_CHECK_CPU
+	static const bool HasSSSE3 = []()
+	{
+		int CPUInfo[4];
+		__cpuid(CPUInfo, 1);
+		return (CPUInfo[2] & (1 << 9)) != 0;
+	}();
+
+	return HasSSSE3;
+#else
+	return true;
+#endif
+}
+#endif
+
+void MeshFactory::EncodeIndices(const TArray<UInt32>& Indices, TArray<UInt8>& OutEncoded) noexcept
+{
+	const UInt32 IndexCount		= Indices.Size();
+	const UInt32 ControlSize	= (IndexCount + 3) / 4;
+
+	OutEncoded.Clear();
+	OutEncoded.Reserve(ControlSize + IndexCount * 2);
+	OutEncoded.Resize(ControlSize, 0);
+
+	UInt32 Previous = 0;
+	for (UInt32 Index = 0; Index < IndexCount; Index++)
+	{
+		const UInt32 Value = ZigZagEncode(static_cast<Int32>(Indices[Index] - Previous));
+		Previous = Indices[Index];
+
+		const UInt32 Length = (Value < (1u << 8)) ? 1 : (Value < (1u << 16)) ? 2 : (Value < (1u << 24)) ? 3 : 4;
+		OutEncoded[Index / 4] |= static_cast<UInt8>((Length - 1) << ((Index % 4) * 2));
+		for (UInt32 Byte = 0; Byte < Length; Byte++)
+		{
+			OutEncoded.EmplaceBack(static_cast<UInt8>(Value >> (Byte * 8)));
+		}
+	}
+}
+
+bool MeshFactory::DecodeIndices(const UInt8* Encoded, UInt64 EncodedSize, UInt32* OutIndices, UInt32 IndexCount) noexcept
+{
+	const UInt64 ControlSize = (static_cast<UInt64>(IndexCount) + 3) / 4;
+	if (EncodedSize < ControlSize)
+	{
+		return false;
+	}
+
+	const UInt8* Data		= Encoded + ControlSize;
+	const UInt8* DataEnd	= Encoded + EncodedSize;
+
+	UInt32 Index	= 0;
+	UInt32 Last		= 0;
+#if INDEX_DECODE_USE_SSSE3
+	if (CanUseSSSE3())
+	{
+		const IndexDecodeTables& Tables = GetIndexDecodeTables();
+		const UInt8* Control = Encoded;
+
+		// Groups of four, as long as a full 16 byte load stays inside the stream
+		__m128i Previous = _mm_setzero_si128();
+		const __m128i One = _mm_set1_epi32(1);
+		for (; Index + 4 <= IndexCount && (DataEnd - Data) >= 16; Index += 4)
+		{
+			const UInt8 Lengths = *Control++;
+
+			__m128i Values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data));
+			Values = _mm_shuffle_epi8(Values, _mm_load_si128(reinterpret_cast<const __m128i*>(Tables.Shuffles[Lengths])));
+			Data += Tables.Lengths[Lengths];
+
+			// ZigZag decode followed by a prefix sum of the differences
+			__m128i Deltas = _mm_xor_si128(_mm_srli_epi32(Values, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(Values, One)));
+			Deltas = _mm_add_epi32(Deltas, _mm_slli_si128(Deltas, 4));
+			Deltas = _mm_add_epi32(Deltas, _mm_slli_si128(Deltas, 8));
+
+			const __m128i Result = _mm_add_epi32(Deltas, Previous);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(OutIndices + Index), Result);
+			Previous = _mm_shuffle_epi32(Result, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+
+		Last = static_cast<UInt32>(_mm_cvtsi128_si32(Previous));
+	}
+#endif
+
+	// Remaining indices, or all of them without SSSE3
+	for (; Index < IndexCount; Index++)
+	{
+		const UInt32 Length = ((Encoded[Index / 4] >> ((Index % 4) * 2)) & 3) + 1;
+		if (static_cast<UInt64>(DataEnd - Data) < Length)
+		{
+			return false;
+		}
+
+		UInt32 Value = 0;
+		for (UInt32 Byte = 0; Byte < Length; Byte++)
+		{
+			Value |= static_cast<UInt32>(Data[Byte]) << (Byte * 8);
+		}
+
+		Data += Length;
+		Last += ZigZagDecode(Value);
+		OutIndices[Index] = Last;
+	}
+
+	return true;
+}
+
+/*
+* Vertex compression
+*/
+
+// Maps a unit vector onto the octahedron |x| + |y| + |z| = 1 and folds the lower half over the diagonals into [-1, 1]
+static FORCEINLINE XMVECTOR XM_CALLCONV EncodeOctahedral(FXMVECTOR Direction)
+{
+	const XMVECTOR Zero	= XMVectorZero();
+	const XMVECTOR One	= XMVectorSplatOne();
+
+	XMVECTOR AbsSum		= XMVector3Dot(XMVectorAbs(Direction), One);
+	XMVECTOR Projected	= XMVectorDivide(Direction, XMVectorMax(AbsSum, XMVectorReplicate(1e-20f)));
+
+	XMVECTOR Sign	= XMVectorSelect(XMVectorNegate(One), One, XMVectorGreaterOrEqual(Projected, Zero));
+	XMVECTOR Folded	= XMVectorMultiply(XMVectorSubtract(One, XMVectorAbs(XMVectorSwizzle<1, 0, 2, 3>(Projected))), Sign);
+	return XMVectorSelect(Projected, Folded, XMVectorLess(XMVectorSplatZ(Projected), Zero));
+}
+
+void MeshFactory::PackVertices(const MeshData& Data, TArray<PackedVertex>& OutVertices, VertexQuantization& OutQuantization) noexcept
+{
+	using namespace PackedVector;
+
+	const UInt32 VertexCount = Data.Vertices.Size();
+	OutVertices.Resize(VertexCount);
+	if (VertexCount == 0)
+	{
+		OutQuantization = VertexQuantization();
+		return;
+	}
+
+	XMVECTOR Min = XMLoadFloat3(&Data.Vertices[0].Position);
+	XMVECTOR Max = Min;
+	for (const Vertex& CurrentVertex : Data.Vertices)
+	{
+		XMVECTOR Position = XMLoadFloat3(&CurrentVertex.Position);
+		Min = XMVectorMin(Min, Position);
+		Max = XMVectorMax(Max, Position);
+	}
+
+	// Positions are stored in [-1, 1] inside the bounding box, flat boxes still get a valid scale
+	const XMVECTOR Half		= XMVectorReplicate(0.5f);
+	const XMVECTOR Offset	= XMVectorMultiply(XMVectorAdd(Min, Max), Half);
+	const XMVECTOR Scale	= XMVectorMax(XMVectorMultiply(XMVectorSubtract(Max, Min), Half), XMVectorReplicate(1e-6f));
+	XMStoreFloat4(&OutQuantization.Offset, XMVectorSetW(Offset, 0.0f));
+	XMStoreFloat4(&OutQuantization.Scale, XMVectorSetW(Scale, 0.0f));
+
+	const XMVECTOR InvScale = XMVectorReciprocal(Scale);
+	ParallelForBatch(VertexCount, [&](UInt32 Begin, UInt32 End)
+	{
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			const Vertex&	Source		= Data.Vertices[Index];
+			PackedVertex&	Destination	= OutVertices[Index];
+
+			XMVECTOR Position = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&Source.Position), Offset), InvScale);
+			// The unused W of the position stores the handedness of the tangent space
+			XMStoreShortN4(&Destination.Position, XMVectorSetW(Position, (Source.Tangent.w < 0.0f) ? -1.0f : 1.0f));
+			XMStoreShortN2(&Destination.Normal, EncodeOctahedral(XMLoadFloat3(&Source.Normal)));
+			XMStoreShortN2(&Destination.Tangent, EncodeOctahedral(XMLoadFloat4(&Source.Tangent)));
+			XMStoreHalf2(&Destination.TexCoord, XMLoadFloat2(&Source.TexCoord));
+		}
+	}, 1024);
+}
+
+void MeshFactory::CalculateHardNormals(MeshData& Data) noexcept
+{
+	UNREFERENCED_VARIABLE(Data);
+
+	/*
+	vec3 e1;
+	vec3 e2;
+	vec3 n;
+
+	for (size_t i = 0; i < data.Indices.GetSize(); i += 3)
+	{
+		e1 = data.Vertices[data.Indices[i + 2]].Position - data.Vertices[data.Indices[i]].Position;
+		e2 = data.Vertices[data.Indices[i + 1]].Position - data.Vertices[data.Indices[i]].Position;
+		n = cross(e1, e2);
+
+		data.Vertices[data.Indices[i]].Normal = n;
+		data.Vertices[data.Indices[i + 1]].Normal = n;
+		data.Vertices[data.Indices[i + 2]].Normal = n;
+	}
+	*/
+}
+
+void MeshFactory::CalculateTangents(MeshData& OutData) noexcept
+{
+	const UInt32 VertexCount	= OutData.Vertices.Size();
+	const UInt32 TriangleCount	= OutData.Indices.Size() / 3;
+	if (VertexCount == 0 || TriangleCount == 0)
+	{
+		return;
+	}
+
+	// Positions and texcoords are split into one stream per component so that four triangles are processed at once, one
+	// triangle in each lane
+	TArray<Float> Streams(VertexCount * 5);
+	Float* PositionsX	= Streams.Data();
+	Float* PositionsY	= PositionsX + VertexCount;
+	Float* PositionsZ	= PositionsY + VertexCount;
+	Float* TexCoordsU	= PositionsZ + VertexCount;
+	Float* TexCoordsV	= TexCoordsU + VertexCount;
+	ParallelForBatch(VertexCount, [&](UInt32 Begin, UInt32 End)
+	{
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			const Vertex& CurrentVertex = OutData.Vertices[Index];
+			PositionsX[Index]	= CurrentVertex.Position.x;
+			PositionsY[Index]	= CurrentVertex.Position.y;
+			PositionsZ[Index]	= CurrentVertex.Position.z;
+			TexCoordsU[Index]	= CurrentVertex.TexCoord.x;
+			TexCoordsV[Index]	= CurrentVertex.TexCoord.y;
+		}
+	}, 1024);
+
+	// Normalized tangent and bitangent of each triangle and the weight of each corner, padded to a multiple of four
+	// triangles
+	const UInt32 GroupCount = (TriangleCount + 3) / 4;
+	TArray<XMFLOAT4>	TriangleTangents(GroupCount * 4);
+	TArray<XMFLOAT4>	TriangleBitangents(GroupCount * 4);
+	TArray<Float>		CornerWeights(GroupCount * 12);
+
+	const UInt32* Indices = OutData.Indices.Data();
+	ParallelForBatch(GroupCount, [&](UInt32 Begin, UInt32 End)
+	{
+		const XMVECTOR Zero		= XMVectorZero();
+		const XMVECTOR One		= XMVectorSplatOne();
+		const XMVECTOR Tiny		= XMVectorReplicate(1e-30f);
+		const XMVECTOR Pi		= XMVectorReplicate(XM_PI);
+
+		auto LengthSq = [](FXMVECTOR X, FXMVECTOR Y, FXMVECTOR Z)
+		{
+			XMVECTOR Result = XMVectorMultiply(X, X);
+			Result = XMVectorMultiplyAdd(Y, Y, Result);
+			return XMVectorMultiplyAdd(Z, Z, Result);
+		};
+
+		auto InvLength = [&LengthSq, Tiny](FXMVECTOR X, FXMVECTOR Y, FXMVECTOR Z)
+		{
+			return XMVectorReciprocalSqrt(XMVectorMax(LengthSq(X, Y, Z), Tiny));
+		};
+
+		for (UInt32 Group = Begin; Group < End; Group++)
+		{
+			// The lanes past the last triangle repeat it, their results end up in the padding
+			UInt32 Corners[3][4];
+			for (UInt32 Lane = 0; Lane < 4; Lane++)
+			{
+				UInt32 Triangle = Group * 4 + Lane;
+				Triangle = (Triangle < TriangleCount) ? Triangle : (TriangleCount - 1);
+
+				Corners[0][Lane] = Indices[Triangle * 3 + 0];
+				Corners[1][Lane] = Indices[Triangle * 3 + 1];
+				Corners[2][Lane] = Indices[Triangle * 3 + 2];
+			}
+
+			auto Gather = [&Corners](const Float* Stream, UInt32 Corner)
+			{
+				const UInt32* Lanes = Corners[Corner];
+				return XMVectorSet(Stream[Lanes[0]], Stream[Lanes[1]], Stream[Lanes[2]], Stream[Lanes[3]]);
+			};
+
+			const XMVECTOR X0 = Gather(PositionsX, 0);
+			const XMVECTOR Y0 = Gather(PositionsY, 0);
+			const XMVECTOR Z0 = Gather(PositionsZ, 0);
+			const XMVECTOR U0 = Gather(TexCoordsU, 0);
+			const XMVECTOR V0 = Gather(TexCoordsV, 0);
+
+			const XMVECTOR Edge1X	= XMVectorSubtract(Gather(PositionsX, 1), X0);
+			const XMVECTOR Edge1Y	= XMVectorSubtract(Gather(PositionsY, 1), Y0);
+			const XMVECTOR Edge1Z	= XMVectorSubtract(Gather(PositionsZ, 1), Z0);
+			const XMVECTOR Edge2X	= XMVectorSubtract(Gather(PositionsX, 2), X0);
+			const XMVECTOR Edge2Y	= XMVectorSubtract(Gather(PositionsY, 2), Y0);
+			const XMVECTOR Edge2Z	= XMVectorSubtract(Gather(PositionsZ, 2), Z0);
+			const XMVECTOR DeltaU1	= XMVectorSubtract(Gather(TexCoordsU, 1), U0);
+			const XMVECTOR DeltaV1	= XMVectorSubtract(Gather(TexCoordsV, 1), V0);
+			const XMVECTOR DeltaU2	= XMVectorSubtract(Gather(TexCoordsU, 2), U0);
+			const XMVECTOR DeltaV2	= XMVectorSubtract(Gather(TexCoordsV, 2), V0);
+
+			// Only the direction is needed, so instead of dividing by the determinant of the UV edges it only flips the sign
+			const XMVECTOR Determinant	= XMVectorSubtract(XMVectorMultiply(DeltaU1, DeltaV2), XMVectorMultiply(DeltaU2, DeltaV1));
+			const XMVECTOR Sign			= XMVectorSelect(One, XMVectorNegate(One), XMVectorLess(Determinant, Zero));
+
+			XMVECTOR TangentX	= XMVectorMultiply(XMVectorSubtract(XMVectorMultiply(Edge1X, DeltaV2), XMVectorMultiply(Edge2X, DeltaV1)), Sign);
+			XMVECTOR TangentY	= XMVectorMultiply(XMVectorSubtract(XMVectorMultiply(Edge1Y, DeltaV2), XMVectorMultiply(Edge2Y, DeltaV1)), Sign);
+			XMVECTOR TangentZ	= XMVectorMultiply(XMVectorSubtract(XMVectorMultiply(Edge1Z, DeltaV2), XMVectorMultiply(Edge2Z, DeltaV1)), Sign);
+			XMVECTOR Scale		= InvLength(TangentX, TangentY, TangentZ);
+			TangentX = XMVectorMultiply(TangentX, Scale);
+			TangentY = XMVectorMultiply(TangentY, Scale);
+			TangentZ = XMVectorMultiply(TangentZ, Scale);
+
+			XMVECTOR BitangentX	= XMVectorMultiply(XMVectorSubtract(XMVectorMultiply(Edge2X, DeltaU1), XMVectorMultiply(Edge1X, DeltaU2)), Sign);
+			XMVECTOR BitangentY	= XMVectorMultiply(XMVectorSubtract(XMVectorMultiply(Edge2Y, DeltaU1), XMVectorMultiply(Edge1Y, DeltaU2)), Sign);
+			XMVECTOR BitangentZ	= XMVectorMultiply(XMVectorSubtract(XMVectorMultiply(Edge2Z, DeltaU1), XMVectorMultiply(Edge1Z, DeltaU2)), Sign);
+			Scale = InvLength(BitangentX, BitangentY, BitangentZ);
+			BitangentX = XMVectorMultiply(BitangentX, Scale);
+			BitangentY = XMVectorMultiply(BitangentY, Scale);
+			BitangentZ = XMVectorMultiply(BitangentZ, Scale);
+
+			// Twice the area of the triangle
+			const XMVECTOR CrossX	= XMVectorSubtract(XMVectorMultiply(Edge1Y, Edge2Z), XMVectorMultiply(Edge1Z, Edge2Y));
+			const XMVECTOR CrossY	= XMVectorSubtract(XMVectorMultiply(Edge1Z, Edge2X), XMVectorMultiply(Edge1X, Edge2Z));
+			const XMVECTOR CrossZ	= XMVectorSubtract(XMVectorMultiply(Edge1X, Edge2Y), XMVectorMultiply(Edge1Y, Edge2X));
+			const XMVECTOR AreaSq	= LengthSq(CrossX, CrossY, CrossZ);
+			const XMVECTOR Area		= XMVectorSqrt(AreaSq);
+
+			// Angles of the first two corners, the third is what remains of pi
+			const XMVECTOR Edge3X			= XMVectorSubtract(Edge2X, Edge1X);
+			const XMVECTOR Edge3Y			= XMVectorSubtract(Edge2Y, Edge1Y);
+			const XMVECTOR Edge3Z			= XMVectorSubtract(Edge2Z, Edge1Z);
+			const XMVECTOR InvLength1		= InvLength(Edge1X, Edge1Y, Edge1Z);
+			const XMVECTOR InvLength2		= InvLength(Edge2X, Edge2Y, Edge2Z);
+			const XMVECTOR InvLength3		= InvLength(Edge3X, Edge3Y, Edge3Z);
+
+			XMVECTOR Cosine0 = XMVectorMultiply(Edge1X, Edge2X);
+			Cosine0 = XMVectorMultiplyAdd(Edge1Y, Edge2Y, Cosine0);
+			Cosine0 = XMVectorMultiplyAdd(Edge1Z, Edge2Z, Cosine0);
+			Cosine0 = XMVectorMultiply(Cosine0, XMVectorMultiply(InvLength1, InvLength2));
+
+			XMVECTOR Cosine1 = XMVectorMultiply(Edge1X, Edge3X);
+			Cosine1 = XMVectorMultiplyAdd(Edge1Y, Edge3Y, Cosine1);
+			Cosine1 = XMVectorMultiplyAdd(Edge1Z, Edge3Z, Cosine1);
+			Cosine1 = XMVectorNegate(XMVectorMultiply(Cosine1, XMVectorMultiply(InvLength1, InvLength3)));
+
+			const XMVECTOR Angle0 = XMVectorACos(XMVectorClamp(Cosine0, XMVectorNegate(One), One));
+			const XMVECTOR Angle1 = XMVectorACos(XMVectorClamp(Cosine1, XMVectorNegate(One), One));
+			const XMVECTOR Angle2 = XMVectorMax(XMVectorSubtract(Pi, XMVectorAdd(Angle0, Angle1)), Zero);
+
+			// Each corner is weighted by its angle and the area of the triangle, triangles without area in either space do
+			// not contribute
+			const XMVECTOR IsValid = XMVectorAndInt(XMVectorNotEqual(Determinant, Zero), XMVectorGreater(AreaSq, Tiny));
+			const XMVECTOR Weight0 = XMVectorSelect(Zero, XMVectorMultiply(Angle0, Area), IsValid);
+			const XMVECTOR Weight1 = XMVectorSelect(Zero, XMVectorMultiply(Angle1, Area), IsValid);
+			const XMVECTOR Weight2 = XMVectorSelect(Zero, XMVectorMultiply(Angle2, Area), IsValid);
+
+			// Back to one vector per triangle, each row holds one lane after the transpose
+			const XMMATRIX Tangents		= XMMatrixTranspose(XMMATRIX(TangentX, TangentY, TangentZ, One));
+			const XMMATRIX Bitangents	= XMMatrixTranspose(XMMATRIX(BitangentX, BitangentY, BitangentZ, Zero));
+			const XMMATRIX Weights		= XMMatrixTranspose(XMMATRIX(Weight0, Weight1, Weight2, Zero));
+			for (UInt32 Lane = 0; Lane < 4; Lane++)
+			{
+				const UInt32 Triangle = Group * 4 + Lane;
+				XMStoreFloat4(&TriangleTangents[Triangle], Tangents.r[Lane]);
+				XMStoreFloat4(&TriangleBitangents[Triangle], Bitangents.r[Lane]);
+				XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&CornerWeights[Triangle * 3]), Weights.r[Lane]);
+			}
+		}
+	}, 256);
+
+	// The vertices are split into slices of a power of two and the corners are sorted by the slice of their vertex with a
+	// counting sort: every chunk of corners counts the corners of each slice, a prefix sum over the counts gives the
+	// offsets and every chunk then scatters its corners. Each corner is visited a constant number of times and the
+	// corners of a slice stay in corner order, so the sums do not depend on the number of threads
+	const UInt32 CornerCount	= TriangleCount * 3;
+	const UInt32 MaxJobs		= std::max(JobSystem::GetNumThreads(), 1u) * 4;
+
+	UInt32 SliceShift = 10;
+	while (((VertexCount - 1) >> SliceShift) >= MaxJobs)
+	{
+		SliceShift++;
+	}
+
+	const UInt32 SliceCount	= ((VertexCount - 1) >> SliceShift) + 1;
+	const UInt32 ChunkSize	= std::max((CornerCount + MaxJobs - 1) / MaxJobs, 4096u);
+	const UInt32 ChunkCount	= (CornerCount + ChunkSize - 1) / ChunkSize;
+
+	// Number of corners that each chunk has in each slice, replaced by the offset that the chunk writes the slice at
+	TArray<UInt32> ChunkOffsets(ChunkCount * SliceCount, 0);
+	ParallelFor(ChunkCount, [&](UInt32 Chunk)
+	{
+		UInt32* Counts = ChunkOffsets.Data() + Chunk * SliceCount;
+		const UInt32 End = std::min(CornerCount, (Chunk + 1) * ChunkSize);
+		for (UInt32 Corner = Chunk * ChunkSize; Corner < End; Corner++)
+		{
+			Counts[Indices[Corner] >> SliceShift]++;
+		}
+	}, 1);
+
+	TArray<UInt32> SliceOffsets(SliceCount + 1);
+	UInt32 Offset = 0;
+	for (UInt32 Slice = 0; Slice < SliceCount; Slice++)
+	{
+		SliceOffsets[Slice] = Offset;
+		for (UInt32 Chunk = 0; Chunk < ChunkCount; Chunk++)
+		{
+			const UInt32 Count = ChunkOffsets[Chunk * SliceCount + Slice];
+			ChunkOffsets[Chunk * SliceCount + Slice] = Offset;
+			Offset += Count;
+		}
+	}
+
+	SliceOffsets[SliceCount] = Offset;
+
+	TArray<UInt32> SortedCorners(CornerCount);
+	ParallelFor(ChunkCount, [&](UInt32 Chunk)
+	{
+		UInt32* Offsets = ChunkOffsets.Data() + Chunk * SliceCount;
+		const UInt32 End = std::min(CornerCount, (Chunk + 1) * ChunkSize);
+		for (UInt32 Corner = Chunk * ChunkSize; Corner < End; Corner++)
+		{
+			SortedCorners[Offsets[Indices[Corner] >> SliceShift]++] = Corner;
+		}
+	}, 1);
+
+	// Every slice sums the weighted tangents around its vertices and orthonormalizes them against the normal. The weights
+	// are summed in W since the triangle tangents store one there
+	TArray<XMFLOAT4> VertexTangents(VertexCount);
+	TArray<XMFLOAT4> VertexBitangents(VertexCount);
+	ParallelFor(SliceCount, [&](UInt32 Slice)
+	{
+		const UInt32 Begin	= Slice << SliceShift;
+		const UInt32 End	= std::min(VertexCount, (Slice + 1) << SliceShift);
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			XMStoreFloat4(&VertexTangents[Index], XMVectorZero());
+			XMStoreFloat4(&VertexBitangents[Index], XMVectorZero());
+		}
+
+		for (UInt32 SortedIndex = SliceOffsets[Slice]; SortedIndex < SliceOffsets[Slice + 1]; SortedIndex++)
+		{
+			const UInt32	Corner			= SortedCorners[SortedIndex];
+			const UInt32	Index			= Indices[Corner];
+			const UInt32	Triangle		= Corner / 3;
+			const XMVECTOR	WeightVector	= XMVectorReplicate(CornerWeights[Corner]);
+			XMStoreFloat4(&VertexTangents[Index], XMVectorMultiplyAdd(XMLoadFloat4(&TriangleTangents[Triangle]), WeightVector, XMLoadFloat4(&VertexTangents[Index])));
+			XMStoreFloat4(&VertexBitangents[Index], XMVectorMultiplyAdd(XMLoadFloat4(&TriangleBitangents[Triangle]), WeightVector, XMLoadFloat4(&VertexBitangents[Index])));
+		}
+
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			Vertex& CurrentVertex = OutData.Vertices[Index];
+			const XMVECTOR	Normal		= XMLoadFloat3(&CurrentVertex.Normal);
+			const XMVECTOR	Bitangent	= XMLoadFloat4(&VertexBitangents[Index]);
+			XMVECTOR		Tangent		= XMLoadFloat4(&VertexTangents[Index]);
+			const Float		TotalWeight	= XMVectorGetW(Tangent);
+
+			// Gram-Schmidt, when the tangents cancel out or are parallel to the normal any perpendicular axis is used
+			Tangent = XMVectorScale(Tangent, (TotalWeight > 0.0f) ? (1.0f / TotalWeight) : 0.0f);
+			Tangent = XMVectorSubtract(Tangent, XMVectorMultiply(Normal, XMVector3Dot(Normal, Tangent)));
+			if (XMVectorGetX(XMVector3LengthSq(Tangent)) < 1e-8f)
+			{
+				const XMVECTOR Axis = (std::abs(CurrentVertex.Normal.x) < 0.9f) ? XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f) : XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+				Tangent = XMVectorSubtract(Axis, XMVectorMultiply(Normal, XMVector3Dot(Normal, Axis)));
+			}
+
+			Tangent = XMVector3Normalize(Tangent);
+
+			// The bitangent is rebuilt as cross(Normal, Tangent) * W, W is negative where the UVs are mirrored
+			const Float Handedness = (XMVectorGetX(XMVector3Dot(XMVector3Cross(Normal, Tangent), Bitangent)) < 0.0f) ? -1.0f : 1.0f;
+			XMStoreFloat4(&CurrentVertex.Tangent, XMVectorSetW(Tangent, Handedness));
+		}
+	}, 1);
 }
 
 /*void Mesh::calcNormal()
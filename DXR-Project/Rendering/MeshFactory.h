@@ -5,8 +5,11 @@
 #include "Utilities/HashUtilities.h"
 
 #include <DirectXMath.h>
+#include <DirectXPackedVector.h>
 using namespace DirectX;
 
+#include "Scene/AABB.h"
+
 /*
 * Vertex
 */
@@ -15,7 +18,8 @@ struct Vertex
 {
 	XMFLOAT3 Position;
 	XMFLOAT3 Normal;
-	XMFLOAT3 Tangent;
+	// W is the handedness of the tangent space, Bitangent = cross(Normal, Tangent) * W
+	XMFLOAT4 Tangent;
 	XMFLOAT2 TexCoord;
 
 	FORCEINLINE bool operator==(const Vertex& Other) const
@@ -23,7 +27,7 @@ struct Vertex
 		return
 			((Position.x	== Other.Position.x)	&& (Position.y	== Other.Position.y)	&& (Position.z	== Other.Position.z))	&&
 			((Normal.x		== Other.Normal.x)		&& (Normal.y	== Other.Normal.y)		&& (Normal.z	== Other.Normal.z))		&&
-			((Tangent.x		== Other.Tangent.x)		&& (Tangent.y	== Other.Tangent.y)		&& (Tangent.z	== Other.Tangent.z))	&&
+			((Tangent.x		== Other.Tangent.x)		&& (Tangent.y	== Other.Tangent.y)		&& (Tangent.z	== Other.Tangent.z)		&& (Tangent.w == Other.Tangent.w))	&&
 			((TexCoord.x	== Other.TexCoord.x)	&& (TexCoord.y	== Other.TexCoord.y));
 	}
 };
@@ -40,7 +44,7 @@ struct VertexHasher
 
 		size_t Hash = Hasher(V.Position);
 		HashCombine<XMFLOAT3>(Hash, V.Normal);
-		HashCombine<XMFLOAT3>(Hash, V.Tangent);
+		HashCombine<XMFLOAT4>(Hash, V.Tangent);
 		HashCombine<XMFLOAT2>(Hash, V.TexCoord);
 
 		return Hash;
@@ -57,6 +61,83 @@ struct MeshData
 	TArray<UInt32> Indices;
 };
 
+/*
+* PackedVertex - Compressed vertex that is uploaded instead of Vertex when ENABLE_PACKED_VERTICES is set. Positions are
+* quantized to 16-bit inside the bounding box of the mesh, normal and tangent are octahedral encoded and the texcoords
+* are stored as halfs, 20 bytes instead of 48. The W of the position holds the handedness of the tangent. Must match
+* ENABLE_PACKED_VERTICES in PackedVertex.hlsli.
+*/
+
+#define ENABLE_PACKED_VERTICES 0
+
+struct PackedVertex
+{
+	PackedVector::XMSHORTN4	Position;
+	PackedVector::XMSHORTN2	Normal;
+	PackedVector::XMSHORTN2	Tangent;
+	PackedVector::XMHALF2	TexCoord;
+};
+
+/*
+* VertexQuantization - Restores the positions of a PackedVertex, Position = Packed * Scale + Offset
+*/
+
+struct VertexQuantization
+{
+	XMFLOAT4 Scale	= XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f);
+	XMFLOAT4 Offset	= XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+};
+
+/*
+* Meshlet - A small cluster of triangles. Meshlets are built from consecutive triangles, so each meshlet is also a range
+* of the original indexbuffer that can be drawn on its own.
+*/
+
+struct Meshlet
+{
+	// Range in MeshletData::Vertices
+	UInt32 VertexOffset		= 0;
+	UInt32 VertexCount		= 0;
+	// Range in MeshletData::Triangles, in triangles
+	UInt32 TriangleOffset	= 0;
+	UInt32 TriangleCount	= 0;
+	// First index in the indexbuffer of the mesh
+	UInt32 IndexOffset		= 0;
+
+	AABB Bounds;
+	XMFLOAT3 SphereCenter;
+	Float SphereRadius = 0.0f;
+
+	// All triangle normals are within the cone, ConeCutoff is the sine of the cone angle and 1.0 when it cannot be culled
+	XMFLOAT3 ConeAxis;
+	Float ConeCutoff = 1.0f;
+};
+
+/*
+* MeshletData
+*/
+
+struct MeshletData
+{
+	TArray<Meshlet> Meshlets;
+	// Indices into the vertices of the mesh
+	TArray<UInt32> Vertices;
+	// Three indices into the meshlet vertices for each triangle
+	TArray<UInt8> Triangles;
+};
+
+/*
+* VertexCacheStatistics
+*/
+
+struct VertexCacheStatistics
+{
+	// Average cache miss ratio, transformed vertices per triangle. Lowest possible is around 0.5
+	Float ACMR = 0.0f;
+	// Average transform to vertex ratio, transformed vertices per unique vertex. Lowest possible is 1.0
+	Float ATVR = 0.0f;
+};
+
 /*
 * MeshFactory
 */
@@ -74,8 +155,60 @@ public:
 	static MeshData CreatePyramid() noexcept;
 	static MeshData CreateCylinder(UInt32 Sides = 5, Float Radius = 0.5f, Float Height = 1.0f) noexcept;
 
+	/*
+	* Splits each triangle into four. Midpoints are shared between triangles through an edge cache, so a level adds
+	* exactly one vertex per unique edge and no welding pass is needed afterwards.
+	*/
 	static void Subdivide(MeshData& OutData, UInt32 Subdivisions = 1) noexcept;
-	static void Optimize(MeshData& OutData, UInt32 StartVertex = 0) noexcept;
+	/*
+	* Welds identical vertices in linear time using a hash table and compacts the vertexbuffer once. Only vertices starting
+	* at StartVertex are removed. With a WeldEpsilon larger than zero all components are quantized to that spacing first.
+	*/
+	static void Optimize(MeshData& OutData, UInt32 StartVertex = 0, Float WeldEpsilon = 0.0f) noexcept;
+
+	static VertexCacheStatistics AnalyzeVertexCache(const MeshData& Data, UInt32 CacheSize = 16) noexcept;
+	// Reorders the triangles for the post-transform vertex cache using Tipsify
+	static void OptimizeVertexCache(MeshData& OutData, UInt32 CacheSize = 16) noexcept;
+	/*
+	* Splits the triangles into clusters that stay within Threshold times the current ACMR and sorts the clusters so that
+	* triangles facing away from the center of the mesh are drawn first. Expects the triangles to be in cache order.
+	*/
+	static void OptimizeOverdraw(MeshData& OutData, Float Threshold = 1.05f, UInt32 CacheSize = 16) noexcept;
+	// Reorders the vertices in the order they are first used and removes unused vertices
+	static void OptimizeVertexFetch(MeshData& OutData) noexcept;
+	// Runs the vertex cache, overdraw and vertex fetch optimizations in order
+	static void OptimizeForRendering(MeshData& OutData, VertexCacheStatistics* OutBefore = nullptr, VertexCacheStatistics* OutAfter = nullptr) noexcept;
+
+	/*
+	* Splits the mesh into meshlets with at most MaxVertices vertices and MaxTriangles triangles. Triangles are added in
+	* order, so the mesh should be optimized for the vertex cache first to get tight meshlets.
+	*/
+	static void CreateMeshlets(const MeshData& Data, MeshletData& OutMeshlets, UInt32 MaxVertices = 64, UInt32 MaxTriangles = 124) noexcept;
+
+	/*
+	* Removes vertices with quadric error edge collapses until the mesh has at most TargetIndexCount indices or the next
+	* collapse would be larger than TargetError. Errors are relative to the largest side of the bounding box. Vertices
+	* on borders and UV or normal seams are never removed. Returns the largest error of the collapses.
+	*/
+	static Float Simplify(MeshData& OutData, UInt32 TargetIndexCount, Float TargetError = 0.01f) noexcept;
+	/*
+	* Creates up to MaxLODs simplified meshes, each with half the triangles of the previous one. The target error starts
+	* at BaseError and doubles each level. OutErrors contains the error of each level in the same units as the positions.
+	*/
+	static void CreateLODChain(const MeshData& Data, TArray<MeshData>& OutLODs, TArray<Float>& OutErrors, UInt32 MaxLODs = 3, Float BaseError = 0.005f) noexcept;
+
+	// Compresses the vertices into the packed format, OutQuantization is set to the bounding box of the positions
+	static void PackVertices(const MeshData& Data, TArray<PackedVertex>& OutVertices, VertexQuantization& OutQuantization) noexcept;
+
+	/*
+	* Compresses an indexbuffer for storage. Each index is stored as the zigzag encoded difference to the previous index
+	* in one to four bytes. Lengths are stored as two bits per index in front of the data, so four indices at a time
+	* can be decoded with a single shuffle.
+	*/
+	static void EncodeIndices(const TArray<UInt32>& Indices, TArray<UInt8>& OutEncoded) noexcept;
+	// Returns false if Encoded does not contain IndexCount indices
+	static bool DecodeIndices(const UInt8* Encoded, UInt64 EncodedSize, UInt32* OutIndices, UInt32 IndexCount) noexcept;
+
 	static void CalculateHardNormals(MeshData& OutData) noexcept;
 	static void CalculateTangents(MeshData& OutData) noexcept;
 };
\ No newline at end of file
@@ -0,0 +1,376 @@
+#include "OcclusionBuffer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define OCCLUSION_BUFFER_USE_SSE 1
+#else
+	#define OCCLUSION_BUFFER_USE_SSE 0
+#endif
+
+/*
+* Helpers
+*/
+
+// Vertices closer than this are treated as crossing the nearplane
+static constexpr Float MinW = 0.001f;
+
+// Screen positions are snapped to 1/8 of a pixel, with the guardband and the maximum size all edge functions fit in 32-bits
+static constexpr Int32 SubPixelBits		= 3;
+static constexpr Float SubPixelScale	= Float(1 << SubPixelBits);
+static constexpr Float GuardBand		= 512.0f;
+static constexpr UInt32 MaxSize			= 1024;
+
+static FORCEINLINE XMFLOAT4 TransformPoint(const XMFLOAT4X4& Matrix, const XMFLOAT3& Point)
+{
+	return XMFLOAT4(
+		(Matrix.m[0][0] * Point.x) + (Matrix.m[0][1] * Point.y) + (Matrix.m[0][2] * Point.z) + Matrix.m[0][3],
+		(Matrix.m[1][0] * Point.x) + (Matrix.m[1][1] * Point.y) + (Matrix.m[1][2] * Point.z) + Matrix.m[1][3],
+		(Matrix.m[2][0] * Point.x) + (Matrix.m[2][1] * Point.y) + (Matrix.m[2][2] * Point.z) + Matrix.m[2][3],
+		(Matrix.m[3][0] * Point.x) + (Matrix.m[3][1] * Point.y) + (Matrix.m[3][2] * Point.z) + Matrix.m[3][3]);
+}
+
+static FORCEINLINE XMFLOAT4X4 MultiplyMatrices(const XMFLOAT4X4& First, const XMFLOAT4X4& Second)
+{
+	XMFLOAT4X4 Result;
+	for (UInt32 Row = 0; Row < 4; Row++)
+	{
+		for (UInt32 Column = 0; Column < 4; Column++)
+		{
+			Result.m[Row][Column] =
+				(First.m[Row][0] * Second.m[0][Column]) +
+				(First.m[Row][1] * Second.m[1][Column]) +
+				(First.m[Row][2] * Second.m[2][Column]) +
+				(First.m[Row][3] * Second.m[3][Column]);
+		}
+	}
+
+	return Result;
+}
+
+/*
+* OcclusionBuffer
+*/
+
+OcclusionBuffer::OcclusionBuffer()
+	: Depth()
+	, TileMaxDepth()
+	, TransformedVertices()
+	, ViewProjection()
+{
+}
+
+void OcclusionBuffer::Initialize(UInt32 InWidth, UInt32 InHeight)
+{
+	VALIDATE(InWidth <= MaxSize && InHeight <= MaxSize);
+
+	NumTilesX	= (InWidth + TileSize - 1) / TileSize;
+	NumTilesY	= (InHeight + TileSize - 1) / TileSize;
+	Width		= NumTilesX * TileSize;
+	Height		= NumTilesY * TileSize;
+
+	Depth.Resize(Width * Height);
+	TileMaxDepth.Resize(NumTilesX * NumTilesY);
+}
+
+void OcclusionBuffer::Clear(const XMFLOAT4X4& InViewProjection)
+{
+	ViewProjection = InViewProjection;
+
+	for (Float& Value : Depth)
+	{
+		Value = 1.0f;
+	}
+
+	for (Float& Value : TileMaxDepth)
+	{
+		Value = 1.0f;
+	}
+}
+
+void OcclusionBuffer::RasterizeOccluder(const XMFLOAT4X4& Transform, const XMFLOAT3* Positions, UInt32 NumPositions, const UInt32* Indices, UInt32 NumIndices)
+{
+	const XMFLOAT4X4 WorldViewProjection = MultiplyMatrices(ViewProjection, Transform);
+
+	TransformedVertices.Resize(NumPositions);
+	for (UInt32 Index = 0; Index < NumPositions; Index++)
+	{
+		TransformedVertices[Index] = TransformPoint(WorldViewProjection, Positions[Index]);
+	}
+
+	const Float HalfWidth	= Float(Width) * 0.5f;
+	const Float HalfHeight	= Float(Height) * 0.5f;
+	for (UInt32 Index = 0; Index + 2 < NumIndices; Index += 3)
+	{
+		const XMFLOAT4* Clip[3] =
+		{
+			&TransformedVertices[Indices[Index + 0]],
+			&TransformedVertices[Indices[Index + 1]],
+			&TransformedVertices[Indices[Index + 2]],
+		};
+
+		// Skipping occluders is always safe, so triangles that need clipping are not rasterized
+		if (Clip[0]->w < MinW || Clip[1]->w < MinW || Clip[2]->w < MinW)
+		{
+			continue;
+		}
+
+		// Outside the screen
+		if ((Clip[0]->x >  Clip[0]->w && Clip[1]->x >  Clip[1]->w && Clip[2]->x >  Clip[2]->w) ||
+			(Clip[0]->x < -Clip[0]->w && Clip[1]->x < -Clip[1]->w && Clip[2]->x < -Clip[2]->w) ||
+			(Clip[0]->y >  Clip[0]->w && Clip[1]->y >  Clip[1]->w && Clip[2]->y >  Clip[2]->w) ||
+			(Clip[0]->y < -Clip[0]->w && Clip[1]->y < -Clip[1]->w && Clip[2]->y < -Clip[2]->w) ||
+			(Clip[0]->z >  Clip[0]->w && Clip[1]->z >  Clip[1]->w && Clip[2]->z >  Clip[2]->w))
+		{
+			continue;
+		}
+
+		XMFLOAT4 Screen[3];
+		for (UInt32 Vertex = 0; Vertex < 3; Vertex++)
+		{
+			const Float InvW = 1.0f / Clip[Vertex]->w;
+			Screen[Vertex].x = ((Clip[Vertex]->x * InvW) + 1.0f) * HalfWidth;
+			Screen[Vertex].y = (1.0f - (Clip[Vertex]->y * InvW)) * HalfHeight;
+			Screen[Vertex].z = std::max<Float>(Clip[Vertex]->z * InvW, 0.0f);
+			Screen[Vertex].w = 1.0f;
+		}
+
+		// Triangles that are huge on screen are usually very close to the nearplane, skip them instead of clipping
+		bool IsInsideGuardBand = true;
+		for (const XMFLOAT4& Vertex : Screen)
+		{
+			IsInsideGuardBand = IsInsideGuardBand &&
+				(Vertex.x >= -GuardBand) && (Vertex.x <= Float(Width) + GuardBand) &&
+				(Vertex.y >= -GuardBand) && (Vertex.y <= Float(Height) + GuardBand);
+		}
+
+		if (!IsInsideGuardBand)
+		{
+			continue;
+		}
+
+		RasterizeTriangle(Screen[0], Screen[1], Screen[2]);
+	}
+}
+
+void OcclusionBuffer::UpdateHierarchy()
+{
+	for (UInt32 TileY = 0; TileY < NumTilesY; TileY++)
+	{
+		for (UInt32 TileX = 0; TileX < NumTilesX; TileX++)
+		{
+			Float MaxDepth = 0.0f;
+			for (UInt32 y = 0; y < TileSize; y++)
+			{
+				const Float* Row = Depth.Data() + (((TileY * TileSize) + y) * Width) + (TileX * TileSize);
+				for (UInt32 x = 0; x < TileSize; x++)
+				{
+					MaxDepth = std::max<Float>(MaxDepth, Row[x]);
+				}
+			}
+
+			TileMaxDepth[(TileY * NumTilesX) + TileX] = MaxDepth;
+		}
+	}
+}
+
+bool OcclusionBuffer::IsVisible(const AABB& WorldBox) const
+{
+	const XMFLOAT3 Corners[8] =
+	{
+		XMFLOAT3(WorldBox.Bottom.x,	WorldBox.Bottom.y,	WorldBox.Bottom.z),
+		XMFLOAT3(WorldBox.Top.x,	WorldBox.Bottom.y,	WorldBox.Bottom.z),
+		XMFLOAT3(WorldBox.Bottom.x,	WorldBox.Top.y,		WorldBox.Bottom.z),
+		XMFLOAT3(WorldBox.Top.x,	WorldBox.Top.y,		WorldBox.Bottom.z),
+		XMFLOAT3(WorldBox.Bottom.x,	WorldBox.Bottom.y,	WorldBox.Top.z),
+		XMFLOAT3(WorldBox.Top.x,	WorldBox.Bottom.y,	WorldBox.Top.z),
+		XMFLOAT3(WorldBox.Bottom.x,	WorldBox.Top.y,		WorldBox.Top.z),
+		XMFLOAT3(WorldBox.Top.x,	WorldBox.Top.y,		WorldBox.Top.z),
+	};
+
+	Float MinX = std::numeric_limits<Float>::max();
+	Float MinY = std::numeric_limits<Float>::max();
+	Float MaxX = -std::numeric_limits<Float>::max();
+	Float MaxY = -std::numeric_limits<Float>::max();
+	Float MinZ = std::numeric_limits<Float>::max();
+	for (const XMFLOAT3& Corner : Corners)
+	{
+		const XMFLOAT4 Clip = TransformPoint(ViewProjection, Corner);
+		if (Clip.w < MinW)
+		{
+			// The box crosses the nearplane
+			return true;
+		}
+
+		const Float InvW	= 1.0f / Clip.w;
+		const Float ScreenX	= ((Clip.x * InvW) + 1.0f) * (Float(Width) * 0.5f);
+		const Float ScreenY	= (1.0f - (Clip.y * InvW)) * (Float(Height) * 0.5f);
+		MinX = std::min<Float>(MinX, ScreenX);
+		MaxX = std::max<Float>(MaxX, ScreenX);
+		MinY = std::min<Float>(MinY, ScreenY);
+		MaxY = std::max<Float>(MaxY, ScreenY);
+		MinZ = std::min<Float>(MinZ, Clip.z * InvW);
+	}
+
+	if (MinZ <= 0.0f)
+	{
+		return true;
+	}
+
+	// Boxes outside of the screen are left to the frustum culling
+	if (MaxX < 0.0f || MaxY < 0.0f || MinX >= Float(Width) || MinY >= Float(Height))
+	{
+		return true;
+	}
+
+	const UInt32 X0 = static_cast<UInt32>(std::max<Float>(MinX, 0.0f));
+	const UInt32 Y0 = static_cast<UInt32>(std::max<Float>(MinY, 0.0f));
+	const UInt32 X1 = static_cast<UInt32>(std::min<Float>(MaxX, Float(Width - 1)));
+	const UInt32 Y1 = static_cast<UInt32>(std::min<Float>(MaxY, Float(Height - 1)));
+
+	for (UInt32 TileY = Y0 / TileSize; TileY <= Y1 / TileSize; TileY++)
+	{
+		for (UInt32 TileX = X0 / TileSize; TileX <= X1 / TileSize; TileX++)
+		{
+			// The whole tile is closer than the box
+			if (TileMaxDepth[(TileY * NumTilesX) + TileX] <= MinZ)
+			{
+				continue;
+			}
+
+			const UInt32 StartX	= std::max<UInt32>(X0, TileX * TileSize);
+			const UInt32 EndX	= std::min<UInt32>(X1, (TileX * TileSize) + TileSize - 1);
+			const UInt32 StartY	= std::max<UInt32>(Y0, TileY * TileSize);
+			const UInt32 EndY	= std::min<UInt32>(Y1, (TileY * TileSize) + TileSize - 1);
+			for (UInt32 y = StartY; y <= EndY; y++)
+			{
+				const Float* Row = Depth.Data() + (y * Width);
+				for (UInt32 x = StartX; x <= EndX; x++)
+				{
+					if (Row[x] > MinZ)
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+void OcclusionBuffer::RasterizeTriangle(const XMFLOAT4& V0, const XMFLOAT4& V1, const XMFLOAT4& V2)
+{
+	// Snap to fixed point so that edges shared between triangles are evaluated exactly the same, otherwise there are holes
+	Int32 X0 = Int32(std::round(V0.x * SubPixelScale));
+	Int32 Y0 = Int32(std::round(V0.y * SubPixelScale));
+	Int32 X1 = Int32(std::round(V1.x * SubPixelScale));
+	Int32 Y1 = Int32(std::round(V1.y * SubPixelScale));
+	Int32 X2 = Int32(std::round(V2.x * SubPixelScale));
+	Int32 Y2 = Int32(std::round(V2.y * SubPixelScale));
+	Float Z0 = V0.z;
+	Float Z1 = V1.z;
+	Float Z2 = V2.z;
+
+	// Both windings are rasterized, make sure the area is positive
+	Int32 Area = ((X1 - X0) * (Y2 - Y0)) - ((Y1 - Y0) * (X2 - X0));
+	if (Area < 0)
+	{
+		std::swap(X1, X2);
+		std::swap(Y1, Y2);
+		std::swap(Z1, Z2);
+		Area = -Area;
+	}
+	else if (Area == 0)
+	{
+		return;
+	}
+
+	const Int32 MinX = std::max<Int32>(std::min<Int32>(X0, std::min<Int32>(X1, X2)) >> SubPixelBits, 0);
+	const Int32 MinY = std::max<Int32>(std::min<Int32>(Y0, std::min<Int32>(Y1, Y2)) >> SubPixelBits, 0);
+	const Int32 MaxX = std::min<Int32>(std::max<Int32>(X0, std::max<Int32>(X1, X2)) >> SubPixelBits, Int32(Width) - 1);
+	const Int32 MaxY = std::min<Int32>(std::max<Int32>(Y0, std::max<Int32>(Y1, Y2)) >> SubPixelBits, Int32(Height) - 1);
+	if (MinX > MaxX || MinY > MaxY)
+	{
+		return;
+	}
+
+	// Edge functions, each one is positive inside the triangle and equal to the area at the opposite vertex
+	const Int32 StepX0 = Y1 - Y2;
+	const Int32 StepY0 = X2 - X1;
+	const Int32 StepX1 = Y2 - Y0;
+	const Int32 StepY1 = X0 - X2;
+	const Int32 StepX2 = Y0 - Y1;
+	const Int32 StepY2 = X1 - X0;
+
+	// Edge increments when moving one pixel to the right
+	const Int32 PixelStepX0 = StepX0 << SubPixelBits;
+	const Int32 PixelStepX1 = StepX1 << SubPixelBits;
+	const Int32 PixelStepX2 = StepX2 << SubPixelBits;
+
+	// Depth is linear in screen space, the gradients are per pixel
+	const Float InvArea	= SubPixelScale / Float(Area);
+	const Float DepthDx	= ((Float(StepX1) * (Z1 - Z0)) + (Float(StepX2) * (Z2 - Z0))) * InvArea;
+	const Float DepthDy	= ((Float(StepY1) * (Z1 - Z0)) + (Float(StepY2) * (Z2 - Z0))) * InvArea;
+
+	// Start four aligned pixels at a time
+	const Int32 StartX		= MinX & ~3;
+	const Int32 HalfPixel	= 1 << (SubPixelBits - 1);
+	const Int32 StartPixelX	= (StartX << SubPixelBits) + HalfPixel;
+	for (Int32 y = MinY; y <= MaxY; y++)
+	{
+		const Int32 PixelY = (y << SubPixelBits) + HalfPixel;
+		Int32 Edge0 = (StepX0 * (StartPixelX - X1)) + (StepY0 * (PixelY - Y1));
+		Int32 Edge1 = (StepX1 * (StartPixelX - X2)) + (StepY1 * (PixelY - Y2));
+		Int32 Edge2 = (StepX2 * (StartPixelX - X0)) + (StepY2 * (PixelY - Y0));
+		Float PixelDepth = Z0 + (DepthDx * (Float(StartPixelX - X0) / SubPixelScale)) + (DepthDy * (Float(PixelY - Y0) / SubPixelScale));
+
+		Float* Row = Depth.Data() + (y * Width);
+
+#if OCCLUSION_BUFFER_USE_SSE
+		const __m128 Lanes	= _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		const __m128 Zero	= _mm_setzero_ps();
+		const __m128 One	= _mm_set1_ps(1.0f);
+
+		__m128i Edges0	= _mm_add_epi32(_mm_set1_epi32(Edge0), _mm_set_epi32(PixelStepX0 * 3, PixelStepX0 * 2, PixelStepX0, 0));
+		__m128i Edges1	= _mm_add_epi32(_mm_set1_epi32(Edge1), _mm_set_epi32(PixelStepX1 * 3, PixelStepX1 * 2, PixelStepX1, 0));
+		__m128i Edges2	= _mm_add_epi32(_mm_set1_epi32(Edge2), _mm_set_epi32(PixelStepX2 * 3, PixelStepX2 * 2, PixelStepX2, 0));
+		__m128 Depths	= _mm_add_ps(_mm_set1_ps(PixelDepth), _mm_mul_ps(Lanes, _mm_set1_ps(DepthDx)));
+
+		const __m128i EdgeStep0	= _mm_set1_epi32(PixelStepX0 * 4);
+		const __m128i EdgeStep1	= _mm_set1_epi32(PixelStepX1 * 4);
+		const __m128i EdgeStep2	= _mm_set1_epi32(PixelStepX2 * 4);
+		const __m128 DepthStep	= _mm_set1_ps(DepthDx * 4.0f);
+
+		for (Int32 x = StartX; x <= MaxX; x += 4)
+		{
+			// A pixel is inside when none of the edges has the sign bit set
+			const __m128i Outside	= _mm_srai_epi32(_mm_or_si128(_mm_or_si128(Edges0, Edges1), Edges2), 31);
+			const __m128 Inside		= _mm_castsi128_ps(_mm_xor_si128(Outside, _mm_set1_epi32(-1)));
+			if (_mm_movemask_ps(Inside) != 0)
+			{
+				const __m128 OldDepth	= _mm_loadu_ps(Row + x);
+				const __m128 NewDepth	= _mm_min_ps(OldDepth, _mm_min_ps(_mm_max_ps(Depths, Zero), One));
+				_mm_storeu_ps(Row + x, _mm_or_ps(_mm_and_ps(Inside, NewDepth), _mm_andnot_ps(Inside, OldDepth)));
+			}
+
+			Edges0	= _mm_add_epi32(Edges0, EdgeStep0);
+			Edges1	= _mm_add_epi32(Edges1, EdgeStep1);
+			Edges2	= _mm_add_epi32(Edges2, EdgeStep2);
+			Depths	= _mm_add_ps(Depths, DepthStep);
+		}
+#else
+		for (Int32 x = StartX; x <= MaxX; x++)
+		{
+			if ((Edge0 | Edge1 | Edge2) >= 0)
+			{
+				Row[x] = std::min<Float>(Row[x], std::min<Float>(std::max<Float>(PixelDepth, 0.0f), 1.0f));
+			}
+
+			Edge0		+= PixelStepX0;
+			Edge1		+= PixelStepX1;
+			Edge2		+= PixelStepX2;
+			PixelDepth	+= DepthDx;
+		}
+#endif
+	}
+}
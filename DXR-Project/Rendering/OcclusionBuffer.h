@@ -0,0 +1,59 @@
+#pragma once
+#include "Scene/AABB.h"
+
+/*
+* OcclusionBuffer - Low resolution depth buffer that occluders are rasterized into on the CPU. Each tile of 8x8 pixels stores
+* the farthest depth, so that boxes can be rejected without looking at each pixel. Depth is in the range [0, 1] where zero is
+* the nearplane. Does not depend on the RenderingAPI so it can be used without a device.
+*/
+
+class OcclusionBuffer
+{
+public:
+	static constexpr UInt32 TileSize = 8;
+
+	OcclusionBuffer();
+	~OcclusionBuffer() = default;
+
+	// Width and height are rounded up to a multiple of TileSize
+	void Initialize(UInt32 InWidth, UInt32 InHeight);
+
+	// Clears the depth and sets the ViewProjection matrix, which is expected to be transposed in the same way as the Camera's
+	void Clear(const XMFLOAT4X4& InViewProjection);
+
+	// Transform is the transposed world matrix of the occluder, triangles that cross the nearplane are skipped
+	void RasterizeOccluder(const XMFLOAT4X4& Transform, const XMFLOAT3* Positions, UInt32 NumPositions, const UInt32* Indices, UInt32 NumIndices);
+
+	// Must be called after all occluders have been rasterized and before IsVisible
+	void UpdateHierarchy();
+
+	// Conservative test of a world space box, threadsafe after UpdateHierarchy
+	bool IsVisible(const AABB& WorldBox) const;
+
+	FORCEINLINE UInt32 GetWidth() const
+	{
+		return Width;
+	}
+
+	FORCEINLINE UInt32 GetHeight() const
+	{
+		return Height;
+	}
+
+	FORCEINLINE const Float* GetDepthData() const
+	{
+		return Depth.Data();
+	}
+
+private:
+	void RasterizeTriangle(const XMFLOAT4& V0, const XMFLOAT4& V1, const XMFLOAT4& V2);
+
+	TArray<Float> Depth;
+	TArray<Float> TileMaxDepth;
+	TArray<XMFLOAT4> TransformedVertices;
+	XMFLOAT4X4 ViewProjection;
+	UInt32 Width		= 0;
+	UInt32 Height		= 0;
+	UInt32 NumTilesX	= 0;
+	UInt32 NumTilesY	= 0;
+};
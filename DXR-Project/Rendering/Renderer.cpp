@@ -4,6 +4,7 @@
 #include "Mesh.h"
 
 #include "Scene/Frustum.h"
+#include "Scene/Components/MeshComponent.h"
 #include "Scene/Lights/PointLight.h"
 #include "Scene/Lights/DirectionalLight.h"
 
@@ -17,6 +18,11 @@
 
 #include "Application/Events/EventQueue.h"
 
+#include "Core/JobSystem.h"
+
+#include "Containers/TInlineArray.h"
+#include "Containers/TFrameArray.h"
+
 #include <algorithm>
 
 /*
@@ -39,6 +45,30 @@ static const UInt32			ShadowMapSampleCount	= 2;
 #define GBUFFER_MATERIAL_INDEX		2
 #define GBUFFER_DEPTH_INDEX			3
 
+// Layout of the vertexbuffers of meshes, see Vertex and PackedVertex
+#if ENABLE_PACKED_VERTICES
+static D3D12_INPUT_ELEMENT_DESC MeshInputElementDesc[] =
+{
+	{ "POSITION",	0, DXGI_FORMAT_R16G16B16A16_SNORM,	0, 0,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",		0, DXGI_FORMAT_R16G16_SNORM,		0, 8,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TANGENT",	0, DXGI_FORMAT_R16G16_SNORM,		0, 12,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD",	0, DXGI_FORMAT_R16G16_FLOAT,		0, 16,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+};
+
+// The quantization is sent after the transform of each object
+static const UInt32 NumQuantizationConstants = sizeof(VertexQuantization) / sizeof(UInt32);
+#else
+static D3D12_INPUT_ELEMENT_DESC MeshInputElementDesc[] =
+{
+	{ "POSITION",	0, DXGI_FORMAT_R32G32B32_FLOAT,		0, 0,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",		0, DXGI_FORMAT_R32G32B32_FLOAT,		0, 12,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TANGENT",	0, DXGI_FORMAT_R32G32B32A32_FLOAT,	0, 24,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD",	0, DXGI_FORMAT_R32G32_FLOAT,		0, 40,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+};
+
+static const UInt32 NumQuantizationConstants = 0;
+#endif
+
 /*
 * Renderer
 */
@@ -65,53 +95,9 @@ void Renderer::Tick(const Scene& CurrentScene)
 	}
 	DeferredResources.Clear();
 
-	// Perform frustum culling
-	DeferredVisibleCommands.Clear();
-	ForwardVisibleCommands.Clear();
-
-	if (FrustumCullEnabled)
-	{
-		Camera* Camera = CurrentScene.GetCamera();
-		Frustum CameraFrustum = Frustum(Camera->GetFarPlane(), Camera->GetViewMatrix(), Camera->GetProjectionMatrix());
-		for (const MeshDrawCommand& Command : CurrentScene.GetMeshDrawCommands())
-		{
-			const XMFLOAT4X4& Transform = Command.CurrentActor->GetTransform().GetMatrix();
-			XMMATRIX XmTransform	= XMMatrixTranspose(XMLoadFloat4x4(&Transform));
-			XMVECTOR XmTop			= XMVectorSetW(XMLoadFloat3(&Command.Mesh->BoundingBox.Top), 1.0f);
-			XMVECTOR XmBottom		= XMVectorSetW(XMLoadFloat3(&Command.Mesh->BoundingBox.Bottom), 1.0f);
-			XmTop		= XMVector4Transform(XmTop, XmTransform);
-			XmBottom	= XMVector4Transform(XmBottom, XmTransform);
-
-			AABB Box;
-			XMStoreFloat3(&Box.Top, XmTop);
-			XMStoreFloat3(&Box.Bottom, XmBottom);
-			if (CameraFrustum.CheckAABB(Box))
-			{
-				if (Command.Material->HasAlphaMask())
-				{
-					ForwardVisibleCommands.EmplaceBack(Command);
-				}
-				else
-				{
-					DeferredVisibleCommands.EmplaceBack(Command);
-				}
-			}
-		}
-	}
-	else
-	{
-		for (const MeshDrawCommand& Command : CurrentScene.GetMeshDrawCommands())
-		{
-			if (Command.Material->HasAlphaMask())
-			{
-				ForwardVisibleCommands.EmplaceBack(Command);
-			}
-			else
-			{
-				DeferredVisibleCommands.EmplaceBack(Command);
-			}
-		}
-	}
+	// Select LODs and perform frustum culling
+	SelectLODs(CurrentScene);
+	PerformFrustumCulling(CurrentScene);
 
 	// Build acceleration structures
 	if (RenderingAPI::Get().IsRayTracingSupported() && RayTracingEnabled)
@@ -125,16 +111,27 @@ void Renderer::Tick(const Scene& CurrentScene)
 				Command.Mesh->VertexBuffer,
 				Command.Mesh->VertexCount,
 				Command.Mesh->IndexBuffer,
-				Command.Mesh->IndexCount);
-
-			XMFLOAT4X4 Matrix		= Command.CurrentActor->GetTransform().GetMatrix();
-			XMFLOAT3X4 SmallMatrix	= XMFLOAT3X4(reinterpret_cast<Float*>(&Matrix));
+				Command.Mesh->IndexCount,
+				Command.Mesh->IndexFormat);
+
+			XMFLOAT4X4 Matrix = Command.CurrentActor->GetTransform().GetMatrix();
+#if ENABLE_PACKED_VERTICES
+			// The acceleration structure is built from the quantized positions
+			const VertexQuantization& Quantization = Command.Mesh->Quantization;
+			XMMATRIX Dequantize = XMMatrixMultiply(
+				XMMatrixScaling(Quantization.Scale.x, Quantization.Scale.y, Quantization.Scale.z),
+				XMMatrixTranslation(Quantization.Offset.x, Quantization.Offset.y, Quantization.Offset.z));
+			XMStoreFloat4x4(&Matrix, XMMatrixMultiply(XMLoadFloat4x4(&Matrix), XMMatrixTranspose(Dequantize)));
+#endif
+			XMFLOAT3X4 SmallMatrix = XMFLOAT3X4(reinterpret_cast<Float*>(&Matrix));
 
+			// The hitshader reads the size of the indices from the InstanceID
 			RayTracingGeometryInstances.EmplaceBack(
 				Command.Mesh->RayTracingGeometry,
 				Command.Material,
 				SmallMatrix,
-				HitGroupIndex, 0);
+				HitGroupIndex,
+				Command.Mesh->GetIndexStride());
 
 			HitGroupIndex++;
 		}
@@ -172,8 +169,9 @@ void Renderer::Tick(const Scene& CurrentScene)
 	CommandList->TransitionBarrier(PointLightBuffer.Get(), D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, D3D12_RESOURCE_STATE_COPY_DEST);
 	CommandList->TransitionBarrier(DirectionalLightBuffer.Get(), D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, D3D12_RESOURCE_STATE_COPY_DEST);
 
-	UInt32 NumPointLights	= 0;
-	UInt32 NumDirLights		= 0;
+	// Scenes only have a few lights, the properties are gathered and uploaded with one copy per buffer
+	TInlineArray<PointLightProperties, 4>		PointLights;
+	TInlineArray<DirectionalLightProperties, 4>	DirLights;
 	for (Light* Light : CurrentScene.GetLights())
 	{
 		XMFLOAT3	Color		= Light->GetColor();
@@ -183,35 +181,35 @@ void Renderer::Tick(const Scene& CurrentScene)
 			PointLight* PoiLight = Cast<PointLight>(Light);
 			VALIDATE(PoiLight != nullptr);
 
-			PointLightProperties Properties;
+			PointLightProperties& Properties = PointLights.EmplaceBack();
 			Properties.Color			= XMFLOAT3(Color.x * Intensity, Color.y * Intensity, Color.z * Intensity);
 			Properties.Position			= PoiLight->GetPosition();
 			Properties.ShadowBias		= PoiLight->GetShadowBias();
 			Properties.MaxShadowBias	= PoiLight->GetMaxShadowBias();
 			Properties.FarPlane			= PoiLight->GetShadowFarPlane();
-
-			constexpr UInt32 SizeInBytes = sizeof(PointLightProperties);
-			CommandList->UploadBufferData(PointLightBuffer.Get(), NumPointLights * SizeInBytes, &Properties, SizeInBytes);
-
-			NumPointLights++;
 		}
 		else if (IsSubClassOf<DirectionalLight>(Light))
 		{
 			DirectionalLight* DirLight = Cast<DirectionalLight>(Light);
 			VALIDATE(DirLight != nullptr);
 
-			DirectionalLightProperties Properties;
+			DirectionalLightProperties& Properties = DirLights.EmplaceBack();
 			Properties.Color			= XMFLOAT3(Color.x * Intensity, Color.y * Intensity, Color.z * Intensity);
 			Properties.ShadowBias		= DirLight->GetShadowBias();
 			Properties.Direction		= DirLight->GetDirection();
 			Properties.LightMatrix		= DirLight->GetMatrix();
 			Properties.MaxShadowBias	= DirLight->GetMaxShadowBias();
+		}
+	}
 
-			constexpr UInt32 SizeInBytes = sizeof(DirectionalLightProperties);
-			CommandList->UploadBufferData(DirectionalLightBuffer.Get(), NumDirLights * SizeInBytes, &Properties, SizeInBytes);
+	if (!PointLights.IsEmpty())
+	{
+		CommandList->UploadBufferData(PointLightBuffer.Get(), 0, PointLights.Data(), PointLights.Size() * sizeof(PointLightProperties));
+	}
 
-			NumDirLights++;
-		}
+	if (!DirLights.IsEmpty())
+	{
+		CommandList->UploadBufferData(DirectionalLightBuffer.Get(), 0, DirLights.Data(), DirLights.Size() * sizeof(DirectionalLightProperties));
 	}
 
 	CommandList->TransitionBarrier(PointLightBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
@@ -275,6 +273,9 @@ void Renderer::Tick(const Scene& CurrentScene)
 	struct ShadowPerObject
 	{
 		XMFLOAT4X4 Matrix;
+#if ENABLE_PACKED_VERTICES
+		VertexQuantization Quantization;
+#endif
 		Float ShadowOffset;
 	} ShadowPerObjectBuffer;
 
@@ -298,21 +299,24 @@ void Renderer::Tick(const Scene& CurrentScene)
 			CommandList->SetGraphicsRoot32BitConstants(&PerLightBuffer, 20, 0, 1);
 
 			// Draw all objects to depthbuffer
-			for (const MeshDrawCommand& Command : CurrentScene.GetMeshDrawCommands())
+			for (const MeshDrawCommand& Command : LODCommands)
 			{
 				VBO.BufferLocation	= Command.VertexBuffer->GetGPUVirtualAddress();
 				VBO.SizeInBytes		= Command.VertexBuffer->GetSizeInBytes();
-				VBO.StrideInBytes	= sizeof(Vertex);
+				VBO.StrideInBytes	= Command.Mesh->VertexStride;
 				CommandList->IASetVertexBuffers(0, &VBO, 1);
 
 				IBV.BufferLocation	= Command.IndexBuffer->GetGPUVirtualAddress();
 				IBV.SizeInBytes		= Command.IndexBuffer->GetSizeInBytes();
-				IBV.Format			= DXGI_FORMAT_R32_UINT;
+				IBV.Format			= Command.Mesh->IndexFormat;
 				CommandList->IASetIndexBuffer(&IBV);
 
 				ShadowPerObjectBuffer.Matrix		= Command.CurrentActor->GetTransform().GetMatrix();
 				ShadowPerObjectBuffer.ShadowOffset	= Command.Mesh->ShadowOffset;
-				CommandList->SetGraphicsRoot32BitConstants(&ShadowPerObjectBuffer, 17, 0, 0);
+#if ENABLE_PACKED_VERTICES
+				ShadowPerObjectBuffer.Quantization	= Command.Mesh->Quantization;
+#endif
+				CommandList->SetGraphicsRoot32BitConstants(&ShadowPerObjectBuffer, 17 + NumQuantizationConstants, 0, 0);
 
 				CommandList->DrawIndexedInstanced(Command.IndexCount, 1, 0, 0, 0);
 			}
@@ -356,62 +360,28 @@ void Renderer::Tick(const Scene& CurrentScene)
 				PerLightBuffer.FarPlane	= PoiLight->GetShadowFarPlane();
 				CommandList->SetGraphicsRoot32BitConstants(&PerLightBuffer, 20, 0, 1);
 
-				// Draw all objects to depthbuffer
-				if (FrustumCullEnabled)
+				// Draw all visible objects to depthbuffer
+				const TArray<MeshDrawCommand>& VisibleCommands = FrustumCullEnabled ? PointLightVisibleCommands[I] : LODCommands;
+				for (const MeshDrawCommand& Command : VisibleCommands)
 				{
-					Frustum CameraFrustum = Frustum(PoiLight->GetShadowFarPlane(), PoiLight->GetViewMatrix(I), PoiLight->GetProjectionMatrix(I));
-					for (const MeshDrawCommand& Command : CurrentScene.GetMeshDrawCommands())
-					{
-						const XMFLOAT4X4& Transform = Command.CurrentActor->GetTransform().GetMatrix();
-						XMMATRIX XmTransform	= XMMatrixTranspose(XMLoadFloat4x4(&Transform));
-						XMVECTOR XmTop			= XMVectorSetW(XMLoadFloat3(&Command.Mesh->BoundingBox.Top), 1.0f);
-						XMVECTOR XmBottom		= XMVectorSetW(XMLoadFloat3(&Command.Mesh->BoundingBox.Bottom), 1.0f);
-						XmTop		= XMVector4Transform(XmTop, XmTransform);
-						XmBottom	= XMVector4Transform(XmBottom, XmTransform);
-
-						AABB Box;
-						XMStoreFloat3(&Box.Top, XmTop);
-						XMStoreFloat3(&Box.Bottom, XmBottom);
-						if (CameraFrustum.CheckAABB(Box))
-						{
-							VBO.BufferLocation	= Command.VertexBuffer->GetGPUVirtualAddress();
-							VBO.SizeInBytes		= Command.VertexBuffer->GetSizeInBytes();
-							VBO.StrideInBytes	= sizeof(Vertex);
-							CommandList->IASetVertexBuffers(0, &VBO, 1);
-
-							IBV.BufferLocation	= Command.IndexBuffer->GetGPUVirtualAddress();
-							IBV.SizeInBytes		= Command.IndexBuffer->GetSizeInBytes();
-							IBV.Format			= DXGI_FORMAT_R32_UINT;
-							CommandList->IASetIndexBuffer(&IBV);
-
-							ShadowPerObjectBuffer.Matrix		= Command.CurrentActor->GetTransform().GetMatrix();
-							ShadowPerObjectBuffer.ShadowOffset	= Command.Mesh->ShadowOffset;
-							CommandList->SetGraphicsRoot32BitConstants(&ShadowPerObjectBuffer, 17, 0, 0);
-
-							CommandList->DrawIndexedInstanced(Command.IndexCount, 1, 0, 0, 0);
-						}
-					}
-				}
-				else
-				{
-					for (const MeshDrawCommand& Command : CurrentScene.GetMeshDrawCommands())
-					{
-						VBO.BufferLocation	= Command.VertexBuffer->GetGPUVirtualAddress();
-						VBO.SizeInBytes		= Command.VertexBuffer->GetSizeInBytes();
-						VBO.StrideInBytes	= sizeof(Vertex);
-						CommandList->IASetVertexBuffers(0, &VBO, 1);
-
-						IBV.BufferLocation	= Command.IndexBuffer->GetGPUVirtualAddress();
-						IBV.SizeInBytes		= Command.IndexBuffer->GetSizeInBytes();
-						IBV.Format			= DXGI_FORMAT_R32_UINT;
-						CommandList->IASetIndexBuffer(&IBV);
-
-						ShadowPerObjectBuffer.Matrix		= Command.CurrentActor->GetTransform().GetMatrix();
-						ShadowPerObjectBuffer.ShadowOffset	= Command.Mesh->ShadowOffset;
-						CommandList->SetGraphicsRoot32BitConstants(&ShadowPerObjectBuffer, 17, 0, 0);
-
-						CommandList->DrawIndexedInstanced(Command.IndexCount, 1, 0, 0, 0);
-					}
+					VBO.BufferLocation	= Command.VertexBuffer->GetGPUVirtualAddress();
+					VBO.SizeInBytes		= Command.VertexBuffer->GetSizeInBytes();
+					VBO.StrideInBytes	= Command.Mesh->VertexStride;
+					CommandList->IASetVertexBuffers(0, &VBO, 1);
+
+					IBV.BufferLocation	= Command.IndexBuffer->GetGPUVirtualAddress();
+					IBV.SizeInBytes		= Command.IndexBuffer->GetSizeInBytes();
+					IBV.Format			= Command.Mesh->IndexFormat;
+					CommandList->IASetIndexBuffer(&IBV);
+
+					ShadowPerObjectBuffer.Matrix		= Command.CurrentActor->GetTransform().GetMatrix();
+					ShadowPerObjectBuffer.ShadowOffset	= Command.Mesh->ShadowOffset;
+#if ENABLE_PACKED_VERTICES
+					ShadowPerObjectBuffer.Quantization	= Command.Mesh->Quantization;
+#endif
+					CommandList->SetGraphicsRoot32BitConstants(&ShadowPerObjectBuffer, 17 + NumQuantizationConstants, 0, 0);
+
+					CommandList->DrawIndexedInstanced(Command.IndexCount, 1, 0, 0, 0);
 				}
 			}
 
@@ -487,6 +457,9 @@ void Renderer::Tick(const Scene& CurrentScene)
 		struct PerObject
 		{
 			XMFLOAT4X4 Matrix;
+#if ENABLE_PACKED_VERTICES
+			VertexQuantization Quantization;
+#endif
 		} PerObjectBuffer;
 
 		// Setup Pipeline
@@ -497,22 +470,30 @@ void Renderer::Tick(const Scene& CurrentScene)
 		CommandList->SetGraphicsRootDescriptorTable(PrePassDescriptorTable->GetGPUTableStartHandle(), 1);
 
 		// Draw all objects to depthbuffer
-		for (const MeshDrawCommand& Command : DeferredVisibleCommands)
+		for (UInt32 CommandIndex = 0; CommandIndex < DeferredVisibleCommands.Size(); CommandIndex++)
 		{
+			const MeshDrawCommand& Command = DeferredVisibleCommands[CommandIndex];
+
 			VBO.BufferLocation	= Command.VertexBuffer->GetGPUVirtualAddress();
 			VBO.SizeInBytes		= Command.VertexBuffer->GetSizeInBytes();
-			VBO.StrideInBytes	= sizeof(Vertex);
+			VBO.StrideInBytes	= Command.Mesh->VertexStride;
 			CommandList->IASetVertexBuffers(0, &VBO, 1);
 
 			IBV.BufferLocation	= Command.IndexBuffer->GetGPUVirtualAddress();
 			IBV.SizeInBytes		= Command.IndexBuffer->GetSizeInBytes();
-			IBV.Format			= DXGI_FORMAT_R32_UINT;
+			IBV.Format			= Command.Mesh->IndexFormat;
 			CommandList->IASetIndexBuffer(&IBV);
 
 			PerObjectBuffer.Matrix = Command.CurrentActor->GetTransform().GetMatrix();
-			CommandList->SetGraphicsRoot32BitConstants(&PerObjectBuffer, 16, 0, 0);
+#if ENABLE_PACKED_VERTICES
+			PerObjectBuffer.Quantization = Command.Mesh->Quantization;
+#endif
+			CommandList->SetGraphicsRoot32BitConstants(&PerObjectBuffer, 16 + NumQuantizationConstants, 0, 0);
 
-			CommandList->DrawIndexedInstanced(Command.IndexCount, 1, 0, 0, 0);
+			for (const MeshletDrawRange& Range : DeferredDrawRanges[CommandIndex])
+			{
+				CommandList->DrawIndexedInstanced(Range.IndexCount, 1, Range.IndexOffset, 0, 0);
+			}
 		}
 	}
 
@@ -535,18 +516,23 @@ void Renderer::Tick(const Scene& CurrentScene)
 	{
 		XMFLOAT4X4 Transform;
 		XMFLOAT4X4 TransformInv;
+#if ENABLE_PACKED_VERTICES
+		VertexQuantization Quantization;
+#endif
 	} TransformPerObject;
 
-	for (const MeshDrawCommand& Command : DeferredVisibleCommands)
+	for (UInt32 CommandIndex = 0; CommandIndex < DeferredVisibleCommands.Size(); CommandIndex++)
 	{
+		const MeshDrawCommand& Command = DeferredVisibleCommands[CommandIndex];
+
 		VBO.BufferLocation	= Command.VertexBuffer->GetGPUVirtualAddress();
 		VBO.SizeInBytes		= Command.VertexBuffer->GetSizeInBytes();
-		VBO.StrideInBytes	= sizeof(Vertex);
+		VBO.StrideInBytes	= Command.Mesh->VertexStride;
 		CommandList->IASetVertexBuffers(0, &VBO, 1);
 
 		IBV.BufferLocation	= Command.IndexBuffer->GetGPUVirtualAddress();
 		IBV.SizeInBytes		= Command.IndexBuffer->GetSizeInBytes();
-		IBV.Format			= DXGI_FORMAT_R32_UINT;
+		IBV.Format			= Command.Mesh->IndexFormat;
 		CommandList->IASetIndexBuffer(&IBV);
 
 		if (Command.Material->IsBufferDirty())
@@ -557,9 +543,15 @@ void Renderer::Tick(const Scene& CurrentScene)
 
 		TransformPerObject.Transform	= Command.CurrentActor->GetTransform().GetMatrix();
 		TransformPerObject.TransformInv	= Command.CurrentActor->GetTransform().GetMatrixInverse();
-		CommandList->SetGraphicsRoot32BitConstants(&TransformPerObject, 32, 0, 0);
+#if ENABLE_PACKED_VERTICES
+		TransformPerObject.Quantization	= Command.Mesh->Quantization;
+#endif
+		CommandList->SetGraphicsRoot32BitConstants(&TransformPerObject, 32 + NumQuantizationConstants, 0, 0);
 
-		CommandList->DrawIndexedInstanced(Command.IndexCount, 1, 0, 0, 0);
+		for (const MeshletDrawRange& Range : DeferredDrawRanges[CommandIndex])
+		{
+			CommandList->DrawIndexedInstanced(Range.IndexCount, 1, Range.IndexOffset, 0, 0);
+		}
 	}
 
 	// Setup GBuffer for Read
@@ -744,12 +736,12 @@ void Renderer::Tick(const Scene& CurrentScene)
 	{
 		VBO.BufferLocation	= Command.VertexBuffer->GetGPUVirtualAddress();
 		VBO.SizeInBytes		= Command.VertexBuffer->GetSizeInBytes();
-		VBO.StrideInBytes	= sizeof(Vertex);
+		VBO.StrideInBytes	= Command.Mesh->VertexStride;
 		CommandList->IASetVertexBuffers(0, &VBO, 1);
 
 		IBV.BufferLocation	= Command.IndexBuffer->GetGPUVirtualAddress();
 		IBV.SizeInBytes		= Command.IndexBuffer->GetSizeInBytes();
-		IBV.Format			= DXGI_FORMAT_R32_UINT;
+		IBV.Format			= Command.Mesh->IndexFormat;
 		CommandList->IASetIndexBuffer(&IBV);
 
 		if (Command.Material->IsBufferDirty())
@@ -760,7 +752,10 @@ void Renderer::Tick(const Scene& CurrentScene)
 
 		TransformPerObject.Transform	= Command.CurrentActor->GetTransform().GetMatrix();
 		TransformPerObject.TransformInv	= Command.CurrentActor->GetTransform().GetMatrixInverse();
-		CommandList->SetGraphicsRoot32BitConstants(&TransformPerObject, 32, 0, 0);
+#if ENABLE_PACKED_VERTICES
+		TransformPerObject.Quantization	= Command.Mesh->Quantization;
+#endif
+		CommandList->SetGraphicsRoot32BitConstants(&TransformPerObject, 32 + NumQuantizationConstants, 0, 0);
 
 		CommandList->DrawIndexedInstanced(Command.IndexCount, 1, 0, 0, 0);
 	}
@@ -806,7 +801,7 @@ void Renderer::Tick(const Scene& CurrentScene)
 	}
 
 	// Render UI
-	DebugUI::DrawDebugString("DrawCall Count: " + std::to_string(CommandList->GetNumDrawCalls()));
+	DebugUI::DrawDebugString("DrawCall Count: %u", CommandList->GetNumDrawCalls());
 	DebugUI::Render(CommandList.Get());
 
 	// Finalize Commandlist
@@ -831,6 +826,335 @@ void Renderer::Tick(const Scene& CurrentScene)
 	}
 }
 
+void Renderer::SelectLODs(const Scene& CurrentScene)
+{
+	// A LOD can be used when its error projected onto the screen is less than this many pixels
+	constexpr Float MaxPixelError = 1.0f;
+
+	const TArray<MeshDrawCommand>& Commands	= CurrentScene.GetMeshDrawCommands();
+	const AABBList& WorldBounds				= CurrentScene.GetWorldBounds();
+	LODCommands.Resize(Commands.Size());
+
+	Camera* Camera = CurrentScene.GetCamera();
+	const XMFLOAT3 CameraPosition = Camera->GetPosition();
+
+	// Pixels per unit at distance one
+	const Float PixelScale = Camera->GetProjectionMatrix()._22 * 0.5f * static_cast<Float>(RenderingAPI::Get().GetSwapChain()->GetHeight());
+
+	ParallelFor(Commands.Size(), [&](UInt32 Index)
+	{
+		MeshDrawCommand& Command = LODCommands[Index];
+		Command = Commands[Index];
+		if (!LODEnabled || !Command.Component || Command.Component->LODs.IsEmpty())
+		{
+			return;
+		}
+
+		// Distance to the closest point of the bounding sphere
+		const Float DeltaX = WorldBounds.CenterX[Index] - CameraPosition.x;
+		const Float DeltaY = WorldBounds.CenterY[Index] - CameraPosition.y;
+		const Float DeltaZ = WorldBounds.CenterZ[Index] - CameraPosition.z;
+		const Float Radius		= sqrtf((WorldBounds.ExtentX[Index] * WorldBounds.ExtentX[Index]) + (WorldBounds.ExtentY[Index] * WorldBounds.ExtentY[Index]) + (WorldBounds.ExtentZ[Index] * WorldBounds.ExtentZ[Index]));
+		const Float Distance	= sqrtf((DeltaX * DeltaX) + (DeltaY * DeltaY) + (DeltaZ * DeltaZ)) - Radius;
+		if (Distance <= 0.0f)
+		{
+			return;
+		}
+
+		XMMATRIX Transform = XMMatrixTranspose(XMLoadFloat4x4(&Command.CurrentActor->GetTransform().GetMatrix()));
+		const Float Scale = std::max<Float>(
+			XMVectorGetX(XMVector3Length(Transform.r[0])),
+			std::max<Float>(XMVectorGetX(XMVector3Length(Transform.r[1])), XMVectorGetX(XMVector3Length(Transform.r[2]))));
+
+		Mesh* SelectedMesh = nullptr;
+		for (const TSharedPtr<Mesh>& LOD : Command.Component->LODs)
+		{
+			if (LOD->LODError * Scale * PixelScale > MaxPixelError * Distance)
+			{
+				break;
+			}
+
+			SelectedMesh = LOD.Get();
+		}
+
+		// The raytracing geometry is always the full mesh
+		if (SelectedMesh)
+		{
+			Command.Mesh			= SelectedMesh;
+			Command.VertexBuffer	= SelectedMesh->VertexBuffer.Get();
+			Command.VertexCount		= SelectedMesh->VertexCount;
+			Command.IndexBuffer		= SelectedMesh->IndexBuffer.Get();
+			Command.IndexCount		= SelectedMesh->IndexCount;
+		}
+	}, 64);
+}
+
+void Renderer::PerformFrustumCulling(const Scene& CurrentScene)
+{
+	DeferredVisibleCommands.Clear();
+	ForwardVisibleCommands.Clear();
+	for (UInt32 Face = 0; Face < 6; Face++)
+	{
+		PointLightVisibleCommands[Face].Clear();
+	}
+
+	const TArray<MeshDrawCommand>& Commands = LODCommands;
+	if (!FrustumCullEnabled)
+	{
+		for (const MeshDrawCommand& Command : Commands)
+		{
+			if (Command.Material->HasAlphaMask())
+			{
+				ForwardVisibleCommands.EmplaceBack(Command);
+			}
+			else
+			{
+				DeferredVisibleCommands.EmplaceBack(Command);
+			}
+		}
+
+		PerformClusterCulling(CurrentScene, nullptr);
+		return;
+	}
+
+	// The camera is view zero, followed by the faces of the shadow casting pointlight
+	Frustum ViewFrustums[7];
+	UInt32 NumViews = 1;
+
+	Camera* Camera = CurrentScene.GetCamera();
+	ViewFrustums[0].Create(Camera->GetFarPlane(), Camera->GetViewMatrix(), Camera->GetProjectionMatrix());
+
+	for (Light* Light : CurrentScene.GetLights())
+	{
+		if (IsSubClassOf<PointLight>(Light))
+		{
+			PointLight* PoiLight = Cast<PointLight>(Light);
+			for (UInt32 Face = 0; Face < 6; Face++)
+			{
+				ViewFrustums[NumViews++].Create(PoiLight->GetShadowFarPlane(), PoiLight->GetViewMatrix(Face), PoiLight->GetProjectionMatrix(Face));
+			}
+
+			break;
+		}
+	}
+
+	// Cull each view in parallel, views that have not changed only test the commands that moved
+	ParallelFor(NumViews, [&](UInt32 View)
+	{
+		VisibilityCaches[View].Cull(CurrentScene, ViewFrustums[View], VisibleCommandIndices[View]);
+	}, 1);
+
+	UInt32 NumCacheHits		= 0;
+	UInt32 NumCacheMisses	= 0;
+	for (UInt32 View = 0; View < NumViews; View++)
+	{
+		NumCacheHits	+= VisibilityCaches[View].GetNumHits();
+		NumCacheMisses	+= VisibilityCaches[View].GetNumMisses();
+	}
+
+	DebugUI::DrawDebugString("Visibility Cache Hits: %u, Misses: %u", NumCacheHits, NumCacheMisses);
+
+	if (OcclusionCullEnabled)
+	{
+		PerformOcclusionCulling(CurrentScene);
+	}
+
+	for (UInt32 Index : VisibleCommandIndices[0])
+	{
+		const MeshDrawCommand& Command = Commands[Index];
+		if (Command.Material->HasAlphaMask())
+		{
+			ForwardVisibleCommands.EmplaceBack(Command);
+		}
+		else
+		{
+			DeferredVisibleCommands.EmplaceBack(Command);
+		}
+	}
+
+	for (UInt32 View = 1; View < NumViews; View++)
+	{
+		TArray<MeshDrawCommand>& FaceCommands = PointLightVisibleCommands[View - 1];
+		for (UInt32 Index : VisibleCommandIndices[View])
+		{
+			FaceCommands.EmplaceBack(Commands[Index]);
+		}
+	}
+
+	PerformClusterCulling(CurrentScene, &ViewFrustums[0]);
+}
+
+void Renderer::PerformClusterCulling(const Scene& CurrentScene, const Frustum* CameraFrustum)
+{
+	const UInt32 NumCommands = DeferredVisibleCommands.Size();
+	DeferredDrawRanges.Resize(NumCommands);
+	for (TArray<MeshletDrawRange>& Ranges : DeferredDrawRanges)
+	{
+		Ranges.Clear();
+	}
+
+	// Without culling the whole mesh is drawn
+	if (!CameraFrustum || !ClusterCullEnabled)
+	{
+		for (UInt32 CommandIndex = 0; CommandIndex < NumCommands; CommandIndex++)
+		{
+			MeshletDrawRange& Range = DeferredDrawRanges[CommandIndex].EmplaceBack();
+			Range.IndexOffset	= 0;
+			Range.IndexCount	= DeferredVisibleCommands[CommandIndex].IndexCount;
+		}
+
+		return;
+	}
+
+	const XMFLOAT3 CameraPosition = CurrentScene.GetCamera()->GetPosition();
+
+	TFrameArray<ClusterCullStatistics> ClusterStatistics;
+	ClusterStatistics.Resize(NumCommands);
+	ParallelFor(NumCommands, [&](UInt32 CommandIndex)
+	{
+		const MeshDrawCommand& Command = DeferredVisibleCommands[CommandIndex];
+		CullMeshlets(
+			Command.Mesh->Meshlets,
+			Command.CurrentActor->GetTransform().GetMatrix(),
+			*CameraFrustum,
+			CameraPosition,
+			DeferredDrawRanges[CommandIndex],
+			ClusterStatistics[CommandIndex]);
+	}, 4);
+
+	// Remove the commands where all meshlets were culled
+	ClusterCullStatistics TotalStatistics;
+	UInt32 NumVisible = 0;
+	for (UInt32 CommandIndex = 0; CommandIndex < NumCommands; CommandIndex++)
+	{
+		TotalStatistics.Add(ClusterStatistics[CommandIndex]);
+		if (!DeferredDrawRanges[CommandIndex].IsEmpty())
+		{
+			if (NumVisible != CommandIndex)
+			{
+				DeferredVisibleCommands[NumVisible] = DeferredVisibleCommands[CommandIndex];
+				DeferredDrawRanges[NumVisible].Swap(DeferredDrawRanges[CommandIndex]);
+			}
+
+			NumVisible++;
+		}
+	}
+
+	DeferredVisibleCommands.Resize(NumVisible);
+	DeferredDrawRanges.Resize(NumVisible);
+
+	DebugUI::DrawDebugString("Meshlets Visible: %u / %u", TotalStatistics.NumVisibleMeshlets, TotalStatistics.NumMeshlets);
+	DebugUI::DrawDebugString("Triangles Rejected: %u (Frustum), %u (Backface) of %u", TotalStatistics.NumFrustumTriangles, TotalStatistics.NumBackfaceTriangles, TotalStatistics.NumTriangles);
+}
+
+void Renderer::PerformOcclusionCulling(const Scene& CurrentScene)
+{
+	// Occluders are picked from the largest objects on screen until the budget is used
+	constexpr UInt32 MaxOccluders			= 64;
+	constexpr UInt32 MaxOccluderTriangles	= 100000;
+	constexpr Float MinOccluderScreenSize	= 0.01f;
+
+	OcclusionClock.Tick();
+
+	const TArray<MeshDrawCommand>& Commands	= LODCommands;
+	const AABBList& WorldBounds				= CurrentScene.GetWorldBounds();
+	TArray<UInt32>& CameraVisible			= VisibleCommandIndices[0];
+
+	Camera* Camera = CurrentScene.GetCamera();
+	const XMFLOAT3 CameraPosition = Camera->GetPosition();
+
+	// Squared extent over squared distance, boxes that contain the camera are the largest possible
+	auto GetScreenSize = [&](UInt32 Position) -> Float
+	{
+		const UInt32 Index = CameraVisible[Position];
+		const Float DeltaX = WorldBounds.CenterX[Index] - CameraPosition.x;
+		const Float DeltaY = WorldBounds.CenterY[Index] - CameraPosition.y;
+		const Float DeltaZ = WorldBounds.CenterZ[Index] - CameraPosition.z;
+		const Float ExtentSqr	= (WorldBounds.ExtentX[Index] * WorldBounds.ExtentX[Index]) + (WorldBounds.ExtentY[Index] * WorldBounds.ExtentY[Index]) + (WorldBounds.ExtentZ[Index] * WorldBounds.ExtentZ[Index]);
+		const Float DistanceSqr	= (DeltaX * DeltaX) + (DeltaY * DeltaY) + (DeltaZ * DeltaZ);
+		return (DistanceSqr > ExtentSqr) ? (ExtentSqr / DistanceSqr) : std::numeric_limits<Float>::max();
+	};
+
+	// Candidates are stored as positions in the list of visible commands
+	TFrameArray<UInt32> OccluderCandidates;
+	OccluderCandidates.Reserve(CameraVisible.Size());
+	for (UInt32 Position = 0; Position < CameraVisible.Size(); Position++)
+	{
+		if (!Commands[CameraVisible[Position]].Material->HasAlphaMask() && GetScreenSize(Position) >= MinOccluderScreenSize)
+		{
+			OccluderCandidates.EmplaceBack(Position);
+		}
+	}
+
+	std::sort(OccluderCandidates.Data(), OccluderCandidates.Data() + OccluderCandidates.Size(), [&](UInt32 First, UInt32 Second)
+	{
+		return GetScreenSize(First) > GetScreenSize(Second);
+	});
+
+	TFrameArray<UInt8> OcclusionResults;
+	OcclusionResults.Resize(CameraVisible.Size(), 0);
+
+	// Rasterize the occluders, they are always visible
+	SoftwareOcclusionBuffer.Clear(Camera->GetViewProjectionMatrix());
+
+	UInt32 NumOccluders	= 0;
+	UInt32 NumTriangles	= 0;
+	for (UInt32 Position : OccluderCandidates)
+	{
+		const MeshDrawCommand& Command = Commands[CameraVisible[Position]];
+		const UInt32 NumMeshTriangles = Command.Mesh->OccluderIndices.Size() / 3;
+		if (NumTriangles + NumMeshTriangles > MaxOccluderTriangles)
+		{
+			continue;
+		}
+
+		SoftwareOcclusionBuffer.RasterizeOccluder(
+			Command.CurrentActor->GetTransform().GetMatrix(),
+			Command.Mesh->OccluderPositions.Data(),
+			Command.Mesh->OccluderPositions.Size(),
+			Command.Mesh->OccluderIndices.Data(),
+			Command.Mesh->OccluderIndices.Size());
+
+		OcclusionResults[Position] = 1;
+		NumTriangles += NumMeshTriangles;
+		if (++NumOccluders >= MaxOccluders)
+		{
+			break;
+		}
+	}
+
+	SoftwareOcclusionBuffer.UpdateHierarchy();
+
+	// Test the rest against the buffer
+	ParallelFor(CameraVisible.Size(), [&](UInt32 Position)
+	{
+		if (!OcclusionResults[Position])
+		{
+			OcclusionResults[Position] = SoftwareOcclusionBuffer.IsVisible(WorldBounds.Get(CameraVisible[Position])) ? 1 : 0;
+		}
+	});
+
+	const UInt32 NumTested = CameraVisible.Size() - NumOccluders;
+
+	UInt32 NumVisible = 0;
+	for (UInt32 Position = 0; Position < CameraVisible.Size(); Position++)
+	{
+		if (OcclusionResults[Position])
+		{
+			CameraVisible[NumVisible++] = CameraVisible[Position];
+		}
+	}
+
+	const UInt32 NumOccluded = CameraVisible.Size() - NumVisible;
+	CameraVisible.Resize(NumVisible);
+
+	OcclusionClock.Tick();
+
+	DebugUI::DrawDebugString("Occluders: %u (%u Triangles)", NumOccluders, NumTriangles);
+	DebugUI::DrawDebugString("Occlusion Tested: %u, Occluded: %u", NumTested, NumOccluded);
+	DebugUI::DrawDebugString("Occlusion Culling: %f ms", OcclusionClock.GetDeltaTime().AsMilliSeconds());
+}
+
 void Renderer::TraceRays(D3D12Texture* BackBuffer, D3D12CommandList* InCommandList)
 {
 	UNREFERENCED_VARIABLE(BackBuffer);
@@ -920,6 +1244,21 @@ void Renderer::SetFrustumCullEnable(bool Enabled)
 	FrustumCullEnabled = Enabled;
 }
 
+void Renderer::SetOcclusionCullEnable(bool Enabled)
+{
+	OcclusionCullEnabled = Enabled;
+}
+
+void Renderer::SetClusterCullEnable(bool Enabled)
+{
+	ClusterCullEnabled = Enabled;
+}
+
+void Renderer::SetLODEnable(bool Enabled)
+{
+	LODEnabled = Enabled;
+}
+
 void Renderer::SetFXAAEnable(bool Enabled)
 {
 	FXAAEnabled = Enabled;
@@ -1003,6 +1342,9 @@ bool Renderer::Initialize()
 
 	FenceValues.Resize(RenderingAPI::Get().GetSwapChain()->GetSurfaceCount());
 
+	// Low resolution is enough for large occluders and keeps the CPU cost down
+	SoftwareOcclusionBuffer.Initialize(256, 128);
+
 	// Create CameraBuffer
 	BufferProperties BufferProps = { };
 	BufferProps.SizeInBytes		= 512; // Must be multiple of 256
@@ -1618,7 +1960,7 @@ bool Renderer::InitPrePass()
 	Parameters[0].ParameterType				= D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
 	Parameters[0].Constants.ShaderRegister	= 0;
 	Parameters[0].Constants.RegisterSpace	= 0;
-	Parameters[0].Constants.Num32BitValues	= 16;
+	Parameters[0].Constants.Num32BitValues	= 16 + NumQuantizationConstants;
 	Parameters[0].ShaderVisibility			= D3D12_SHADER_VISIBILITY_VERTEX;
 
 	// PerFrame DescriptorTable
@@ -1646,20 +1988,12 @@ bool Renderer::InitPrePass()
 	}
 
 	// Init PipelineState
-	D3D12_INPUT_ELEMENT_DESC InputElementDesc[] =
-	{
-		{ "POSITION",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 0,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "NORMAL",		0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 12,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TANGENT",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 24,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TEXCOORD",	0, DXGI_FORMAT_R32G32_FLOAT,	0, 36,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-	};
-
 	GraphicsPipelineStateProperties PSOProperties = { };
 	PSOProperties.DebugName			= "PrePass PipelineState";
 	PSOProperties.VSBlob			= VSBlob.Get();
 	PSOProperties.PSBlob			= nullptr;
 	PSOProperties.RootSignature		= PrePassRootSignature.Get();
-	PSOProperties.InputElements		= InputElementDesc;
+	PSOProperties.InputElements		= MeshInputElementDesc;
 	PSOProperties.NumInputElements	= 4;
 	PSOProperties.EnableDepth		= true;
 	PSOProperties.EnableBlending	= false;
@@ -1713,7 +2047,7 @@ bool Renderer::InitShadowMapPass()
 	Parameters[0].ParameterType				= D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
 	Parameters[0].Constants.ShaderRegister	= 0;
 	Parameters[0].Constants.RegisterSpace	= 0;
-	Parameters[0].Constants.Num32BitValues	= 17;
+	Parameters[0].Constants.Num32BitValues	= 17 + NumQuantizationConstants;
 	Parameters[0].ShaderVisibility			= D3D12_SHADER_VISIBILITY_VERTEX;
 
 	// Camera
@@ -1741,14 +2075,6 @@ bool Renderer::InitShadowMapPass()
 	}
 
 	// Init PipelineState
-	D3D12_INPUT_ELEMENT_DESC InputElementDesc[] =
-	{
-		{ "POSITION",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 0,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "NORMAL",		0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 12,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TANGENT",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 24,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TEXCOORD",	0, DXGI_FORMAT_R32G32_FLOAT,	0, 36,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-	};
-
 	GraphicsPipelineStateProperties PSOProperties = { };
 	PSOProperties.DebugName				= "ShadowMap PipelineState";
 	PSOProperties.VSBlob				= VSBlob.Get();
@@ -1768,7 +2094,7 @@ bool Renderer::InitShadowMapPass()
 #endif
 	PSOProperties.DepthBufferFormat		= ShadowMapFormat;
 	PSOProperties.RootSignature			= ShadowMapRootSignature.Get();
-	PSOProperties.InputElements			= InputElementDesc;
+	PSOProperties.InputElements			= MeshInputElementDesc;
 	PSOProperties.NumInputElements		= 4;
 	PSOProperties.EnableDepth			= true;
 	//PSOProperties.DepthBias			= 3;
@@ -1916,7 +2242,7 @@ bool Renderer::InitDeferred()
 		Parameters[0].ParameterType				= D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
 		Parameters[0].Constants.ShaderRegister	= 0;
 		Parameters[0].Constants.RegisterSpace	= 0;
-		Parameters[0].Constants.Num32BitValues	= 32;
+		Parameters[0].Constants.Num32BitValues	= 32 + NumQuantizationConstants;
 		Parameters[0].ShaderVisibility			= D3D12_SHADER_VISIBILITY_ALL;
 
 		// PerFrame DescriptorTable
@@ -2213,13 +2539,13 @@ bool Renderer::InitDeferred()
 		}
 	}
 
-	// Init PipelineState
+	// Init PipelineState, the skybox is always drawn with unpacked vertices
 	D3D12_INPUT_ELEMENT_DESC InputElementDesc[] =
 	{
-		{ "POSITION",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 0,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "NORMAL",		0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 12,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TANGENT",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 24,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TEXCOORD",	0, DXGI_FORMAT_R32G32_FLOAT,	0, 36,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "POSITION",	0, DXGI_FORMAT_R32G32B32_FLOAT,		0, 0,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "NORMAL",		0, DXGI_FORMAT_R32G32B32_FLOAT,		0, 12,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TANGENT",	0, DXGI_FORMAT_R32G32B32A32_FLOAT,	0, 24,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD",	0, DXGI_FORMAT_R32G32_FLOAT,		0, 40,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 	};
 
 	GraphicsPipelineStateProperties PSOProperties = { };
@@ -2227,7 +2553,7 @@ bool Renderer::InitDeferred()
 	PSOProperties.VSBlob			= VSBlob.Get();
 	PSOProperties.PSBlob			= PSBlob.Get();
 	PSOProperties.RootSignature		= GeometryRootSignature.Get();
-	PSOProperties.InputElements		= InputElementDesc;
+	PSOProperties.InputElements		= MeshInputElementDesc;
 	PSOProperties.NumInputElements	= 4;
 	PSOProperties.EnableDepth		= true;
 	PSOProperties.EnableBlending	= false;
@@ -3089,7 +3415,7 @@ bool Renderer::InitForwardPass()
 		Parameters[0].ParameterType				= D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
 		Parameters[0].Constants.ShaderRegister	= 0;
 		Parameters[0].Constants.RegisterSpace	= 0;
-		Parameters[0].Constants.Num32BitValues	= 32;
+		Parameters[0].Constants.Num32BitValues	= 32 + NumQuantizationConstants;
 		Parameters[0].ShaderVisibility			= D3D12_SHADER_VISIBILITY_ALL;
 
 		// PerFrame DescriptorTable
@@ -3199,20 +3525,12 @@ bool Renderer::InitForwardPass()
 		}
 
 		// Init PipelineState
-		D3D12_INPUT_ELEMENT_DESC InputElementDesc[] =
-		{
-			{ "POSITION",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 0,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-			{ "NORMAL",		0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 12,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-			{ "TANGENT",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 24,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-			{ "TEXCOORD",	0, DXGI_FORMAT_R32G32_FLOAT,	0, 36,	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		};
-
 		GraphicsPipelineStateProperties PSOProperties = { };
 		PSOProperties.DebugName			= "ForwardPass PipelineState";
 		PSOProperties.VSBlob			= VSBlob.Get();
 		PSOProperties.PSBlob			= PSBlob.Get();
 		PSOProperties.RootSignature		= ForwardRootSignature.Get();
-		PSOProperties.InputElements		= InputElementDesc;
+		PSOProperties.InputElements		= MeshInputElementDesc;
 		PSOProperties.NumInputElements	= 4;
 		PSOProperties.EnableDepth		= true;
 		PSOProperties.DepthWriteMask	= D3D12_DEPTH_WRITE_MASK_ALL;
@@ -23,6 +23,9 @@
 #include "Mesh.h"
 #include "Material.h"
 #include "MeshFactory.h"
+#include "OcclusionBuffer.h"
+#include "VisibilityCache.h"
+#include "ClusterCulling.h"
 
 #include "RenderingCore/RenderingAPI.h"
 
@@ -65,6 +68,9 @@ public:
 	void SetVerticalSyncEnable(bool Enabled);
 	void SetDrawAABBsEnable(bool Enabled);
 	void SetFrustumCullEnable(bool Enabled);
+	void SetOcclusionCullEnable(bool Enabled);
+	void SetClusterCullEnable(bool Enabled);
+	void SetLODEnable(bool Enabled);
 	void SetFXAAEnable(bool Enabled);
 	void SetSSAOEnable(bool Enabled);
 	
@@ -108,6 +114,21 @@ public:
 		return FrustumCullEnabled;
 	}
 
+	FORCEINLINE bool IsOcclusionCullEnabled() const
+	{
+		return OcclusionCullEnabled;
+	}
+
+	FORCEINLINE bool IsClusterCullEnabled() const
+	{
+		return ClusterCullEnabled;
+	}
+
+	FORCEINLINE bool IsLODEnabled() const
+	{
+		return LODEnabled;
+	}
+
 	FORCEINLINE bool IsSSAOEnabled() const
 	{
 		return SSAOEnabled;
@@ -164,6 +185,11 @@ private:
 
 	void WaitForPendingFrames();
 
+	void SelectLODs(const Scene& CurrentScene);
+	void PerformFrustumCulling(const Scene& CurrentScene);
+	void PerformOcclusionCulling(const Scene& CurrentScene);
+	void PerformClusterCulling(const Scene& CurrentScene, const Frustum* CameraFrustum);
+
 	void TraceRays(D3D12Texture* BackBuffer, D3D12CommandList* CommandList);
 
 private:
@@ -244,18 +270,32 @@ private:
 
 	TSharedPtr<D3D12RayTracingPipelineState> RaytracingPSO;
 
+	// The commands of the scene with the selected LOD of each mesh
+	TArray<MeshDrawCommand> LODCommands;
 	TArray<MeshDrawCommand> DeferredVisibleCommands;
 	TArray<MeshDrawCommand> ForwardVisibleCommands;
+	TArray<MeshDrawCommand> PointLightVisibleCommands[6];
+	TArray<UInt32> VisibleCommandIndices[7];
+	VisibilityCache VisibilityCaches[7];
+
+	OcclusionBuffer SoftwareOcclusionBuffer;
+	Clock			OcclusionClock;
+
+	// Ranges of the indexbuffer to draw for each of the DeferredVisibleCommands
+	TArray<TArray<MeshletDrawRange>> DeferredDrawRanges;
 
 	TArray<UInt64> FenceValues;
 	UInt32 CurrentBackBufferIndex = 0;
 
-	bool PrePassEnabled		= true;
-	bool DrawAABBs			= false;
-	bool VSyncEnabled		= false;
-	bool FrustumCullEnabled	= true;
-	bool FXAAEnabled		= true;
-	bool RayTracingEnabled	= false;
+	bool PrePassEnabled			= true;
+	bool DrawAABBs				= false;
+	bool VSyncEnabled			= false;
+	bool FrustumCullEnabled		= true;
+	bool OcclusionCullEnabled	= true;
+	bool ClusterCullEnabled		= true;
+	bool LODEnabled				= true;
+	bool FXAAEnabled			= true;
+	bool RayTracingEnabled		= false;
 
 	bool SSAOEnabled	= true;
 	Float SSAORadius	= 0.3f;
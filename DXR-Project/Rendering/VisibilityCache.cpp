@@ -0,0 +1,142 @@
+#include "VisibilityCache.h"
+
+#include "Core/JobSystem.h"
+
+#include "Containers/TFrameArray.h"
+
+/*
+* VisibilityCache
+*/
+
+VisibilityCache::VisibilityCache()
+	: GuardFrustum()
+	, InGuardFrustum()
+	, Versions()
+	, QueryInside()
+	, QueryIntersecting()
+{
+}
+
+void VisibilityCache::Cull(const Scene& CurrentScene, const Frustum& ViewFrustum, TArray<UInt32>& OutVisibleCommands)
+{
+	const TArray<UInt32>& BoundsVersions = CurrentScene.GetBoundsVersions();
+	const UInt32 NumCommands = BoundsVersions.Size();
+
+	if (!IsValid || InGuardFrustum.Size() != NumCommands || !ViewFrustum.IsInside(GuardFrustum))
+	{
+		Rebuild(CurrentScene, ViewFrustum);
+	}
+	else
+	{
+		// The views are culled in parallel, so the temporary lists come from the calling thread's frame memory
+		TFrameArray<UInt32> DirtyCommands;
+		for (UInt32 Index = 0; Index < NumCommands; Index++)
+		{
+			if (Versions[Index] != BoundsVersions[Index])
+			{
+				DirtyCommands.EmplaceBack(Index);
+			}
+		}
+
+		if (Float(DirtyCommands.Size()) > Float(NumCommands) * MaxDirtyRatio)
+		{
+			Rebuild(CurrentScene, ViewFrustum);
+		}
+		else
+		{
+			TFrameArray<UInt8> Results;
+			Results.Resize(DirtyCommands.Size());
+			CheckCommands(CurrentScene, GuardFrustum, DirtyCommands.Data(), DirtyCommands.Size(), Results.Data());
+
+			for (UInt32 Position = 0; Position < DirtyCommands.Size(); Position++)
+			{
+				const UInt32 Index = DirtyCommands[Position];
+				InGuardFrustum[Index]	= Results[Position];
+				Versions[Index]			= BoundsVersions[Index];
+			}
+
+			NumMisses	= DirtyCommands.Size();
+			NumHits		= NumCommands - NumMisses;
+		}
+	}
+
+	// Only the commands inside the guard frustum can be visible
+	TFrameArray<UInt32> Candidates;
+	for (UInt32 Index = 0; Index < NumCommands; Index++)
+	{
+		if (InGuardFrustum[Index])
+		{
+			Candidates.EmplaceBack(Index);
+		}
+	}
+
+	TFrameArray<UInt8> Results;
+	Results.Resize(Candidates.Size());
+	CheckCommands(CurrentScene, ViewFrustum, Candidates.Data(), Candidates.Size(), Results.Data());
+
+	OutVisibleCommands.Clear();
+	for (UInt32 Position = 0; Position < Candidates.Size(); Position++)
+	{
+		if (Results[Position])
+		{
+			OutVisibleCommands.EmplaceBack(Candidates[Position]);
+		}
+	}
+}
+
+void VisibilityCache::Invalidate()
+{
+	IsValid = false;
+}
+
+void VisibilityCache::Rebuild(const Scene& CurrentScene, const Frustum& ViewFrustum)
+{
+	const TArray<UInt32>& BoundsVersions = CurrentScene.GetBoundsVersions();
+	const UInt32 NumCommands = BoundsVersions.Size();
+
+	GuardFrustum = ViewFrustum.Expand(ViewFrustum.GetDepth() * GuardBandRatio);
+
+	QueryInside.Clear();
+	QueryIntersecting.Clear();
+	CurrentScene.GetSpatialTree().QueryFrustum(GuardFrustum, QueryInside, QueryIntersecting);
+
+	InGuardFrustum.Resize(NumCommands);
+	for (UInt8& Value : InGuardFrustum)
+	{
+		Value = 0;
+	}
+
+	for (UInt32 Index : QueryInside)
+	{
+		InGuardFrustum[Index] = 1;
+	}
+
+	// The leaves of the tree are fattened, the commands that only intersect are tested with their real bounds
+	TFrameArray<UInt8> Results;
+	Results.Resize(QueryIntersecting.Size());
+	CheckCommands(CurrentScene, GuardFrustum, QueryIntersecting.Data(), QueryIntersecting.Size(), Results.Data());
+
+	for (UInt32 Position = 0; Position < QueryIntersecting.Size(); Position++)
+	{
+		InGuardFrustum[QueryIntersecting[Position]] = Results[Position];
+	}
+
+	Versions.Resize(NumCommands);
+	for (UInt32 Index = 0; Index < NumCommands; Index++)
+	{
+		Versions[Index] = BoundsVersions[Index];
+	}
+
+	IsValid		= true;
+	NumHits		= 0;
+	NumMisses	= NumCommands;
+}
+
+void VisibilityCache::CheckCommands(const Scene& CurrentScene, const Frustum& TestFrustum, const UInt32* Indices, UInt32 Count, UInt8* OutResults)
+{
+	const AABBList& WorldBounds = CurrentScene.GetWorldBounds();
+	ParallelForBatch(Count, [&](UInt32 Begin, UInt32 End)
+	{
+		TestFrustum.CheckAABBs(WorldBounds, Indices + Begin, End - Begin, OutResults + Begin);
+	}, CullBatchSize);
+}
\ No newline at end of file
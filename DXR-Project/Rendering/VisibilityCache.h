@@ -0,0 +1,65 @@
+#pragma once
+#include "Scene/Scene.h"
+#include "Scene/Frustum.h"
+
+/*
+* VisibilityCache - Remembers which MeshDrawCommands are close to a view. The commands are culled against a guard
+* frustum, the view frustum expanded by GuardBandRatio of its depth, and that result stays valid as long as the view
+* frustum is inside the guard frustum and only a few commands have moved. Each call to Cull then only tests the
+* commands that are inside the guard frustum against the exact view, and the commands that moved against the guard
+* frustum. When the view leaves the guard frustum, or too many commands have moved, the guard frustum is moved to the
+* new view and the commands are culled again using the scene's spatial tree.
+*/
+
+class VisibilityCache
+{
+public:
+	// When more than this part of the commands have moved it is faster to query the tree
+	static constexpr Float MaxDirtyRatio = 0.25f;
+
+	// A larger guard band keeps the cache valid for larger camera movements, but more commands are tested every frame
+	static constexpr Float GuardBandRatio = 0.05f;
+
+	// Number of commands that one job tests with Frustum::CheckAABBs
+	static constexpr UInt32 CullBatchSize = 256;
+
+	VisibilityCache();
+	~VisibilityCache() = default;
+
+	// Fills OutVisibleCommands with the indices of the visible MeshDrawCommands, sorted in increasing order
+	void Cull(const Scene& CurrentScene, const Frustum& ViewFrustum, TArray<UInt32>& OutVisibleCommands);
+
+	// Forces the next call to Cull to query the tree
+	void Invalidate();
+
+	// Number of commands that did not need to be tested against the guard frustum during the last call to Cull
+	FORCEINLINE UInt32 GetNumHits() const
+	{
+		return NumHits;
+	}
+
+	// Number of commands that were tested against the guard frustum during the last call to Cull
+	FORCEINLINE UInt32 GetNumMisses() const
+	{
+		return NumMisses;
+	}
+
+private:
+	void Rebuild(const Scene& CurrentScene, const Frustum& ViewFrustum);
+
+	// Tests the listed commands against the frustum, OutResults[N] is the result for Indices[N]
+	void CheckCommands(const Scene& CurrentScene, const Frustum& TestFrustum, const UInt32* Indices, UInt32 Count, UInt8* OutResults);
+
+	Frustum GuardFrustum;
+
+	// Per MeshDrawCommand
+	TArray<UInt8>	InGuardFrustum;
+	TArray<UInt32>	Versions;
+
+	TArray<UInt32> QueryInside;
+	TArray<UInt32> QueryIntersecting;
+
+	UInt32 NumHits		= 0;
+	UInt32 NumMisses	= 0;
+	bool IsValid		= false;
+};
\ No newline at end of file
@@ -28,4 +28,51 @@ struct AABB
 
 	XMFLOAT3 Top;
 	XMFLOAT3 Bottom;
-};
\ No newline at end of file
+};
+
+/*
+* AABBList - Boxes stored as arrays of centers and extents, used for batched culling
+*/
+
+struct AABBList
+{
+	FORCEINLINE void Resize(UInt32 InSize)
+	{
+		CenterX.Resize(InSize);
+		CenterY.Resize(InSize);
+		CenterZ.Resize(InSize);
+		ExtentX.Resize(InSize);
+		ExtentY.Resize(InSize);
+		ExtentZ.Resize(InSize);
+	}
+
+	FORCEINLINE void Set(UInt32 Index, const XMFLOAT3& Center, const XMFLOAT3& Extent)
+	{
+		CenterX[Index] = Center.x;
+		CenterY[Index] = Center.y;
+		CenterZ[Index] = Center.z;
+		ExtentX[Index] = Extent.x;
+		ExtentY[Index] = Extent.y;
+		ExtentZ[Index] = Extent.z;
+	}
+
+	FORCEINLINE AABB Get(UInt32 Index) const
+	{
+		AABB Box;
+		Box.Top		= XMFLOAT3(CenterX[Index] + ExtentX[Index], CenterY[Index] + ExtentY[Index], CenterZ[Index] + ExtentZ[Index]);
+		Box.Bottom	= XMFLOAT3(CenterX[Index] - ExtentX[Index], CenterY[Index] - ExtentY[Index], CenterZ[Index] - ExtentZ[Index]);
+		return Box;
+	}
+
+	FORCEINLINE UInt32 Size() const
+	{
+		return CenterX.Size();
+	}
+
+	TArray<Float> CenterX;
+	TArray<Float> CenterY;
+	TArray<Float> CenterZ;
+	TArray<Float> ExtentX;
+	TArray<Float> ExtentY;
+	TArray<Float> ExtentZ;
+};
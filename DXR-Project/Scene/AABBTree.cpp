@@ -0,0 +1,575 @@
+#include "PreCompiled.h"
+#include "AABBTree.h"
+
+/*
+* Helpers
+*/
+
+static constexpr UInt32 MaxStackSize = 256;
+
+static FORCEINLINE AABB CombineAABBs(const AABB& First, const AABB& Second)
+{
+	AABB Result;
+	Result.Top		= XMFLOAT3(fmaxf(First.Top.x, Second.Top.x), fmaxf(First.Top.y, Second.Top.y), fmaxf(First.Top.z, Second.Top.z));
+	Result.Bottom	= XMFLOAT3(fminf(First.Bottom.x, Second.Bottom.x), fminf(First.Bottom.y, Second.Bottom.y), fminf(First.Bottom.z, Second.Bottom.z));
+	return Result;
+}
+
+static FORCEINLINE Float SurfaceArea(const AABB& Box)
+{
+	const Float Width	= Box.GetWidth();
+	const Float Height	= Box.GetHeight();
+	const Float Depth	= Box.GetDepth();
+	return 2.0f * ((Width * Height) + (Height * Depth) + (Depth * Width));
+}
+
+static FORCEINLINE bool ContainsAABB(const AABB& Outer, const AABB& Inner)
+{
+	return
+		(Outer.Bottom.x <= Inner.Bottom.x) && (Outer.Bottom.y <= Inner.Bottom.y) && (Outer.Bottom.z <= Inner.Bottom.z) &&
+		(Outer.Top.x >= Inner.Top.x) && (Outer.Top.y >= Inner.Top.y) && (Outer.Top.z >= Inner.Top.z);
+}
+
+static FORCEINLINE AABB FattenAABB(const AABB& Box, Float Margin)
+{
+	AABB Result;
+	Result.Top		= XMFLOAT3(Box.Top.x + Margin, Box.Top.y + Margin, Box.Top.z + Margin);
+	Result.Bottom	= XMFLOAT3(Box.Bottom.x - Margin, Box.Bottom.y - Margin, Box.Bottom.z - Margin);
+	return Result;
+}
+
+/*
+* AABBTree
+*/
+
+AABBTree::AABBTree(Float InFatMargin)
+	: Nodes()
+	, FatMargin(InFatMargin)
+{
+}
+
+UInt32 AABBTree::Insert(const AABB& Box, UInt32 UserData)
+{
+	const UInt32 ProxyID = AllocateNode();
+
+	Node& Leaf = Nodes[ProxyID];
+	Leaf.Box		= FattenAABB(Box, FatMargin);
+	Leaf.UserData	= UserData;
+	Leaf.Height		= 0;
+
+	InsertLeaf(ProxyID);
+	NumProxies++;
+
+	return ProxyID;
+}
+
+void AABBTree::Remove(UInt32 ProxyID)
+{
+	VALIDATE(ProxyID < Nodes.Size());
+	VALIDATE(Nodes[ProxyID].IsLeaf());
+
+	RemoveLeaf(ProxyID);
+	FreeNode(ProxyID);
+	NumProxies--;
+}
+
+bool AABBTree::Move(UInt32 ProxyID, const AABB& Box)
+{
+	VALIDATE(ProxyID < Nodes.Size());
+	VALIDATE(Nodes[ProxyID].IsLeaf());
+
+	if (ContainsAABB(Nodes[ProxyID].Box, Box))
+	{
+		return false;
+	}
+
+	RemoveLeaf(ProxyID);
+	Nodes[ProxyID].Box = FattenAABB(Box, FatMargin);
+	InsertLeaf(ProxyID);
+	return true;
+}
+
+void AABBTree::Clear()
+{
+	Nodes.Clear();
+	Root		= AABB_TREE_NULL_NODE;
+	FreeList	= AABB_TREE_NULL_NODE;
+	NumProxies	= 0;
+}
+
+void AABBTree::QueryFrustum(const Frustum& ViewFrustum, TArray<UInt32>& OutUserData) const
+{
+	if (Root == AABB_TREE_NULL_NODE)
+	{
+		return;
+	}
+
+	UInt32 Stack[MaxStackSize];
+	UInt32 StackSize = 0;
+	Stack[StackSize++] = Root;
+
+	while (StackSize > 0)
+	{
+		const UInt32 NodeIndex = Stack[--StackSize];
+		const Node& CurrentNode = Nodes[NodeIndex];
+
+		const EFrustumContainment Containment = ViewFrustum.ContainsAABB(CurrentNode.Box);
+		if (Containment == EFrustumContainment::FRUSTUM_CONTAINMENT_OUTSIDE)
+		{
+			continue;
+		}
+
+		if (CurrentNode.IsLeaf())
+		{
+			OutUserData.EmplaceBack(CurrentNode.UserData);
+		}
+		else if (Containment == EFrustumContainment::FRUSTUM_CONTAINMENT_INSIDE)
+		{
+			// Everything below is visible, no need to test the children
+			CollectLeaves(NodeIndex, OutUserData);
+		}
+		else
+		{
+			VALIDATE(StackSize + 2 <= MaxStackSize);
+			Stack[StackSize++] = CurrentNode.Child0;
+			Stack[StackSize++] = CurrentNode.Child1;
+		}
+	}
+}
+
+void AABBTree::QueryFrustum(const Frustum& ViewFrustum, TArray<UInt32>& OutInside, TArray<UInt32>& OutIntersecting) const
+{
+	if (Root == AABB_TREE_NULL_NODE)
+	{
+		return;
+	}
+
+	UInt32 Stack[MaxStackSize];
+	UInt32 StackSize = 0;
+	Stack[StackSize++] = Root;
+
+	while (StackSize > 0)
+	{
+		const UInt32 NodeIndex = Stack[--StackSize];
+		const Node& CurrentNode = Nodes[NodeIndex];
+
+		const EFrustumContainment Containment = ViewFrustum.ContainsAABB(CurrentNode.Box);
+		if (Containment == EFrustumContainment::FRUSTUM_CONTAINMENT_OUTSIDE)
+		{
+			continue;
+		}
+
+		if (Containment == EFrustumContainment::FRUSTUM_CONTAINMENT_INSIDE)
+		{
+			CollectLeaves(NodeIndex, OutInside);
+		}
+		else if (CurrentNode.IsLeaf())
+		{
+			OutIntersecting.EmplaceBack(CurrentNode.UserData);
+		}
+		else
+		{
+			VALIDATE(StackSize + 2 <= MaxStackSize);
+			Stack[StackSize++] = CurrentNode.Child0;
+			Stack[StackSize++] = CurrentNode.Child1;
+		}
+	}
+}
+
+void AABBTree::QuerySphere(const XMFLOAT3& Center, Float Radius, TArray<UInt32>& OutUserData) const
+{
+	if (Root == AABB_TREE_NULL_NODE)
+	{
+		return;
+	}
+
+	const Float RadiusSqrd = Radius * Radius;
+
+	UInt32 Stack[MaxStackSize];
+	UInt32 StackSize = 0;
+	Stack[StackSize++] = Root;
+
+	while (StackSize > 0)
+	{
+		const Node& CurrentNode = Nodes[Stack[--StackSize]];
+
+		// Squared distance from the center to the closest point on the box
+		const AABB& Box = CurrentNode.Box;
+		const Float DistanceX = fmaxf(fmaxf(Box.Bottom.x - Center.x, 0.0f), Center.x - Box.Top.x);
+		const Float DistanceY = fmaxf(fmaxf(Box.Bottom.y - Center.y, 0.0f), Center.y - Box.Top.y);
+		const Float DistanceZ = fmaxf(fmaxf(Box.Bottom.z - Center.z, 0.0f), Center.z - Box.Top.z);
+		if ((DistanceX * DistanceX) + (DistanceY * DistanceY) + (DistanceZ * DistanceZ) > RadiusSqrd)
+		{
+			continue;
+		}
+
+		if (CurrentNode.IsLeaf())
+		{
+			OutUserData.EmplaceBack(CurrentNode.UserData);
+		}
+		else
+		{
+			VALIDATE(StackSize + 2 <= MaxStackSize);
+			Stack[StackSize++] = CurrentNode.Child0;
+			Stack[StackSize++] = CurrentNode.Child1;
+		}
+	}
+}
+
+void AABBTree::QueryRay(const XMFLOAT3& Origin, const XMFLOAT3& Direction, Float MaxDistance, TArray<UInt32>& OutUserData) const
+{
+	if (Root == AABB_TREE_NULL_NODE)
+	{
+		return;
+	}
+
+	// Division by zero gives infinity, which the slab test handles
+	const XMFLOAT3 InvDirection = XMFLOAT3(1.0f / Direction.x, 1.0f / Direction.y, 1.0f / Direction.z);
+
+	UInt32 Stack[MaxStackSize];
+	UInt32 StackSize = 0;
+	Stack[StackSize++] = Root;
+
+	while (StackSize > 0)
+	{
+		const Node& CurrentNode = Nodes[Stack[--StackSize]];
+
+		const AABB& Box = CurrentNode.Box;
+		const Float T0x = (Box.Bottom.x - Origin.x) * InvDirection.x;
+		const Float T1x = (Box.Top.x - Origin.x) * InvDirection.x;
+		const Float T0y = (Box.Bottom.y - Origin.y) * InvDirection.y;
+		const Float T1y = (Box.Top.y - Origin.y) * InvDirection.y;
+		const Float T0z = (Box.Bottom.z - Origin.z) * InvDirection.z;
+		const Float T1z = (Box.Top.z - Origin.z) * InvDirection.z;
+
+		const Float TMin = fmaxf(fmaxf(fminf(T0x, T1x), fminf(T0y, T1y)), fmaxf(fminf(T0z, T1z), 0.0f));
+		const Float TMax = fminf(fminf(fmaxf(T0x, T1x), fmaxf(T0y, T1y)), fminf(fmaxf(T0z, T1z), MaxDistance));
+		if (TMin > TMax)
+		{
+			continue;
+		}
+
+		if (CurrentNode.IsLeaf())
+		{
+			OutUserData.EmplaceBack(CurrentNode.UserData);
+		}
+		else
+		{
+			VALIDATE(StackSize + 2 <= MaxStackSize);
+			Stack[StackSize++] = CurrentNode.Child0;
+			Stack[StackSize++] = CurrentNode.Child1;
+		}
+	}
+}
+
+UInt32 AABBTree::AllocateNode()
+{
+	if (FreeList == AABB_TREE_NULL_NODE)
+	{
+		Nodes.EmplaceBack();
+		return Nodes.Size() - 1;
+	}
+
+	const UInt32 NodeIndex = FreeList;
+	FreeList = Nodes[NodeIndex].Parent;
+
+	Nodes[NodeIndex] = Node();
+	return NodeIndex;
+}
+
+void AABBTree::FreeNode(UInt32 NodeIndex)
+{
+	VALIDATE(NodeIndex < Nodes.Size());
+
+	Node& FreedNode = Nodes[NodeIndex];
+	FreedNode.Parent	= FreeList;
+	FreedNode.Child0	= AABB_TREE_NULL_NODE;
+	FreedNode.Child1	= AABB_TREE_NULL_NODE;
+	FreedNode.Height	= -1;
+	FreeList = NodeIndex;
+}
+
+void AABBTree::InsertLeaf(UInt32 Leaf)
+{
+	if (Root == AABB_TREE_NULL_NODE)
+	{
+		Root = Leaf;
+		Nodes[Root].Parent = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	// Find the best sibling using the surface area heuristic
+	const AABB LeafBox = Nodes[Leaf].Box;
+
+	UInt32 NodeIndex = Root;
+	while (!Nodes[NodeIndex].IsLeaf())
+	{
+		const Node& CurrentNode = Nodes[NodeIndex];
+
+		const Float Area			= SurfaceArea(CurrentNode.Box);
+		const Float CombinedArea	= SurfaceArea(CombineAABBs(CurrentNode.Box, LeafBox));
+
+		// Cost of creating a new parent for this node and the new leaf
+		const Float Cost = 2.0f * CombinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		const Float InheritanceCost = 2.0f * (CombinedArea - Area);
+
+		const Node& Child0 = Nodes[CurrentNode.Child0];
+		Float Cost0 = SurfaceArea(CombineAABBs(LeafBox, Child0.Box)) + InheritanceCost;
+		if (!Child0.IsLeaf())
+		{
+			Cost0 -= SurfaceArea(Child0.Box);
+		}
+
+		const Node& Child1 = Nodes[CurrentNode.Child1];
+		Float Cost1 = SurfaceArea(CombineAABBs(LeafBox, Child1.Box)) + InheritanceCost;
+		if (!Child1.IsLeaf())
+		{
+			Cost1 -= SurfaceArea(Child1.Box);
+		}
+
+		if (Cost < Cost0 && Cost < Cost1)
+		{
+			break;
+		}
+
+		NodeIndex = (Cost0 < Cost1) ? CurrentNode.Child0 : CurrentNode.Child1;
+	}
+
+	// Create a new parent for the sibling and the leaf
+	const UInt32 Sibling	= NodeIndex;
+	const UInt32 OldParent	= Nodes[Sibling].Parent;
+	const UInt32 NewParent	= AllocateNode();
+
+	Node& NewParentNode = Nodes[NewParent];
+	NewParentNode.Parent	= OldParent;
+	NewParentNode.Box		= CombineAABBs(LeafBox, Nodes[Sibling].Box);
+	NewParentNode.Height	= Nodes[Sibling].Height + 1;
+	NewParentNode.Child0	= Sibling;
+	NewParentNode.Child1	= Leaf;
+
+	if (OldParent != AABB_TREE_NULL_NODE)
+	{
+		Node& OldParentNode = Nodes[OldParent];
+		if (OldParentNode.Child0 == Sibling)
+		{
+			OldParentNode.Child0 = NewParent;
+		}
+		else
+		{
+			OldParentNode.Child1 = NewParent;
+		}
+	}
+	else
+	{
+		Root = NewParent;
+	}
+
+	Nodes[Sibling].Parent	= NewParent;
+	Nodes[Leaf].Parent		= NewParent;
+
+	RefitParents(NewParent);
+}
+
+void AABBTree::RemoveLeaf(UInt32 Leaf)
+{
+	if (Leaf == Root)
+	{
+		Root = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	const UInt32 Parent			= Nodes[Leaf].Parent;
+	const UInt32 GrandParent	= Nodes[Parent].Parent;
+	const UInt32 Sibling		= (Nodes[Parent].Child0 == Leaf) ? Nodes[Parent].Child1 : Nodes[Parent].Child0;
+
+	// Replace the parent with the sibling
+	if (GrandParent != AABB_TREE_NULL_NODE)
+	{
+		Node& GrandParentNode = Nodes[GrandParent];
+		if (GrandParentNode.Child0 == Parent)
+		{
+			GrandParentNode.Child0 = Sibling;
+		}
+		else
+		{
+			GrandParentNode.Child1 = Sibling;
+		}
+
+		Nodes[Sibling].Parent = GrandParent;
+		FreeNode(Parent);
+
+		RefitParents(GrandParent);
+	}
+	else
+	{
+		Root = Sibling;
+		Nodes[Sibling].Parent = AABB_TREE_NULL_NODE;
+		FreeNode(Parent);
+	}
+
+	Nodes[Leaf].Parent = AABB_TREE_NULL_NODE;
+}
+
+UInt32 AABBTree::Balance(UInt32 IndexA)
+{
+	Node& A = Nodes[IndexA];
+	if (A.IsLeaf() || A.Height < 2)
+	{
+		return IndexA;
+	}
+
+	const UInt32 IndexB = A.Child0;
+	const UInt32 IndexC = A.Child1;
+	Node& B = Nodes[IndexB];
+	Node& C = Nodes[IndexC];
+
+	const Int32 BalanceFactor = C.Height - B.Height;
+
+	// Rotate C up
+	if (BalanceFactor > 1)
+	{
+		const UInt32 IndexF = C.Child0;
+		const UInt32 IndexG = C.Child1;
+		Node& F = Nodes[IndexF];
+		Node& G = Nodes[IndexG];
+
+		C.Child0	= IndexA;
+		C.Parent	= A.Parent;
+		A.Parent	= IndexC;
+
+		if (C.Parent != AABB_TREE_NULL_NODE)
+		{
+			Node& CParent = Nodes[C.Parent];
+			if (CParent.Child0 == IndexA)
+			{
+				CParent.Child0 = IndexC;
+			}
+			else
+			{
+				CParent.Child1 = IndexC;
+			}
+		}
+		else
+		{
+			Root = IndexC;
+		}
+
+		if (F.Height > G.Height)
+		{
+			C.Child1	= IndexF;
+			A.Child1	= IndexG;
+			G.Parent	= IndexA;
+			A.Box		= CombineAABBs(B.Box, G.Box);
+			C.Box		= CombineAABBs(A.Box, F.Box);
+			A.Height	= 1 + std::max(B.Height, G.Height);
+			C.Height	= 1 + std::max(A.Height, F.Height);
+		}
+		else
+		{
+			C.Child1	= IndexG;
+			A.Child1	= IndexF;
+			F.Parent	= IndexA;
+			A.Box		= CombineAABBs(B.Box, F.Box);
+			C.Box		= CombineAABBs(A.Box, G.Box);
+			A.Height	= 1 + std::max(B.Height, F.Height);
+			C.Height	= 1 + std::max(A.Height, G.Height);
+		}
+
+		return IndexC;
+	}
+
+	// Rotate B up
+	if (BalanceFactor < -1)
+	{
+		const UInt32 IndexD = B.Child0;
+		const UInt32 IndexE = B.Child1;
+		Node& D = Nodes[IndexD];
+		Node& E = Nodes[IndexE];
+
+		B.Child0	= IndexA;
+		B.Parent	= A.Parent;
+		A.Parent	= IndexB;
+
+		if (B.Parent != AABB_TREE_NULL_NODE)
+		{
+			Node& BParent = Nodes[B.Parent];
+			if (BParent.Child0 == IndexA)
+			{
+				BParent.Child0 = IndexB;
+			}
+			else
+			{
+				BParent.Child1 = IndexB;
+			}
+		}
+		else
+		{
+			Root = IndexB;
+		}
+
+		if (D.Height > E.Height)
+		{
+			B.Child1	= IndexD;
+			A.Child0	= IndexE;
+			E.Parent	= IndexA;
+			A.Box		= CombineAABBs(C.Box, E.Box);
+			B.Box		= CombineAABBs(A.Box, D.Box);
+			A.Height	= 1 + std::max(C.Height, E.Height);
+			B.Height	= 1 + std::max(A.Height, D.Height);
+		}
+		else
+		{
+			B.Child1	= IndexE;
+			A.Child0	= IndexD;
+			D.Parent	= IndexA;
+			A.Box		= CombineAABBs(C.Box, D.Box);
+			B.Box		= CombineAABBs(A.Box, E.Box);
+			A.Height	= 1 + std::max(C.Height, D.Height);
+			B.Height	= 1 + std::max(A.Height, E.Height);
+		}
+
+		return IndexB;
+	}
+
+	return IndexA;
+}
+
+void AABBTree::RefitParents(UInt32 NodeIndex)
+{
+	while (NodeIndex != AABB_TREE_NULL_NODE)
+	{
+		NodeIndex = Balance(NodeIndex);
+
+		Node& CurrentNode = Nodes[NodeIndex];
+		const Node& Child0 = Nodes[CurrentNode.Child0];
+		const Node& Child1 = Nodes[CurrentNode.Child1];
+		CurrentNode.Height	= 1 + std::max(Child0.Height, Child1.Height);
+		CurrentNode.Box		= CombineAABBs(Child0.Box, Child1.Box);
+
+		NodeIndex = CurrentNode.Parent;
+	}
+}
+
+void AABBTree::CollectLeaves(UInt32 NodeIndex, TArray<UInt32>& OutUserData) const
+{
+	UInt32 Stack[MaxStackSize];
+	UInt32 StackSize = 0;
+	Stack[StackSize++] = NodeIndex;
+
+	while (StackSize > 0)
+	{
+		const Node& CurrentNode = Nodes[Stack[--StackSize]];
+		if (CurrentNode.IsLeaf())
+		{
+			OutUserData.EmplaceBack(CurrentNode.UserData);
+		}
+		else
+		{
+			VALIDATE(StackSize + 2 <= MaxStackSize);
+			Stack[StackSize++] = CurrentNode.Child0;
+			Stack[StackSize++] = CurrentNode.Child1;
+		}
+	}
+}
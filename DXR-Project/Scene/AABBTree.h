@@ -0,0 +1,96 @@
+#pragma once
+#include "AABB.h"
+#include "Frustum.h"
+
+#define AABB_TREE_NULL_NODE	(~0u)
+
+/*
+* AABBTree - Dynamic bounding volume hierarchy. Leaves store a fattened box so that small movements do not change the tree,
+* the tree is kept balanced with rotations when nodes are inserted.
+*/
+
+class AABBTree
+{
+	struct Node
+	{
+		FORCEINLINE bool IsLeaf() const
+		{
+			return (Child0 == AABB_TREE_NULL_NODE);
+		}
+
+		AABB Box;
+
+		// Parent is used as the next index in the freelist when the node is not used
+		UInt32 Parent	= AABB_TREE_NULL_NODE;
+		UInt32 Child0	= AABB_TREE_NULL_NODE;
+		UInt32 Child1	= AABB_TREE_NULL_NODE;
+
+		// Leaves have a height of zero, free nodes -1
+		Int32 Height	= -1;
+		UInt32 UserData	= 0;
+	};
+
+public:
+	AABBTree(Float InFatMargin = 0.1f);
+	~AABBTree() = default;
+
+	// Returns a proxy that is used to move and remove the box
+	UInt32 Insert(const AABB& Box, UInt32 UserData);
+	void Remove(UInt32 ProxyID);
+
+	// Returns true if the proxy had to be reinserted, false if the box still fits in the fattened box
+	bool Move(UInt32 ProxyID, const AABB& Box);
+
+	void Clear();
+
+	// Appends the UserData of every leaf that intersects the query to OutUserData
+	void QueryFrustum(const Frustum& ViewFrustum, TArray<UInt32>& OutUserData) const;
+
+	/*
+	* Splits the leaves that intersect the frustum into leaves whose fattened box is fully inside and leaves that only
+	* intersect. The fattened boxes are larger than the real bounds, so the second list should be tested again.
+	*/
+	void QueryFrustum(const Frustum& ViewFrustum, TArray<UInt32>& OutInside, TArray<UInt32>& OutIntersecting) const;
+	void QuerySphere(const XMFLOAT3& Center, Float Radius, TArray<UInt32>& OutUserData) const;
+	void QueryRay(const XMFLOAT3& Origin, const XMFLOAT3& Direction, Float MaxDistance, TArray<UInt32>& OutUserData) const;
+
+	FORCEINLINE const AABB& GetFatAABB(UInt32 ProxyID) const
+	{
+		VALIDATE(ProxyID < Nodes.Size());
+		return Nodes[ProxyID].Box;
+	}
+
+	FORCEINLINE UInt32 GetUserData(UInt32 ProxyID) const
+	{
+		VALIDATE(ProxyID < Nodes.Size());
+		return Nodes[ProxyID].UserData;
+	}
+
+	FORCEINLINE Int32 GetHeight() const
+	{
+		return (Root != AABB_TREE_NULL_NODE) ? Nodes[Root].Height : 0;
+	}
+
+	FORCEINLINE UInt32 GetNumProxies() const
+	{
+		return NumProxies;
+	}
+
+private:
+	UInt32 AllocateNode();
+	void FreeNode(UInt32 NodeIndex);
+
+	void InsertLeaf(UInt32 Leaf);
+	void RemoveLeaf(UInt32 Leaf);
+
+	UInt32 Balance(UInt32 NodeIndex);
+	void RefitParents(UInt32 NodeIndex);
+
+	void CollectLeaves(UInt32 NodeIndex, TArray<UInt32>& OutUserData) const;
+
+	TArray<Node> Nodes;
+	UInt32 Root			= AABB_TREE_NULL_NODE;
+	UInt32 FreeList		= AABB_TREE_NULL_NODE;
+	UInt32 NumProxies	= 0;
+	Float FatMargin		= 0.1f;
+};
@@ -1,23 +1,6 @@
 #include "Actor.h"
 #include "Scene.h"
 
-/*
-* Component Base-Class
-*/
-
-Component::Component(Actor* InOwningActor)
-	: CoreObject()
-	, OwningActor(InOwningActor)
-{
-	VALIDATE(InOwningActor != nullptr);
-
-	CORE_OBJECT_INIT();
-}
-
-Component::~Component()
-{
-}
-
 /*
 * Actor
 */
@@ -26,39 +9,103 @@ Actor::Actor()
 	: CoreObject()
 	, Components()
 	, Transform()
+	, Children()
 {
 	CORE_OBJECT_INIT();
 }
 
 Actor::~Actor()
 {
-	for (Component* CurrentComponent : Components)
+	SetParent(nullptr);
+
+	// SetParent removes the child from Children and lets the scene know that the hierarchy changed
+	while (!Children.IsEmpty())
 	{
-		SAFEDELETE(CurrentComponent);
+		Children.Back()->SetParent(nullptr);
 	}
 
+	// The components are owned by the scene's ComponentStorage
 	Components.Clear();
 }
 
 void Actor::OnAddedToScene(Scene* InScene)
 {
-	CurrentScene = InScene;
+	VALIDATE(InScene != nullptr);
+
+	CurrentScene	= InScene;
+	Storage			= &InScene->GetComponentStorage();
 }
 
-void Actor::AddComponent(Component* InComponent)
+void Actor::OnAddedComponent(Component* InComponent)
 {
-	VALIDATE(InComponent != nullptr);
-	Components.EmplaceBack(InComponent);
+	CurrentScene->OnAddedComponent(InComponent);
+}
 
+void Actor::SetDebugName(const std::string& InDebugName)
+{
+	DebugName = InDebugName;
+}
+
+void Actor::SetParent(Actor* InParent)
+{
+	if (Parent == InParent)
+	{
+		return;
+	}
+
+	// Make sure that the new parent is not one of the children
+	for (Actor* Ancestor = InParent; Ancestor; Ancestor = Ancestor->Parent)
+	{
+		VALIDATE(Ancestor != this);
+	}
+
+	if (Parent)
+	{
+		TArray<Actor*>& Siblings = Parent->Children;
+		for (UInt32 Index = 0; Index < Siblings.Size(); Index++)
+		{
+			if (Siblings[Index] == this)
+			{
+				Siblings[Index] = Siblings[Siblings.Size() - 1];
+				Siblings.PopBack();
+				break;
+			}
+		}
+	}
+
+	Parent = InParent;
+	if (Parent)
+	{
+		Parent->Children.EmplaceBack(this);
+	}
+
+	Transform.MarkDirty();
 	if (CurrentScene)
 	{
-		CurrentScene->OnAddedComponent(InComponent);
+		CurrentScene->OnActorParentChanged(this);
 	}
 }
 
-void Actor::SetDebugName(const std::string& InDebugName)
+void Actor::UpdateTransform()
 {
-	DebugName = InDebugName;
+	if (CurrentScene)
+	{
+		return;
+	}
+
+	const ::Transform* ParentTransform = nullptr;
+	if (Parent)
+	{
+		Parent->UpdateTransform();
+		ParentTransform = &Parent->Transform;
+	}
+
+	const UInt32 CurrentParentVersion = ParentTransform ? ParentTransform->GetVersion() : 0;
+	if (Transform.IsDirty() || ParentVersion != CurrentParentVersion)
+	{
+		Transform.CalculateMatrix(ParentTransform);
+		ParentVersion = CurrentParentVersion;
+	}
 }
 
 /*
@@ -67,11 +114,35 @@ void Actor::SetDebugName(const std::string& InDebugName)
 
 Transform::Transform()
 	: Matrix()
+	, MatrixInv()
 	, Translation(0.0f, 0.0f, 0.0f)
 	, Scale(1.0f, 1.0f, 1.0f)
 	, Rotation(0.0f, 0.0f, 0.0f)
 {
-	CalculateMatrix();
+	CalculateMatrix(nullptr);
+}
+
+Transform::Transform(const Transform& Other)
+	: Matrix(Other.GetMatrix())
+	, MatrixInv(Other.GetMatrixInverse())
+	, Translation(Other.GetTranslation())
+	, Scale(Other.GetScale())
+	, Rotation(Other.GetRotation())
+	, Version(Other.GetVersion())
+	, Dirty(Other.IsDirty())
+{
+}
+
+Transform& Transform::operator=(const Transform& Other)
+{
+	if (this != &Other)
+	{
+		SetTranslation(Other.GetTranslation());
+		SetScale(Other.GetScale());
+		SetRotation(Other.GetRotation());
+	}
+
+	return *this;
 }
 
 void Transform::SetTranslation(Float x, Float y, Float z)
@@ -81,8 +152,16 @@ void Transform::SetTranslation(Float x, Float y, Float z)
 
 void Transform::SetTranslation(const XMFLOAT3& InPosition)
 {
-	Translation = InPosition;
-	CalculateMatrix();
+	if (Hierarchy)
+	{
+		Hierarchy->Translations[Slot] = InPosition;
+	}
+	else
+	{
+		Translation = InPosition;
+	}
+
+	MarkDirty();
 }
 
 void Transform::SetScale(Float x, Float y, Float z)
@@ -92,8 +171,16 @@ void Transform::SetScale(Float x, Float y, Float z)
 
 void Transform::SetScale(const XMFLOAT3& InScale)
 {
-	Scale = InScale;
-	CalculateMatrix();
+	if (Hierarchy)
+	{
+		Hierarchy->Scales[Slot] = InScale;
+	}
+	else
+	{
+		Scale = InScale;
+	}
+
+	MarkDirty();
 }
 
 void Transform::SetRotation(Float x, Float y, Float z)
@@ -103,22 +190,31 @@ void Transform::SetRotation(Float x, Float y, Float z)
 
 void Transform::SetRotation(const XMFLOAT3& InRotation)
 {
-	Rotation = InRotation;
-	CalculateMatrix();
+	if (Hierarchy)
+	{
+		Hierarchy->Rotations[Slot] = InRotation;
+	}
+	else
+	{
+		Rotation = InRotation;
+	}
+
+	MarkDirty();
 }
 
-void Transform::CalculateMatrix()
+void Transform::CalculateMatrix(const Transform* ParentTransform)
 {
-	XMVECTOR XmTranslation	= XMLoadFloat3(&Translation);
-	XMVECTOR XmScale		= XMLoadFloat3(&Scale);
-	// Convert into Roll, Pitch, Yaw
-	XMVECTOR XmRotation = XMVectorSet(Rotation.z, Rotation.y, Rotation.x, 0.0f);
-	
-	XMMATRIX XmMatrix = XMMatrixMultiply(
-		XMMatrixMultiply(XMMatrixScalingFromVector(XmScale), XMMatrixRotationRollPitchYawFromVector(XmRotation)),
-		XMMatrixTranslationFromVector(XmTranslation));
-	XMStoreFloat4x4(&Matrix, XMMatrixTranspose(XmMatrix));
-
-	XMMATRIX XmMatrixInv = XMMatrixInverse(nullptr, XmMatrix);
-	XMStoreFloat4x4(&MatrixInv, XMMatrixTranspose(XmMatrixInv));
-}
+	VALIDATE(Hierarchy == nullptr);
+
+	TransformHierarchy::CalculateMatrices(
+		Translation,
+		Rotation,
+		Scale,
+		ParentTransform ? &ParentTransform->GetMatrix() : nullptr,
+		ParentTransform ? &ParentTransform->GetMatrixInverse() : nullptr,
+		Matrix,
+		MatrixInv);
+
+	Version	= TransformHierarchy::AllocateVersions(1) + 1;
+	Dirty	= false;
+}
\ No newline at end of file
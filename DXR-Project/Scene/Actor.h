@@ -1,30 +1,15 @@
 #pragma once
 #include "Core/CoreObject.h"
 
-#include <DirectXMath.h>
+#include "Memory/PoolAllocator.h"
 
-/*
-* Component Base-Class
-*/
+#include "Containers/TInlineArray.h"
 
-class Actor;
+#include "Components/ComponentStorage.h"
 
-class Component : public CoreObject
-{
-	CORE_OBJECT(Component, CoreObject);
+#include "TransformHierarchy.h"
 
-public:
-	Component(Actor* InOwningActor);
-	virtual ~Component();
-
-	FORCEINLINE Actor* GetOwningActor() const
-	{
-		return OwningActor;
-	}
-
-protected:
-	Actor* OwningActor = nullptr;
-};
+#include <DirectXMath.h>
 
 /*
 * Transform
@@ -32,10 +17,17 @@ protected:
 
 class Transform
 {
+	friend class TransformHierarchy;
+
 public:
 	Transform();
+	// Copies the values, the copy is not part of a hierarchy
+	Transform(const Transform& Other);
 	~Transform() = default;
 
+	// Copies the values, the transform keeps its slot in the hierarchy
+	Transform& operator=(const Transform& Other);
+
 	void SetTranslation(Float x, Float y, Float z);
 	void SetTranslation(const XMFLOAT3& InPosition);
 
@@ -47,38 +39,72 @@ public:
 
 	FORCEINLINE const XMFLOAT3& GetTranslation() const
 	{
-		return Translation;
+		return Hierarchy ? Hierarchy->Translations[Slot] : Translation;
 	}
 
 	FORCEINLINE const XMFLOAT3& GetScale() const
 	{
-		return Scale;
+		return Hierarchy ? Hierarchy->Scales[Slot] : Scale;
 	}
 
 	FORCEINLINE const XMFLOAT3& GetRotation() const
 	{
-		return Rotation;
+		return Hierarchy ? Hierarchy->Rotations[Slot] : Rotation;
 	}
 
+	// World matrix, updated once per frame by the scene's TransformHierarchy. Use Actor::GetMatrix for actors that
+	// are not in a scene
 	FORCEINLINE const XMFLOAT4X4& GetMatrix() const
 	{
-		return Matrix;
+		return Hierarchy ? Hierarchy->Matrices[Slot] : Matrix;
 	}
 
 	FORCEINLINE const XMFLOAT4X4& GetMatrixInverse() const
 	{
-		return MatrixInv;
+		return Hierarchy ? Hierarchy->MatrixInverses[Slot] : MatrixInv;
 	}
 
-private:
-	void CalculateMatrix();
+	// Changes every time the matrix is recalculated, used to detect moved actors
+	FORCEINLINE UInt32 GetVersion() const
+	{
+		return Hierarchy ? Hierarchy->Versions[Slot] : Version;
+	}
+
+	// True when translation, scale or rotation has changed since the matrix was calculated
+	FORCEINLINE bool IsDirty() const
+	{
+		return Hierarchy ? (Hierarchy->DirtyFlags[Slot] != 0) : Dirty;
+	}
+
+	FORCEINLINE void MarkDirty()
+	{
+		if (Hierarchy)
+		{
+			Hierarchy->DirtyFlags[Slot] = 1;
+		}
+		else
+		{
+			Dirty = true;
+		}
+	}
+
+	// Calculates the world matrix from the local translation, scale and rotation. Only used for transforms that are
+	// not part of a hierarchy. ParentTransform can be nullptr
+	void CalculateMatrix(const Transform* ParentTransform);
 
 private:
+	// Only used while the transform is not part of a hierarchy, after that the values are stored in the slot
 	XMFLOAT4X4	Matrix;
 	XMFLOAT4X4	MatrixInv;
 	XMFLOAT3	Translation;
 	XMFLOAT3	Scale;
 	XMFLOAT3	Rotation;
+	UInt32		Version = 0;
+	bool		Dirty	= true;
+
+	// Set when the actor is added to a scene, the slot changes when the hierarchy is sorted
+	TransformHierarchy*	Hierarchy	= nullptr;
+	UInt32				Slot		= 0;
 };
 
 /*
@@ -90,20 +116,34 @@ class Scene;
 class Actor : public CoreObject
 {
 	CORE_OBJECT(Actor, CoreObject);
+	POOL_ALLOCATED(Actor);
 
 public:
 	Actor();
 	~Actor();
 
-	void AddComponent(Component* InComponent);
+	// Components are stored in the scene, so the actor has to be added to a scene first. The component is copied into
+	// the storage, the returned pointer stays valid as long as the scene
+	template<typename TComponent>
+	FORCEINLINE TComponent* AddComponent(const TComponent& InComponent)
+	{
+		VALIDATE(Storage != nullptr);
+		VALIDATE(InComponent.GetOwningActor() == this);
+
+		const ComponentHandle Handle = Storage->AddComponent(InComponent);
+		Components.EmplaceBack(Handle);
+
+		Component* NewComponent = Storage->GetComponent(Handle);
+		OnAddedComponent(NewComponent);
+		return static_cast<TComponent*>(NewComponent);
+	}
 
 	template<typename TComponent>
 	FORCEINLINE bool HasComponentOfType() const noexcept
 	{
-		TComponent* Result = nullptr;
-		for (Component* Component : Components)
+		for (ComponentHandle Handle : Components)
 		{
-			if (IsSubClassOf<TComponent>(Component))
+			if (Storage->GetClass(Handle)->IsSubClassOf<TComponent>())
 			{
 				return true;
 			}
@@ -116,9 +156,28 @@ public:
 	
 	void SetDebugName(const std::string& InDebugName);
 
+	// The transform becomes relative to the parent, both actors should be in the same scene. InParent can be nullptr
+	void SetParent(Actor* InParent);
+
 	FORCEINLINE void SetTransform(const Transform& InTransform)
 	{
 		Transform = InTransform;
+		Transform.MarkDirty();
+	}
+
+	FORCEINLINE Actor* GetParent() const
+	{
+		return Parent;
+	}
+
+	FORCEINLINE const TArray<Actor*>& GetChildren() const
+	{
+		return Children;
+	}
+
+	FORCEINLINE const TInlineArray<ComponentHandle, 4>& GetComponents() const
+	{
+		return Components;
 	}
 
 	FORCEINLINE const std::string& GetDebugName() const
@@ -141,14 +200,29 @@ public:
 		return Transform;
 	}
 
+	// Actors in a scene get their matrices in Scene::Tick, changes made after that are visible the next frame.
+	// Actors that are not in a scene calculate their matrix here when it is out of date
+	FORCEINLINE const XMFLOAT4X4& GetMatrix()
+	{
+		UpdateTransform();
+		return Transform.GetMatrix();
+	}
+
+	FORCEINLINE const XMFLOAT4X4& GetMatrixInverse()
+	{
+		UpdateTransform();
+		return Transform.GetMatrixInverse();
+	}
+
 	template <typename TComponent>
 	FORCEINLINE TComponent* GetComponentOfType() const
 	{
-		for (Component* Component : Components)
+		for (ComponentHandle Handle : Components)
 		{
-			if (IsSubClassOf<TComponent>(Component))
+			TComponent* Result = Storage->GetComponent<TComponent>(Handle);
+			if (Result)
 			{
-				return static_cast<TComponent*>(Component);
+				return Result;
 			}
 		}
 
@@ -156,10 +230,21 @@ public:
 	}
 
 private:
-	Scene* CurrentScene = nullptr;
+	// Recalculates the matrix of this actor and its ancestors, does nothing for actors in a scene
+	void UpdateTransform();
+
+	void OnAddedComponent(Component* InComponent);
+
+	Scene*				CurrentScene	= nullptr;
+	ComponentStorage*	Storage			= nullptr;
+	Actor* Parent		= nullptr;
 
 	Transform Transform;
+	// Version of the parent's transform that the matrix was calculated with
+	UInt32 ParentVersion = 0;
+
+	TArray<Actor*> Children;
 
-	TArray<Component*>	Components;
-	std::string			DebugName;
+	TInlineArray<ComponentHandle, 4>	Components;
+	std::string							DebugName;
 };
\ No newline at end of file
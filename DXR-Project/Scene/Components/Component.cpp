@@ -0,0 +1,18 @@
+#include "Component.h"
+
+/*
+* Component Base-Class
+*/
+
+Component::Component(Actor* InOwningActor)
+	: CoreObject()
+	, OwningActor(InOwningActor)
+{
+	VALIDATE(InOwningActor != nullptr);
+
+	CORE_OBJECT_INIT();
+}
+
+Component::~Component()
+{
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include "Core/CoreObject.h"
+
+/*
+* Component Base-Class
+*/
+
+class Actor;
+
+class Component : public CoreObject
+{
+	CORE_OBJECT(Component, CoreObject);
+
+public:
+	Component(Actor* InOwningActor);
+	virtual ~Component();
+
+	FORCEINLINE Actor* GetOwningActor() const
+	{
+		return OwningActor;
+	}
+
+protected:
+	Actor* OwningActor = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "ComponentStorage.h"
+
+#include <cstddef>
+
+/*
+* ComponentStorage
+*/
+
+ComponentStorage::ComponentStorage()
+	: Pools()
+{
+}
+
+ComponentStorage::~ComponentStorage()
+{
+	for (ComponentPool& Pool : Pools)
+	{
+		for (UInt32 Index = 0; Index < Pool.NumComponents; Index++)
+		{
+			Pool.GetComponent(Index)->~Component();
+		}
+
+		for (Byte* Chunk : Pool.Chunks)
+		{
+			Memory::Free(Chunk);
+		}
+	}
+
+	Pools.Clear();
+}
+
+ComponentHandle ComponentStorage::AllocateComponent(const ClassType* Class, UInt32 Size, UInt32 Alignment)
+{
+	VALIDATE(Class != nullptr);
+
+	ComponentHandle Handle;
+	Handle.PoolIndex = Pools.Size();
+	for (UInt32 PoolIndex = 0; PoolIndex < Pools.Size(); PoolIndex++)
+	{
+		if (Pools[PoolIndex].Class == Class)
+		{
+			Handle.PoolIndex = PoolIndex;
+			break;
+		}
+	}
+
+	if (Handle.PoolIndex == Pools.Size())
+	{
+		// Chunks come from Memory::Malloc which is aligned for any fundamental type
+		VALIDATE(Alignment <= alignof(std::max_align_t));
+
+		ComponentPool& NewPool = Pools.EmplaceBack();
+		NewPool.Class				= Class;
+		NewPool.ElementSize			= (Size + Alignment - 1) & ~(Alignment - 1);
+		NewPool.ElementsPerChunk	= std::max<UInt32>(ChunkSize / NewPool.ElementSize, 1);
+	}
+
+	ComponentPool& Pool = Pools[Handle.PoolIndex];
+	if (Pool.NumComponents == Pool.Chunks.Size() * Pool.ElementsPerChunk)
+	{
+		Pool.Chunks.EmplaceBack(reinterpret_cast<Byte*>(Memory::Malloc(static_cast<UInt64>(Pool.ElementSize) * Pool.ElementsPerChunk)));
+	}
+
+	Handle.Index = Pool.NumComponents++;
+	NumComponents++;
+	return Handle;
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include "Component.h"
+
+#include "Memory/Memory.h"
+
+/*
+* ComponentHandle - Identifies a component in a ComponentStorage, the component never moves so the handle stays valid
+* until the storage is destroyed
+*/
+
+struct ComponentHandle
+{
+	UInt32 PoolIndex	= 0;
+	UInt32 Index		= 0;
+};
+
+/*
+* ComponentPool - Components of one class stored by value. Elements are allocated in chunks that are never moved or
+* released before the pool is destroyed, so pointers to components stay valid. Components use single inheritance, so
+* the Component base is at the start of each element.
+*/
+
+struct ComponentPool
+{
+	FORCEINLINE Component* GetComponent(UInt32 Index) const
+	{
+		VALIDATE(Index < NumComponents);
+		return reinterpret_cast<Component*>(Chunks[Index / ElementsPerChunk] + (Index % ElementsPerChunk) * ElementSize);
+	}
+
+	const ClassType* Class = nullptr;
+	TArray<Byte*> Chunks;
+	UInt32 ElementSize		= 0;
+	UInt32 ElementsPerChunk	= 0;
+	UInt32 NumComponents	= 0;
+};
+
+/*
+* TComponentView - Typed view of all components in a ComponentStorage that are of type TComponent or a subclass of it.
+* Walks the chunks of the matching pools one after another. Only valid until a new component is added.
+*/
+
+template<typename TComponent>
+class TComponentView
+{
+public:
+	class Iterator
+	{
+	public:
+		FORCEINLINE Iterator(const TArray<ComponentPool>& InPools, const ClassType* InClass, UInt32 InPoolIndex)
+			: Pools(InPools)
+			, Class(InClass)
+			, PoolIndex(InPoolIndex)
+		{
+			FindPool();
+		}
+
+		FORCEINLINE TComponent* operator*() const
+		{
+			return static_cast<TComponent*>(reinterpret_cast<Component*>(Current));
+		}
+
+		FORCEINLINE Iterator& operator++()
+		{
+			Current += ElementSize;
+			if (Current == ChunkEnd)
+			{
+				NextChunk();
+			}
+
+			return *this;
+		}
+
+		FORCEINLINE bool operator==(const Iterator& Other) const
+		{
+			return (Current == Other.Current);
+		}
+
+		FORCEINLINE bool operator!=(const Iterator& Other) const
+		{
+			return (Current != Other.Current);
+		}
+
+	private:
+		// Moves to the first pool at or after PoolIndex that matches the class and has components
+		FORCEINLINE void FindPool()
+		{
+			for (; PoolIndex < Pools.Size(); PoolIndex++)
+			{
+				const ComponentPool& Pool = Pools[PoolIndex];
+				if (Pool.NumComponents > 0 && Pool.Class->IsSubClassOf(Class))
+				{
+					ElementSize	= Pool.ElementSize;
+					ChunkIndex	= 0;
+					SetChunk(Pool);
+					return;
+				}
+			}
+
+			Current		= nullptr;
+			ChunkEnd	= nullptr;
+		}
+
+		FORCEINLINE void NextChunk()
+		{
+			const ComponentPool& Pool = Pools[PoolIndex];
+			ChunkIndex++;
+			if (ChunkIndex * Pool.ElementsPerChunk < Pool.NumComponents)
+			{
+				SetChunk(Pool);
+			}
+			else
+			{
+				PoolIndex++;
+				FindPool();
+			}
+		}
+
+		FORCEINLINE void SetChunk(const ComponentPool& Pool)
+		{
+			const UInt32 NumElements = std::min(Pool.NumComponents - ChunkIndex * Pool.ElementsPerChunk, Pool.ElementsPerChunk);
+			Current		= Pool.Chunks[ChunkIndex];
+			ChunkEnd	= Current + NumElements * ElementSize;
+		}
+
+		const TArray<ComponentPool>& Pools;
+		const ClassType* Class;
+		UInt32	PoolIndex;
+		UInt32	ChunkIndex	= 0;
+		UInt32	ElementSize	= 0;
+		Byte*	Current		= nullptr;
+		Byte*	ChunkEnd	= nullptr;
+	};
+
+	FORCEINLINE TComponentView(const TArray<ComponentPool>& InPools)
+		: Pools(InPools)
+		, Size(0)
+	{
+		const ClassType* Class = TComponent::GetStaticClass();
+		for (const ComponentPool& Pool : Pools)
+		{
+			if (Pool.Class->IsSubClassOf(Class))
+			{
+				Size += Pool.NumComponents;
+			}
+		}
+	}
+
+	FORCEINLINE UInt32 GetSize() const
+	{
+		return Size;
+	}
+
+	FORCEINLINE bool IsEmpty() const
+	{
+		return (Size == 0);
+	}
+
+	FORCEINLINE Iterator begin() const
+	{
+		return Iterator(Pools, TComponent::GetStaticClass(), 0);
+	}
+
+	FORCEINLINE Iterator end() const
+	{
+		return Iterator(Pools, TComponent::GetStaticClass(), Pools.Size());
+	}
+
+private:
+	const TArray<ComponentPool>& Pools;
+	UInt32 Size;
+};
+
+/*
+* ComponentStorage - Owns the components of a scene, stored by value in one pool per class. Queries only read the pools,
+* a scene usually has a handful of component classes so finding the matching pools is a few integer compares. Queries
+* can run on several threads at once, adding components can not run at the same time as anything else.
+*/
+
+class ComponentStorage
+{
+public:
+	static constexpr UInt32 ChunkSize = 16 * 1024;
+
+	ComponentStorage();
+	~ComponentStorage();
+
+	ComponentStorage(const ComponentStorage& Other) = delete;
+	ComponentStorage& operator=(const ComponentStorage& Other) = delete;
+
+	// Copies the component into the pool of its class
+	template<typename TComponent>
+	FORCEINLINE ComponentHandle AddComponent(const TComponent& InComponent)
+	{
+		VALIDATE(InComponent.GetClass() == TComponent::GetStaticClass());
+
+		const ComponentHandle Handle = AllocateComponent(TComponent::GetStaticClass(), sizeof(TComponent), alignof(TComponent));
+		Void* ComponentMemory = Pools[Handle.PoolIndex].GetComponent(Handle.Index);
+		new(ComponentMemory) TComponent(InComponent);
+		return Handle;
+	}
+
+	// Returns nullptr if the component is not of type TComponent or a subclass of it
+	template<typename TComponent>
+	FORCEINLINE TComponent* GetComponent(ComponentHandle Handle) const
+	{
+		const ComponentPool& Pool = Pools[Handle.PoolIndex];
+		return Pool.Class->IsSubClassOf<TComponent>() ? static_cast<TComponent*>(Pool.GetComponent(Handle.Index)) : nullptr;
+	}
+
+	FORCEINLINE Component* GetComponent(ComponentHandle Handle) const
+	{
+		return Pools[Handle.PoolIndex].GetComponent(Handle.Index);
+	}
+
+	FORCEINLINE const ClassType* GetClass(ComponentHandle Handle) const
+	{
+		return Pools[Handle.PoolIndex].Class;
+	}
+
+	// Returns all components that are of type TComponent or a subclass of it
+	template<typename TComponent>
+	FORCEINLINE TComponentView<TComponent> GetComponentsOfType() const
+	{
+		return TComponentView<TComponent>(Pools);
+	}
+
+	FORCEINLINE UInt32 GetNumComponents() const
+	{
+		return NumComponents;
+	}
+
+private:
+	// Reserves room for a component of the class, the caller constructs it
+	ComponentHandle AllocateComponent(const ClassType* Class, UInt32 Size, UInt32 Alignment);
+
+	// One pool for each class of component that has been added
+	TArray<ComponentPool> Pools;
+	UInt32 NumComponents = 0;
+};
@@ -1,5 +1,5 @@
 #pragma once
-#include "Scene/Actor.h"
+#include "Component.h"
 
 /*
 * MeshComponent
@@ -14,6 +14,7 @@ public:
 		: Component(InOwningActor)
 		, Material(nullptr)
 		, Mesh(nullptr)
+		, LODs()
 	{
 		CORE_OBJECT_INIT();
 	}
@@ -22,4 +23,7 @@ public:
 
 	TSharedPtr<class Material>	Material;
 	TSharedPtr<class Mesh>		Mesh;
+
+	// Simplified versions of Mesh ordered by increasing LODError, selected by the Renderer based on the size on screen
+	TArray<TSharedPtr<class Mesh>> LODs;
 };
\ No newline at end of file
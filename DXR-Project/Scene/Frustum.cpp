@@ -1,13 +1,64 @@
 #include "PreCompiled.h"
 #include "Frustum.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+#endif
+
+/*
+* Helpers
+*/
+
+// A box is outside if it is fully behind any of the planes, the projected radius of the box is |N| dot Extent
+static FORCEINLINE bool CheckCenterExtent(const XMFLOAT4* Planes, Float Cx, Float Cy, Float Cz, Float Ex, Float Ey, Float Ez)
+{
+	for (UInt32 Index = 0; Index < 6; Index++)
+	{
+		const XMFLOAT4& Plane = Planes[Index];
+		const Float Distance	= (Plane.x * Cx) + (Plane.y * Cy) + (Plane.z * Cz) + Plane.w;
+		const Float Radius		= (fabsf(Plane.x) * Ex) + (fabsf(Plane.y) * Ey) + (fabsf(Plane.z) * Ez);
+		if (Distance + Radius < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// The point where three planes meet, the planes are assumed to not be parallel
+static XMFLOAT3 IntersectPlanes(const XMFLOAT4& First, const XMFLOAT4& Second, const XMFLOAT4& Third)
+{
+	auto Cross = [](const XMFLOAT4& A, const XMFLOAT4& B)
+	{
+		return XMFLOAT3((A.y * B.z) - (A.z * B.y), (A.z * B.x) - (A.x * B.z), (A.x * B.y) - (A.y * B.x));
+	};
+
+	const XMFLOAT3 Cross23 = Cross(Second, Third);
+	const XMFLOAT3 Cross31 = Cross(Third, First);
+	const XMFLOAT3 Cross12 = Cross(First, Second);
+
+	const Float Denominator = (First.x * Cross23.x) + (First.y * Cross23.y) + (First.z * Cross23.z);
+	const Float Scale = -1.0f / Denominator;
+	return XMFLOAT3(
+		((First.w * Cross23.x) + (Second.w * Cross31.x) + (Third.w * Cross12.x)) * Scale,
+		((First.w * Cross23.y) + (Second.w * Cross31.y) + (Third.w * Cross12.y)) * Scale,
+		((First.w * Cross23.z) + (Second.w * Cross31.z) + (Third.w * Cross12.z)) * Scale);
+}
+
+/*
+* Frustum
+*/
+
 Frustum::Frustum()
 	: Planes()
+	, Corners()
 {
 }
 
 Frustum::Frustum(Float FarPlane, const XMFLOAT4X4& View, const XMFLOAT4X4& Projection)
 	: Planes()
+	, Corners()
 {
 	Create(FarPlane, View, Projection);
 }
@@ -82,70 +133,158 @@ void Frustum::Create(Float FarPlane, const XMFLOAT4X4& View, const XMFLOAT4X4& P
 	XmPlanes[5] = XMLoadFloat4(&Planes[5]);
 	XmPlanes[5] = XMPlaneNormalize(XmPlanes[5]);
 	XMStoreFloat4(&Planes[5], XmPlanes[5]);
+
+	CalculateCorners();
+}
+
+bool Frustum::CheckAABB(const AABB& Box) const
+{
+	const XMFLOAT3 Center = Box.GetCenter();
+	const XMFLOAT3 Extent = XMFLOAT3(fabsf(Box.GetWidth()) * 0.5f, fabsf(Box.GetHeight()) * 0.5f, fabsf(Box.GetDepth()) * 0.5f);
+	return CheckCenterExtent(Planes, Center.x, Center.y, Center.z, Extent.x, Extent.y, Extent.z);
 }
 
-bool Frustum::CheckAABB(const AABB& Box)
+EFrustumContainment Frustum::ContainsAABB(const AABB& Box) const
 {
-	const XMFLOAT3 Center	= Box.GetCenter();
-	const Float Width		= Box.GetWidth()	/ 2.0f;
-	const Float Height	= Box.GetHeight()	/ 2.0f;
-	const Float Depth		= Box.GetDepth()	/ 2.0f;
-
-	XMVECTOR Coords[8];
-	Coords[0] = XMVectorSet((Center.x - Width), (Center.y - Height), (Center.z - Depth), 1.0f);
-	Coords[1] = XMVectorSet((Center.x + Width), (Center.y - Height), (Center.z - Depth), 1.0f);
-	Coords[2] = XMVectorSet((Center.x - Width), (Center.y + Height), (Center.z - Depth), 1.0f);
-	Coords[3] = XMVectorSet((Center.x + Width), (Center.y + Height), (Center.z - Depth), 1.0f);
-	Coords[4] = XMVectorSet((Center.x - Width), (Center.y - Height), (Center.z + Depth), 1.0f);
-	Coords[5] = XMVectorSet((Center.x + Width), (Center.y - Height), (Center.z + Depth), 1.0f);
-	Coords[6] = XMVectorSet((Center.x - Width), (Center.y + Height), (Center.z + Depth), 1.0f);
-	Coords[7] = XMVectorSet((Center.x + Width), (Center.y + Height), (Center.z + Depth), 1.0f);
-
-	for (Int32 Index = 0; Index < 6; Index++)
+	const XMFLOAT3 Center = Box.GetCenter();
+	const XMFLOAT3 Extent = XMFLOAT3(fabsf(Box.GetWidth()) * 0.5f, fabsf(Box.GetHeight()) * 0.5f, fabsf(Box.GetDepth()) * 0.5f);
+
+	EFrustumContainment Result = EFrustumContainment::FRUSTUM_CONTAINMENT_INSIDE;
+	for (UInt32 Index = 0; Index < 6; Index++)
 	{
-		XMVECTOR Plane = XMLoadFloat4(&Planes[Index]);
-		if (XMPlaneDotCoord(Plane, Coords[0]).m128_f32[0] >= 0.0f)
+		const XMFLOAT4& Plane = Planes[Index];
+		const Float Distance	= (Plane.x * Center.x) + (Plane.y * Center.y) + (Plane.z * Center.z) + Plane.w;
+		const Float Radius		= (fabsf(Plane.x) * Extent.x) + (fabsf(Plane.y) * Extent.y) + (fabsf(Plane.z) * Extent.z);
+		if (Distance + Radius < 0.0f)
 		{
-			continue;
+			return EFrustumContainment::FRUSTUM_CONTAINMENT_OUTSIDE;
 		}
-
-		if (XMPlaneDotCoord(Plane, Coords[1]).m128_f32[0] >= 0.0f)
+		else if (Distance - Radius < 0.0f)
 		{
-			continue;
+			Result = EFrustumContainment::FRUSTUM_CONTAINMENT_INTERSECTS;
 		}
+	}
 
-		if (XMPlaneDotCoord(Plane, Coords[2]).m128_f32[0] >= 0.0f)
-		{
-			continue;
-		}
+	return Result;
+}
 
-		if (XMPlaneDotCoord(Plane, Coords[3]).m128_f32[0] >= 0.0f)
-		{
-			continue;
-		}
+void Frustum::CheckAABBs(const AABBList& Boxes, const UInt32* Indices, UInt32 Count, UInt8* OutVisible) const
+{
+	const Float* CenterX = Boxes.CenterX.Data();
+	const Float* CenterY = Boxes.CenterY.Data();
+	const Float* CenterZ = Boxes.CenterZ.Data();
+	const Float* ExtentX = Boxes.ExtentX.Data();
+	const Float* ExtentY = Boxes.ExtentY.Data();
+	const Float* ExtentZ = Boxes.ExtentZ.Data();
 
-		if (XMPlaneDotCoord(Plane, Coords[4]).m128_f32[0] >= 0.0f)
-		{
-			continue;
-		}
+	UInt32 Index = 0;
 
-		if (XMPlaneDotCoord(Plane, Coords[5]).m128_f32[0] >= 0.0f)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		const UInt32 I0 = Indices[Index + 0];
+		const UInt32 I1 = Indices[Index + 1];
+		const UInt32 I2 = Indices[Index + 2];
+		const UInt32 I3 = Indices[Index + 3];
+		VALIDATE(I0 < Boxes.Size() && I1 < Boxes.Size() && I2 < Boxes.Size() && I3 < Boxes.Size());
+
+		const __m128 Cx = _mm_setr_ps(CenterX[I0], CenterX[I1], CenterX[I2], CenterX[I3]);
+		const __m128 Cy = _mm_setr_ps(CenterY[I0], CenterY[I1], CenterY[I2], CenterY[I3]);
+		const __m128 Cz = _mm_setr_ps(CenterZ[I0], CenterZ[I1], CenterZ[I2], CenterZ[I3]);
+		const __m128 Ex = _mm_setr_ps(ExtentX[I0], ExtentX[I1], ExtentX[I2], ExtentX[I3]);
+		const __m128 Ey = _mm_setr_ps(ExtentY[I0], ExtentY[I1], ExtentY[I2], ExtentY[I3]);
+		const __m128 Ez = _mm_setr_ps(ExtentZ[I0], ExtentZ[I1], ExtentZ[I2], ExtentZ[I3]);
+
+		__m128 Inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (UInt32 PlaneIndex = 0; PlaneIndex < 6; PlaneIndex++)
 		{
-			continue;
+			const XMFLOAT4& Plane = Planes[PlaneIndex];
+			const __m128 Nx = _mm_set1_ps(Plane.x);
+			const __m128 Ny = _mm_set1_ps(Plane.y);
+			const __m128 Nz = _mm_set1_ps(Plane.z);
+
+			// Distance from the center plus the projected radius of the box onto the plane normal
+			__m128 Distance = _mm_add_ps(_mm_mul_ps(Nx, Cx), _mm_set1_ps(Plane.w));
+			Distance = _mm_add_ps(Distance, _mm_mul_ps(Ny, Cy));
+			Distance = _mm_add_ps(Distance, _mm_mul_ps(Nz, Cz));
+			Distance = _mm_add_ps(Distance, _mm_mul_ps(_mm_set1_ps(fabsf(Plane.x)), Ex));
+			Distance = _mm_add_ps(Distance, _mm_mul_ps(_mm_set1_ps(fabsf(Plane.y)), Ey));
+			Distance = _mm_add_ps(Distance, _mm_mul_ps(_mm_set1_ps(fabsf(Plane.z)), Ez));
+
+			Inside = _mm_and_ps(Inside, _mm_cmpge_ps(Distance, _mm_setzero_ps()));
 		}
 
-		if (XMPlaneDotCoord(Plane, Coords[6]).m128_f32[0] >= 0.0f)
+		const Int32 Mask = _mm_movemask_ps(Inside);
+		for (UInt32 Lane = 0; Lane < 4; Lane++)
 		{
-			continue;
+			OutVisible[Index + Lane] = static_cast<UInt8>((Mask >> Lane) & 1);
 		}
+	}
+#endif
+
+	for (; Index < Count; Index++)
+	{
+		const UInt32 BoxIndex = Indices[Index];
+		VALIDATE(BoxIndex < Boxes.Size());
+
+		const bool Visible = CheckCenterExtent(Planes, CenterX[BoxIndex], CenterY[BoxIndex], CenterZ[BoxIndex], ExtentX[BoxIndex], ExtentY[BoxIndex], ExtentZ[BoxIndex]);
+		OutVisible[Index] = Visible ? 1 : 0;
+	}
+}
+
+Frustum Frustum::Expand(Float Distance) const
+{
+	// The planes are normalized, so moving them along the normal only changes the distance term
+	Frustum Result = *this;
+	for (XMFLOAT4& Plane : Result.Planes)
+	{
+		Plane.w += Distance;
+	}
+
+	Result.CalculateCorners();
+	return Result;
+}
 
-		if (XMPlaneDotCoord(Plane, Coords[7]).m128_f32[0] >= 0.0f)
+bool Frustum::IsInside(const Frustum& Outer) const
+{
+	// Both frustums are convex, so this one is inside if all of its corners are
+	for (const XMFLOAT3& Corner : Corners)
+	{
+		for (const XMFLOAT4& Plane : Outer.Planes)
 		{
-			continue;
+			if ((Plane.x * Corner.x) + (Plane.y * Corner.y) + (Plane.z * Corner.z) + Plane.w < 0.0f)
+			{
+				return false;
+			}
 		}
-
-		return false;
 	}
 
 	return true;
 }
+
+Float Frustum::GetDepth() const
+{
+	// Distance from the near plane to the furthest far corner
+	const XMFLOAT4& NearPlane = Planes[0];
+
+	Float Depth = 0.0f;
+	for (UInt32 Index = 4; Index < 8; Index++)
+	{
+		const XMFLOAT3& Corner = Corners[Index];
+		Depth = fmaxf(Depth, (NearPlane.x * Corner.x) + (NearPlane.y * Corner.y) + (NearPlane.z * Corner.z) + NearPlane.w);
+	}
+
+	return Depth;
+}
+
+void Frustum::CalculateCorners()
+{
+	// Corners zero to three are on the near plane and four to seven on the far plane
+	for (UInt32 Index = 0; Index < 8; Index++)
+	{
+		const XMFLOAT4& First	= Planes[(Index < 4) ? 0 : 1];
+		const XMFLOAT4& Second	= Planes[(Index & 1) ? 3 : 2];
+		const XMFLOAT4& Third	= Planes[(Index & 2) ? 5 : 4];
+		Corners[Index] = IntersectPlanes(First, Second, Third);
+	}
+}
@@ -4,6 +4,17 @@ using namespace DirectX;
 
 #include "AABB.h"
 
+/*
+* EFrustumContainment
+*/
+
+enum class EFrustumContainment : UInt32
+{
+	FRUSTUM_CONTAINMENT_OUTSIDE		= 0,
+	FRUSTUM_CONTAINMENT_INTERSECTS	= 1,
+	FRUSTUM_CONTAINMENT_INSIDE		= 2,
+};
+
 /*
 * Frustum
 */
@@ -17,8 +28,29 @@ public:
 
 	void Create(Float ScreenDepth, const XMFLOAT4X4& View, const XMFLOAT4X4& Projection);
 
-	bool CheckAABB(const AABB& BoundingBox);
+	bool CheckAABB(const AABB& BoundingBox) const;
+
+	// Same as CheckAABB but also reports if the box is fully inside, used for hierarchical culling
+	EFrustumContainment ContainsAABB(const AABB& BoundingBox) const;
+
+	/*
+	* Tests the boxes Boxes[Indices[N]] for N in the range [0, Count), OutVisible[N] is set to one for boxes that intersect
+	* the frustum. Uses SSE2 to test four boxes at once, which every x64 target supports.
+	*/
+	void CheckAABBs(const AABBList& Boxes, const UInt32* Indices, UInt32 Count, UInt8* OutVisible) const;
+
+	// Moves every plane outwards by Distance, boxes that are close to the frustum are also accepted
+	Frustum Expand(Float Distance) const;
+
+	// True when all corners of this frustum are inside Outer, used to check if a view is still covered by a larger one
+	bool IsInside(const Frustum& Outer) const;
+
+	// Distance between the near and the far plane
+	Float GetDepth() const;
 
 private:
+	void CalculateCorners();
+
 	XMFLOAT4 Planes[6];
+	XMFLOAT3 Corners[8];
 };
\ No newline at end of file
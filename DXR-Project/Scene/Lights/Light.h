@@ -1,6 +1,8 @@
 #pragma once
 #include "Core/CoreObject.h"
 
+#include "Memory/PoolAllocator.h"
+
 /*
 * Light
 */
@@ -8,6 +10,7 @@
 class Light : public CoreObject
 {
 	CORE_OBJECT(Light, CoreObject);
+	POOL_ALLOCATED(Light);
 
 public:
 	Light();
@@ -0,0 +1,738 @@
+#include "ObjLoader.h"
+
+#include "Core/MappedFile.h"
+#include "Core/JobSystem.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#define OBJ_INDEX_MISSING	(~0u)
+#define OBJ_INDEX_INVALID	(~0u - 1)
+
+/*
+* Parsing helpers
+*/
+
+static FORCEINLINE bool IsSpace(Char C)
+{
+	return (C == ' ') || (C == '\t');
+}
+
+static FORCEINLINE bool IsLineEnd(Char C)
+{
+	return (C == '\n') || (C == '\r');
+}
+
+static FORCEINLINE bool IsDigit(Char C)
+{
+	return (C >= '0') && (C <= '9');
+}
+
+static FORCEINLINE const Char* SkipSpaces(const Char* It, const Char* End)
+{
+	while (It < End && IsSpace(*It))
+	{
+		It++;
+	}
+
+	return It;
+}
+
+static FORCEINLINE const Char* SkipToken(const Char* It, const Char* End)
+{
+	while (It < End && !IsSpace(*It) && !IsLineEnd(*It))
+	{
+		It++;
+	}
+
+	return It;
+}
+
+static FORCEINLINE const Char* SkipLine(const Char* It, const Char* End)
+{
+	const Char* LineEnd = reinterpret_cast<const Char*>(memchr(It, '\n', static_cast<size_t>(End - It)));
+	return LineEnd ? (LineEnd + 1) : End;
+}
+
+// Returns true if the line starts with the keyword followed by a whitespace
+static FORCEINLINE bool MatchKeyword(const Char* It, const Char* End, const Char* Keyword)
+{
+	while (*Keyword)
+	{
+		if (It >= End || *It != *Keyword)
+		{
+			return false;
+		}
+
+		It++;
+		Keyword++;
+	}
+
+	return (It >= End) || IsSpace(*It) || IsLineEnd(*It);
+}
+
+// The rest of the line without surrounding whitespace
+static std::string ParseName(const Char* It, const Char* End)
+{
+	It = SkipSpaces(It, End);
+
+	const Char* NameEnd = It;
+	while (NameEnd < End && !IsLineEnd(*NameEnd))
+	{
+		NameEnd++;
+	}
+
+	while (NameEnd > It && IsSpace(NameEnd[-1]))
+	{
+		NameEnd--;
+	}
+
+	return std::string(It, NameEnd);
+}
+
+static const Char* ParseFloatSlow(const Char* It, const Char* End, Float& OutValue)
+{
+	Char Buffer[64];
+	UInt32 Length = 0;
+	while (It < End && !IsSpace(*It) && !IsLineEnd(*It) && Length < sizeof(Buffer) - 1)
+	{
+		Buffer[Length++] = *It++;
+	}
+
+	Buffer[Length] = '\0';
+	OutValue = strtof(Buffer, nullptr);
+	return SkipToken(It, End);
+}
+
+// Decimals with at most 19 significant digits and a small exponent are converted with a single double multiplication or
+// division (Clinger's fast path), everything else falls back to strtof
+static const Char* ParseFloat(const Char* It, const Char* End, Float& OutValue)
+{
+	static const Double PowersOf10[] =
+	{
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+
+	It = SkipSpaces(It, End);
+	const Char* Start = It;
+
+	bool IsNegative = false;
+	if (It < End && (*It == '-' || *It == '+'))
+	{
+		IsNegative = (*It == '-');
+		It++;
+	}
+
+	UInt64	Mantissa	= 0;
+	Int32	Exponent	= 0;
+	UInt32	NumDigits	= 0;
+	bool	HasDigits	= false;
+	bool	IsTruncated	= false;
+	while (It < End && IsDigit(*It))
+	{
+		if (NumDigits < 19)
+		{
+			Mantissa = Mantissa * 10 + static_cast<UInt64>(*It - '0');
+			NumDigits += (Mantissa > 0) ? 1 : 0;
+		}
+		else
+		{
+			IsTruncated = true;
+		}
+
+		HasDigits = true;
+		It++;
+	}
+
+	if (It < End && *It == '.')
+	{
+		It++;
+		while (It < End && IsDigit(*It))
+		{
+			if (NumDigits < 19)
+			{
+				Mantissa = Mantissa * 10 + static_cast<UInt64>(*It - '0');
+				NumDigits += (Mantissa > 0) ? 1 : 0;
+				Exponent--;
+			}
+			else
+			{
+				IsTruncated = true;
+			}
+
+			HasDigits = true;
+			It++;
+		}
+	}
+
+	// Inf and nan
+	if (!HasDigits)
+	{
+		return ParseFloatSlow(Start, End, OutValue);
+	}
+
+	if (It < End && (*It == 'e' || *It == 'E'))
+	{
+		It++;
+
+		bool IsExponentNegative = false;
+		if (It < End && (*It == '-' || *It == '+'))
+		{
+			IsExponentNegative = (*It == '-');
+			It++;
+		}
+
+		if (It >= End || !IsDigit(*It))
+		{
+			return ParseFloatSlow(Start, End, OutValue);
+		}
+
+		Int32 ExplicitExponent = 0;
+		while (It < End && IsDigit(*It))
+		{
+			if (ExplicitExponent < 10000)
+			{
+				ExplicitExponent = ExplicitExponent * 10 + (*It - '0');
+			}
+
+			It++;
+		}
+
+		Exponent += IsExponentNegative ? -ExplicitExponent : ExplicitExponent;
+	}
+
+	if (It < End && !IsSpace(*It) && !IsLineEnd(*It))
+	{
+		return ParseFloatSlow(Start, End, OutValue);
+	}
+
+	if (!IsTruncated && Mantissa <= (1ull << 53) && Exponent >= -22 && Exponent <= 22)
+	{
+		Double Value = static_cast<Double>(Mantissa);
+		Value = (Exponent < 0) ? (Value / PowersOf10[-Exponent]) : (Value * PowersOf10[Exponent]);
+
+		// The double is correctly rounded, converting it to float only differs from rounding the exact value if it is
+		// exactly halfway between two floats
+		UInt64 Bits;
+		memcpy(&Bits, &Value, sizeof(Bits));
+		if ((Bits & 0x1fffffff) != 0x10000000)
+		{
+			OutValue = static_cast<Float>(IsNegative ? -Value : Value);
+			return It;
+		}
+	}
+
+	return ParseFloatSlow(Start, End, OutValue);
+}
+
+static FORCEINLINE const Char* ParseIndex(const Char* It, const Char* End, Int32& OutValue, bool& OutHasValue)
+{
+	bool IsNegative = false;
+	if (It < End && *It == '-')
+	{
+		IsNegative = true;
+		It++;
+	}
+
+	Int64 Value = 0;
+	OutHasValue = false;
+	while (It < End && IsDigit(*It))
+	{
+		if (Value <= INT32_MAX)
+		{
+			Value = Value * 10 + (*It - '0');
+		}
+
+		OutHasValue = true;
+		It++;
+	}
+
+	Value		= (Value > INT32_MAX) ? INT32_MAX : Value;
+	OutValue	= static_cast<Int32>(IsNegative ? -Value : Value);
+	return It;
+}
+
+/*
+* ObjChunk - Result of parsing a line-aligned part of the file. Positive indices are global and zero based, negative
+* indices are relative to the number of attributes the chunk has seen so far and are fixed up once all chunks are done.
+*/
+
+struct ObjEvent
+{
+	// Triangle that the event applies to, local to the chunk
+	UInt32		Triangle	= 0;
+	bool		IsMaterial	= false;
+	std::string	Name;
+};
+
+struct ObjChunk
+{
+	const Char* Begin	= nullptr;
+	const Char* End		= nullptr;
+
+	TArray<Float> Positions;
+	TArray<Float> TexCoords;
+	TArray<Float> Normals;
+
+	// Three indices for each corner of each triangle: position, texcoord and normal
+	TArray<UInt32> Corners;
+	TArray<UInt32> RelativeCorners;
+
+	TArray<ObjEvent> Events;
+	std::string MaterialLibrary;
+
+	// Offsets of this chunk in the merged arrays
+	UInt32 PositionBase	= 0;
+	UInt32 TexCoordBase	= 0;
+	UInt32 NormalBase	= 0;
+	UInt32 CornerBase	= 0;
+};
+
+struct ObjCorner
+{
+	UInt32	Indices[3];
+	UInt32	RelativeMask;
+};
+
+static const Char* ParseFace(const Char* It, const Char* End, ObjChunk& Chunk, TArray<ObjCorner>& Polygon)
+{
+	const UInt32 NumLocal[3] =
+	{
+		Chunk.Positions.Size() / 3,
+		Chunk.TexCoords.Size() / 2,
+		Chunk.Normals.Size() / 3,
+	};
+
+	Polygon.Clear();
+	for (;;)
+	{
+		It = SkipSpaces(It, End);
+		if (It >= End || IsLineEnd(*It))
+		{
+			break;
+		}
+
+		// v, v/vt, v//vn or v/vt/vn
+		Int32	Values[3]		= { 0, 0, 0 };
+		bool	HasValues[3]	= { false, false, false };
+		It = ParseIndex(It, End, Values[0], HasValues[0]);
+		if (It < End && *It == '/')
+		{
+			It = ParseIndex(It + 1, End, Values[1], HasValues[1]);
+			if (It < End && *It == '/')
+			{
+				It = ParseIndex(It + 1, End, Values[2], HasValues[2]);
+			}
+		}
+
+		It = SkipToken(It, End);
+
+		ObjCorner& Corner = Polygon.EmplaceBack();
+		Corner.RelativeMask = 0;
+		for (UInt32 Attribute = 0; Attribute < 3; Attribute++)
+		{
+			const Int32 Value = Values[Attribute];
+			if (!HasValues[Attribute])
+			{
+				Corner.Indices[Attribute] = (Attribute == 0) ? OBJ_INDEX_INVALID : OBJ_INDEX_MISSING;
+			}
+			else if (Value > 0)
+			{
+				Corner.Indices[Attribute] = static_cast<UInt32>(Value - 1);
+			}
+			else if (Value < 0)
+			{
+				Corner.Indices[Attribute] = static_cast<UInt32>(static_cast<Int32>(NumLocal[Attribute]) + Value);
+				Corner.RelativeMask |= (1 << Attribute);
+			}
+			else
+			{
+				Corner.Indices[Attribute] = OBJ_INDEX_INVALID;
+			}
+		}
+	}
+
+	// Triangulate as a fan
+	for (UInt32 Index = 2; Index < Polygon.Size(); Index++)
+	{
+		const ObjCorner* Triangle[3] = { &Polygon[0], &Polygon[Index - 1], &Polygon[Index] };
+		for (const ObjCorner* Corner : Triangle)
+		{
+			for (UInt32 Attribute = 0; Attribute < 3; Attribute++)
+			{
+				if (Corner->RelativeMask & (1 << Attribute))
+				{
+					Chunk.RelativeCorners.EmplaceBack(Chunk.Corners.Size());
+				}
+
+				Chunk.Corners.EmplaceBack(Corner->Indices[Attribute]);
+			}
+		}
+	}
+
+	return It;
+}
+
+static void ParseChunk(ObjChunk& Chunk)
+{
+	TArray<ObjCorner> Polygon;
+
+	const Char* It	= Chunk.Begin;
+	const Char* End	= Chunk.End;
+	while (It < End)
+	{
+		It = SkipSpaces(It, End);
+		if (It >= End)
+		{
+			break;
+		}
+
+		switch (*It)
+		{
+			case 'v':
+			{
+				Float Values[3];
+				if (MatchKeyword(It, End, "v"))
+				{
+					It = ParseFloat(It + 1, End, Values[0]);
+					It = ParseFloat(It, End, Values[1]);
+					It = ParseFloat(It, End, Values[2]);
+					Chunk.Positions.EmplaceBack(Values[0]);
+					Chunk.Positions.EmplaceBack(Values[1]);
+					Chunk.Positions.EmplaceBack(Values[2]);
+				}
+				else if (MatchKeyword(It, End, "vt"))
+				{
+					It = ParseFloat(It + 2, End, Values[0]);
+					It = ParseFloat(It, End, Values[1]);
+					Chunk.TexCoords.EmplaceBack(Values[0]);
+					Chunk.TexCoords.EmplaceBack(Values[1]);
+				}
+				else if (MatchKeyword(It, End, "vn"))
+				{
+					It = ParseFloat(It + 2, End, Values[0]);
+					It = ParseFloat(It, End, Values[1]);
+					It = ParseFloat(It, End, Values[2]);
+					Chunk.Normals.EmplaceBack(Values[0]);
+					Chunk.Normals.EmplaceBack(Values[1]);
+					Chunk.Normals.EmplaceBack(Values[2]);
+				}
+
+				break;
+			}
+
+			case 'f':
+			{
+				if (MatchKeyword(It, End, "f"))
+				{
+					It = ParseFace(It + 1, End, Chunk, Polygon);
+				}
+
+				break;
+			}
+
+			case 'g':
+			case 'o':
+			{
+				if (MatchKeyword(It, End, "g") || MatchKeyword(It, End, "o"))
+				{
+					ObjEvent& Event = Chunk.Events.EmplaceBack();
+					Event.Triangle		= Chunk.Corners.Size() / 9;
+					Event.IsMaterial	= false;
+					Event.Name			= ParseName(It + 1, End);
+				}
+
+				break;
+			}
+
+			case 'u':
+			{
+				if (MatchKeyword(It, End, "usemtl"))
+				{
+					ObjEvent& Event = Chunk.Events.EmplaceBack();
+					Event.Triangle		= Chunk.Corners.Size() / 9;
+					Event.IsMaterial	= true;
+					Event.Name			= ParseName(It + 6, End);
+				}
+
+				break;
+			}
+
+			case 'm':
+			{
+				if (MatchKeyword(It, End, "mtllib") && Chunk.MaterialLibrary.empty())
+				{
+					Chunk.MaterialLibrary = ParseName(It + 6, End);
+				}
+
+				break;
+			}
+		}
+
+		It = SkipLine(It, End);
+	}
+}
+
+/*
+* ObjLoader
+*/
+
+bool ObjLoader::LoadFromFile(const std::string& Filepath, TArray<ObjShape>& OutShapes, std::string& OutMaterialLibrary)
+{
+	OutShapes.Clear();
+	OutMaterialLibrary.clear();
+
+	MappedFile File;
+	if (!File.Open(Filepath))
+	{
+		return false;
+	}
+
+	return LoadFromMemory(reinterpret_cast<const Char*>(File.GetData()), File.GetSize(), OutShapes, OutMaterialLibrary);
+}
+
+bool ObjLoader::LoadFromMemory(const Char* FileData, UInt64 FileSize, TArray<ObjShape>& OutShapes, std::string& OutMaterialLibrary)
+{
+	OutShapes.Clear();
+	OutMaterialLibrary.clear();
+
+	if (FileSize == 0)
+	{
+		return true;
+	}
+
+	// Split the file into chunks that start at the beginning of a line, enough for all threads to stay busy
+	const UInt64 MinChunkSize	= 1024 * 1024;
+	const UInt64 MaxChunks		= static_cast<UInt64>(JobSystem::GetNumThreads()) * 4;
+
+	UInt64 NumChunks = (FileSize + MinChunkSize - 1) / MinChunkSize;
+	NumChunks = (NumChunks < MaxChunks) ? NumChunks : MaxChunks;
+	NumChunks = (NumChunks > 0) ? NumChunks : 1;
+
+	TArray<ObjChunk> Chunks(static_cast<UInt32>(NumChunks));
+
+	const Char* FileEnd		= FileData + FileSize;
+	const Char* ChunkBegin	= FileData;
+	for (UInt32 Index = 0; Index < Chunks.Size(); Index++)
+	{
+		const Char* ChunkEnd = FileEnd;
+		if (Index + 1 < Chunks.Size())
+		{
+			ChunkEnd = FileData + (FileSize * (Index + 1)) / NumChunks;
+			ChunkEnd = (ChunkEnd > ChunkBegin) ? SkipLine(ChunkEnd - 1, FileEnd) : ChunkBegin;
+		}
+
+		Chunks[Index].Begin	= ChunkBegin;
+		Chunks[Index].End	= ChunkEnd;
+		ChunkBegin = ChunkEnd;
+	}
+
+	ParallelFor(Chunks.Size(), [&Chunks](UInt32 Index)
+	{
+		ParseChunk(Chunks[Index]);
+	}, 1);
+
+	// Offsets of each chunk in the merged arrays
+	UInt32 NumPositions	= 0;
+	UInt32 NumTexCoords	= 0;
+	UInt32 NumNormals	= 0;
+	UInt32 NumCorners	= 0;
+	for (ObjChunk& Chunk : Chunks)
+	{
+		Chunk.PositionBase	= NumPositions;
+		Chunk.TexCoordBase	= NumTexCoords;
+		Chunk.NormalBase	= NumNormals;
+		Chunk.CornerBase	= NumCorners;
+
+		NumPositions	+= Chunk.Positions.Size() / 3;
+		NumTexCoords	+= Chunk.TexCoords.Size() / 2;
+		NumNormals		+= Chunk.Normals.Size() / 3;
+		NumCorners		+= Chunk.Corners.Size() / 3;
+
+		if (OutMaterialLibrary.empty())
+		{
+			OutMaterialLibrary = Chunk.MaterialLibrary;
+		}
+	}
+
+	// Resolve relative indices and merge the chunks
+	TArray<Float>	Positions(NumPositions * 3);
+	TArray<Float>	TexCoords(NumTexCoords * 2);
+	TArray<Float>	Normals(NumNormals * 3);
+	TArray<UInt32>	Corners(NumCorners * 3);
+	ParallelFor(Chunks.Size(), [&](UInt32 Index)
+	{
+		ObjChunk& Chunk = Chunks[Index];
+
+		const UInt32 Bases[3] = { Chunk.PositionBase, Chunk.TexCoordBase, Chunk.NormalBase };
+		for (UInt32 Slot : Chunk.RelativeCorners)
+		{
+			const Int64 Resolved = static_cast<Int64>(static_cast<Int32>(Chunk.Corners[Slot])) + Bases[Slot % 3];
+			Chunk.Corners[Slot] = (Resolved >= 0) ? static_cast<UInt32>(Resolved) : OBJ_INDEX_INVALID;
+		}
+
+		if (!Chunk.Positions.IsEmpty())
+		{
+			memcpy(Positions.Data() + Chunk.PositionBase * 3, Chunk.Positions.Data(), Chunk.Positions.Size() * sizeof(Float));
+		}
+
+		if (!Chunk.TexCoords.IsEmpty())
+		{
+			memcpy(TexCoords.Data() + Chunk.TexCoordBase * 2, Chunk.TexCoords.Data(), Chunk.TexCoords.Size() * sizeof(Float));
+		}
+
+		if (!Chunk.Normals.IsEmpty())
+		{
+			memcpy(Normals.Data() + Chunk.NormalBase * 3, Chunk.Normals.Data(), Chunk.Normals.Size() * sizeof(Float));
+		}
+
+		if (!Chunk.Corners.IsEmpty())
+		{
+			memcpy(Corners.Data() + Chunk.CornerBase * 3, Chunk.Corners.Data(), Chunk.Corners.Size() * sizeof(UInt32));
+		}
+	}, 1);
+
+	// Split into runs of triangles that belong to the same shape and material
+	struct ObjRun
+	{
+		std::string	Name;
+		std::string	MaterialName;
+		UInt32		FirstTriangle	= 0;
+		UInt32		NumTriangles	= 0;
+	};
+
+	TArray<ObjRun> Runs;
+	std::string CurrentName;
+	std::string CurrentMaterialName;
+	UInt32 RunBegin = 0;
+
+	auto CloseRun = [&](UInt32 Triangle)
+	{
+		if (Triangle > RunBegin)
+		{
+			ObjRun& Run = Runs.EmplaceBack();
+			Run.Name			= CurrentName;
+			Run.MaterialName	= CurrentMaterialName;
+			Run.FirstTriangle	= RunBegin;
+			Run.NumTriangles	= Triangle - RunBegin;
+		}
+
+		RunBegin = Triangle;
+	};
+
+	for (const ObjChunk& Chunk : Chunks)
+	{
+		for (const ObjEvent& Event : Chunk.Events)
+		{
+			CloseRun(Chunk.CornerBase / 3 + Event.Triangle);
+			if (Event.IsMaterial)
+			{
+				CurrentMaterialName = Event.Name;
+			}
+			else
+			{
+				CurrentName = Event.Name;
+			}
+		}
+	}
+
+	CloseRun(NumCorners / 3);
+	Chunks.Clear();
+
+	// Build the vertices of each run, corners with the same indices are welded
+	std::atomic<bool> HasInvalidIndices(false);
+	OutShapes.Resize(Runs.Size());
+	ParallelFor(Runs.Size(), [&](UInt32 RunIndex)
+	{
+		const ObjRun& Run = Runs[RunIndex];
+
+		ObjShape& Shape = OutShapes[RunIndex];
+		Shape.Name			= Run.Name;
+		Shape.MaterialName	= Run.MaterialName;
+
+		const UInt32	RunCorners	= Run.NumTriangles * 3;
+		const UInt32*	RunIndices	= Corners.Data() + static_cast<UInt64>(Run.FirstTriangle) * 9;
+
+		UInt32 TableSize = 1;
+		while (TableSize < RunCorners * 2)
+		{
+			TableSize <<= 1;
+		}
+
+		TArray<UInt32> Table(TableSize, OBJ_INDEX_MISSING);
+		TArray<UInt32> VertexCorners;
+		VertexCorners.Reserve(RunCorners);
+
+		MeshData& Data = Shape.Data;
+		Data.Indices.Resize(RunCorners);
+		Data.Vertices.Reserve(RunCorners);
+		for (UInt32 Corner = 0; Corner < RunCorners; Corner++)
+		{
+			const UInt32* Key = RunIndices + Corner * 3;
+			const bool IsValid =
+				(Key[0] < NumPositions) &&
+				(Key[1] == OBJ_INDEX_MISSING || Key[1] < NumTexCoords) &&
+				(Key[2] == OBJ_INDEX_MISSING || Key[2] < NumNormals);
+			if (!IsValid)
+			{
+				HasInvalidIndices.store(true, std::memory_order_relaxed);
+				return;
+			}
+
+			UInt32 Hash = (Key[0] * 0x9e3779b1u) ^ (Key[1] * 0x85ebca77u) ^ (Key[2] * 0xc2b2ae3du);
+			Hash ^= Hash >> 15;
+
+			UInt32 Slot = Hash & (TableSize - 1);
+			for (;;)
+			{
+				const UInt32 VertexIndex = Table[Slot];
+				if (VertexIndex == OBJ_INDEX_MISSING)
+				{
+					Table[Slot] = Data.Vertices.Size();
+					Data.Indices[Corner] = Data.Vertices.Size();
+					VertexCorners.EmplaceBack(Corner);
+
+					// Normals and texcoords are optional
+					Vertex& NewVertex = Data.Vertices.EmplaceBack();
+					NewVertex = { };
+
+					const Float* Position = Positions.Data() + Key[0] * 3;
+					NewVertex.Position = { Position[0], Position[1], Position[2] };
+
+					if (Key[1] != OBJ_INDEX_MISSING)
+					{
+						const Float* TexCoord = TexCoords.Data() + Key[1] * 2;
+						NewVertex.TexCoord = { TexCoord[0], TexCoord[1] };
+					}
+
+					if (Key[2] != OBJ_INDEX_MISSING)
+					{
+						const Float* Normal = Normals.Data() + Key[2] * 3;
+						NewVertex.Normal = { Normal[0], Normal[1], Normal[2] };
+					}
+
+					break;
+				}
+
+				const UInt32* Other = RunIndices + VertexCorners[VertexIndex] * 3;
+				if (Other[0] == Key[0] && Other[1] == Key[1] && Other[2] == Key[2])
+				{
+					Data.Indices[Corner] = VertexIndex;
+					break;
+				}
+
+				Slot = (Slot + 1) & (TableSize - 1);
+			}
+		}
+	}, 1);
+
+	if (HasInvalidIndices.load(std::memory_order_relaxed))
+	{
+		OutShapes.Clear();
+		return false;
+	}
+
+	return true;
+}
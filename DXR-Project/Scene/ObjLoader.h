@@ -0,0 +1,31 @@
+#pragma once
+#include "Rendering/MeshFactory.h"
+
+#include <string>
+
+/*
+* ObjShape - Triangulated part of a shape in an obj-file that uses a single material
+*/
+
+struct ObjShape
+{
+	std::string	Name;
+	std::string	MaterialName;
+	MeshData	Data;
+};
+
+/*
+* ObjLoader - Loads obj-files by memory mapping them and parsing line-aligned chunks of the file in parallel on the
+* JobSystem. Shapes are split when the material changes and the vertices of each part are welded by their indices, parts
+* are also built in parallel. Materials are not loaded, only the name of the first material library is returned.
+*/
+
+class ObjLoader
+{
+public:
+	// Returns false if the file could not be opened or if a face references an attribute that does not exist
+	static bool LoadFromFile(const std::string& Filepath, TArray<ObjShape>& OutShapes, std::string& OutMaterialLibrary);
+
+	// Parses the contents of an obj-file that is already in memory
+	static bool LoadFromMemory(const Char* Data, UInt64 Size, TArray<ObjShape>& OutShapes, std::string& OutMaterialLibrary);
+};
@@ -1,5 +1,8 @@
 #include "Scene.h"
 
+#include "ObjLoader.h"
+#include "SceneCache.h"
+
 #include "Components/MeshComponent.h"
 
 #include "Rendering/TextureFactory.h"
@@ -10,9 +13,16 @@
 #include "D3D12/D3D12Texture.h"
 #include "D3D12/D3D12Buffer.h"
 
+#include "Core/JobSystem.h"
+
+#include "Containers/THashMap.h"
+
+#include "Time/Clock.h"
+
 #include <tiny_obj_loader.h>
 
-#include <unordered_map>
+#include <fstream>
+#include <map>
 
 Scene* Scene::CurrentScene = nullptr;
 
@@ -41,6 +51,34 @@ Scene::~Scene()
 void Scene::Tick(Timestamp DeltaTime)
 {
 	UNREFERENCED_VARIABLE(DeltaTime);
+
+	// Calculate the world matrices of all transforms that changed since the last frame
+	Hierarchy.Update();
+
+	// Update the bounds of moved actors
+	ParallelForBatch(MeshDrawCommands.Size(), [this](UInt32 Begin, UInt32 End)
+	{
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			const UInt32 Version = MeshDrawCommands[Index].CurrentActor->GetTransform().GetVersion();
+			if (BoundsVersions[Index] != Version)
+			{
+				UpdateWorldBounds(Index, Index + 1);
+				BoundsVersions[Index]	= Version;
+				MovedCommands[Index]	= 1;
+			}
+		}
+	}, 128);
+
+	// The tree is not threadsafe so refit it afterwards
+	for (UInt32 Index = 0; Index < MovedCommands.Size(); Index++)
+	{
+		if (MovedCommands[Index])
+		{
+			SpatialTree.Move(SpatialProxies[Index], WorldBounds.Get(Index));
+			MovedCommands[Index] = 0;
+		}
+	}
 }
 
 void Scene::AddCamera(Camera* InCamera)
@@ -52,15 +90,13 @@ void Scene::AddCamera(Camera* InCamera)
 void Scene::AddActor(Actor* InActor)
 {
 	VALIDATE(InActor != nullptr);
+	// Components are stored in the scene, they are added after the actor
+	VALIDATE(InActor->GetComponents().IsEmpty());
+
 	Actors.EmplaceBack(InActor);
+	Hierarchy.AddActor(InActor);
 
 	InActor->OnAddedToScene(this);
-
-	MeshComponent* Component = InActor->GetComponentOfType<MeshComponent>();
-	if (Component)
-	{
-		AddMeshComponent(Component);
-	}
 }
 
 void Scene::AddLight(Light* InLight)
@@ -78,24 +114,131 @@ void Scene::OnAddedComponent(Component* NewComponent)
 	}
 }
 
+void Scene::OnActorParentChanged(Actor* InActor)
+{
+	UNREFERENCED_VARIABLE(InActor);
+	Hierarchy.OnParentChanged();
+}
+
 Scene* Scene::LoadFromFile(const std::string& Filepath)
 {
-	// Load Scene File
-	std::string Warning;
-	std::string Error;
-	std::vector<tinyobj::shape_t>		Shapes;
-	std::vector<tinyobj::material_t>	Materials;
-	tinyobj::attrib_t Attributes;
+	Clock LoadClock;
 
-	std::string MTLFiledir = std::string(Filepath.begin(), Filepath.begin() + Filepath.find_last_of('/'));
-	if (!tinyobj::LoadObj(&Attributes, &Shapes, &Materials, &Warning, &Error, Filepath.c_str(), MTLFiledir.c_str(), true, false))
+	// Load Scene File
+	MappedFile SourceFile;
+	if (!SourceFile.Open(Filepath))
 	{
-		LOG_WARNING("[Scene]: Failed to load Scene '" + Filepath + "'." + " Warning: " + Warning + " Error: " + Error);
+		LOG_WARNING("[Scene]: Failed to load Scene '" + Filepath + "'.");
 		return nullptr;
 	}
+
+	// The processed meshes are cached next to the scene and are created again when the content of the scene changes
+	const UInt64		SourceHash		= HashMemory(SourceFile.GetData(), SourceFile.GetSize());
+	const std::string	CacheFilepath	= Filepath + ".cooked";
+
+	struct ProcessedShape
+	{
+		TArray<MeshData>			LODData;
+		TArray<Float>				LODErrors;
+		TArray<MeshUploadStorage>	Storage;
+		VertexCacheStatistics		Before;
+		VertexCacheStatistics		After;
+	};
+
+	SceneCache Cache;
+	TArray<SceneCacheShape> Shapes;
+	TArray<ObjShape>		ObjShapes;
+	TArray<ProcessedShape>	ProcessedShapes;
+	std::string MaterialLibrary;
+	if (Cache.Open(CacheFilepath, SourceHash))
+	{
+		Shapes			= Cache.GetShapes();
+		MaterialLibrary	= Cache.GetMaterialLibrary();
+
+		LoadClock.Tick();
+		LOG_INFO("[Scene]: Loaded Scene'" + Filepath + "' from '" + CacheFilepath + "' in " + std::to_string(LoadClock.GetDeltaTime().AsMilliSeconds()) + " ms");
+	}
 	else
 	{
-		LOG_INFO("[Scene]: Loaded Scene'" + Filepath + "'");
+		if (!ObjLoader::LoadFromMemory(reinterpret_cast<const Char*>(SourceFile.GetData()), SourceFile.GetSize(), ObjShapes, MaterialLibrary))
+		{
+			LOG_WARNING("[Scene]: Failed to load Scene '" + Filepath + "'.");
+			return nullptr;
+		}
+		else
+		{
+			LoadClock.Tick();
+			LOG_INFO("[Scene]: Loaded Scene'" + Filepath + "' in " + std::to_string(LoadClock.GetDeltaTime().AsMilliSeconds()) + " ms");
+		}
+
+		// Processing the shapes is independent so they are all done in parallel
+		ProcessedShapes.Resize(ObjShapes.Size());
+		Shapes.Resize(ObjShapes.Size());
+		ParallelFor(ObjShapes.Size(), [&](UInt32 Index)
+		{
+			MeshData&		Data		= ObjShapes[Index].Data;
+			ProcessedShape&	Processed	= ProcessedShapes[Index];
+
+			// Reorder for the vertex cache and overdraw
+			MeshFactory::OptimizeForRendering(Data, &Processed.Before, &Processed.After);
+			MeshFactory::CalculateTangents(Data);
+
+			// Create LODs, the simplified meshes keep the attributes of the remaining vertices
+			MeshFactory::CreateLODChain(Data, Processed.LODData, Processed.LODErrors);
+			for (MeshData& LODData : Processed.LODData)
+			{
+				MeshFactory::OptimizeForRendering(LODData);
+			}
+
+			// Convert to the format that is uploaded and cached
+			SceneCacheShape& Shape = Shapes[Index];
+			Shape.Name			= ObjShapes[Index].Name;
+			Shape.MaterialName	= ObjShapes[Index].MaterialName;
+
+			Processed.Storage.Resize(Processed.LODData.Size() + 1);
+			Shape.Meshes.EmplaceBack(Mesh::PrepareUpload(Data, Processed.Storage[0]));
+			Shape.LODErrors.EmplaceBack(0.0f);
+			for (UInt32 LOD = 0; LOD < Processed.LODData.Size(); LOD++)
+			{
+				Shape.Meshes.EmplaceBack(Mesh::PrepareUpload(Processed.LODData[LOD], Processed.Storage[LOD + 1]));
+				Shape.LODErrors.EmplaceBack(Processed.LODErrors[LOD]);
+			}
+		}, 1);
+
+		for (UInt32 Index = 0; Index < ObjShapes.Size(); Index++)
+		{
+			const ProcessedShape& Processed = ProcessedShapes[Index];
+			LOG_INFO(ObjShapes[Index].Name + " ACMR: " + std::to_string(Processed.Before.ACMR) + " -> " + std::to_string(Processed.After.ACMR) + ", ATVR: " + std::to_string(Processed.Before.ATVR) + " -> " + std::to_string(Processed.After.ATVR));
+		}
+
+		LoadClock.Tick();
+		LOG_INFO("[Scene]: Processed " + std::to_string(Shapes.Size()) + " meshes in " + std::to_string(LoadClock.GetDeltaTime().AsMilliSeconds()) + " ms");
+
+		if (!SceneCache::Write(CacheFilepath, SourceHash, MaterialLibrary, Shapes))
+		{
+			LOG_WARNING("[Scene]: Failed to write cache '" + CacheFilepath + "'");
+		}
+	}
+
+	SourceFile.Close();
+
+	// The material library is still loaded with tinyobjloader
+	std::string MTLFiledir = std::string(Filepath.begin(), Filepath.begin() + Filepath.find_last_of('/'));
+	std::map<std::string, Int32>		MaterialMap;
+	std::vector<tinyobj::material_t>	Materials;
+	if (!MaterialLibrary.empty())
+	{
+		std::ifstream MaterialStream(MTLFiledir + '/' + MaterialLibrary);
+		if (MaterialStream)
+		{
+			std::string Warning;
+			std::string Error;
+			tinyobj::LoadMtl(&MaterialMap, &Materials, &MaterialStream, &Warning, &Error);
+		}
+		else
+		{
+			LOG_WARNING("[Scene]: Failed to open material library '" + MaterialLibrary + "'");
+		}
 	}
 
 	// Create standard textures
@@ -141,7 +284,7 @@ Scene* Scene::LoadFromFile(const std::string& Filepath)
 
 	// Create All Materials in scene
 	TArray<TSharedPtr<Material>> LoadedMaterials;
-	std::unordered_map<std::string, TSharedPtr<D3D12Texture>> MaterialTextures;
+	THashMap<std::string, TSharedPtr<D3D12Texture>> MaterialTextures;
 	for (tinyobj::material_t& Mat : Materials)
 	{
 		// Create new material with default properties
@@ -164,7 +307,7 @@ Scene* Scene::LoadFromFile(const std::string& Filepath)
 		if (!Mat.ambient_texname.empty())
 		{
 			ConvertBackslashes(Mat.ambient_texname);
-			if (MaterialTextures.count(Mat.ambient_texname) == 0)
+			if (!MaterialTextures.Contains(Mat.ambient_texname))
 			{
 				std::string TexName = MTLFiledir + '/' + Mat.ambient_texname;
 				TSharedPtr<D3D12Texture> Texture = TSharedPtr<D3D12Texture>(TextureFactory::LoadFromFile(TexName, TEXTURE_FACTORY_FLAGS_GENERATE_MIPS, DXGI_FORMAT_R8G8B8A8_UNORM));
@@ -186,7 +329,7 @@ Scene* Scene::LoadFromFile(const std::string& Filepath)
 		if (!Mat.diffuse_texname.empty())
 		{
 			ConvertBackslashes(Mat.diffuse_texname);
-			if (MaterialTextures.count(Mat.diffuse_texname) == 0)
+			if (!MaterialTextures.Contains(Mat.diffuse_texname))
 			{
 				std::string TexName = MTLFiledir + '/' + Mat.diffuse_texname;
 				TSharedPtr<D3D12Texture> Texture = TSharedPtr<D3D12Texture>(TextureFactory::LoadFromFile(TexName, TEXTURE_FACTORY_FLAGS_GENERATE_MIPS, DXGI_FORMAT_R8G8B8A8_UNORM));
@@ -208,7 +351,7 @@ Scene* Scene::LoadFromFile(const std::string& Filepath)
 		if (!Mat.specular_highlight_texname.empty())
 		{
 			ConvertBackslashes(Mat.specular_highlight_texname);
-			if (MaterialTextures.count(Mat.specular_highlight_texname) == 0)
+			if (!MaterialTextures.Contains(Mat.specular_highlight_texname))
 			{
 				std::string TexName = MTLFiledir + '/' + Mat.specular_highlight_texname;
 				TSharedPtr<D3D12Texture> Texture = TSharedPtr<D3D12Texture>(TextureFactory::LoadFromFile(TexName, TEXTURE_FACTORY_FLAGS_GENERATE_MIPS, DXGI_FORMAT_R8G8B8A8_UNORM));
@@ -230,7 +373,7 @@ Scene* Scene::LoadFromFile(const std::string& Filepath)
 		if (!Mat.bump_texname.empty())
 		{
 			ConvertBackslashes(Mat.bump_texname);
-			if (MaterialTextures.count(Mat.bump_texname) == 0)
+			if (!MaterialTextures.Contains(Mat.bump_texname))
 			{
 				std::string TexName = MTLFiledir + '/' + Mat.bump_texname;
 				TSharedPtr<D3D12Texture> Texture = TSharedPtr<D3D12Texture>(TextureFactory::LoadFromFile(TexName, TEXTURE_FACTORY_FLAGS_GENERATE_MIPS, DXGI_FORMAT_R8G8B8A8_UNORM));
@@ -252,7 +395,7 @@ Scene* Scene::LoadFromFile(const std::string& Filepath)
 		if (!Mat.alpha_texname.empty())
 		{
 			ConvertBackslashes(Mat.alpha_texname);
-			if (MaterialTextures.count(Mat.alpha_texname) == 0)
+			if (!MaterialTextures.Contains(Mat.alpha_texname))
 			{
 				std::string TexName = MTLFiledir + '/' + Mat.alpha_texname;
 				TSharedPtr<D3D12Texture> Texture = TSharedPtr<D3D12Texture>(TextureFactory::LoadFromFile(TexName, TEXTURE_FACTORY_FLAGS_GENERATE_MIPS, DXGI_FORMAT_R8G8B8A8_UNORM));
@@ -274,102 +417,61 @@ Scene* Scene::LoadFromFile(const std::string& Filepath)
 	}
 
 	// Construct Scene
-	MeshData Data;
 	TUniquePtr<Scene> LoadedScene = MakeUnique<Scene>();
-	std::unordered_map<Vertex, UInt32, VertexHasher> UniqueVertices;
 
-	for (const tinyobj::shape_t& Shape : Shapes)
+	// Size of all vertexbuffers, compared against the size they would have with the unpacked format
+	UInt64 VertexBufferSize		= 0;
+	UInt64 UnpackedVertexSize	= 0;
+
+	// Creating the resources is not threadsafe, the data is uploaded directly from the cache or the processed shapes
+	for (const SceneCacheShape& Shape : Shapes)
 	{
-		// Start at index zero for eaxh mesh and loop until all indices are processed
-		UInt32 i = 0;
-		while (i < Shape.mesh.indices.size())
+		TSharedPtr<Mesh> NewMesh = Mesh::Make(Shape.Meshes[0]);
+		VertexBufferSize	+= static_cast<UInt64>(NewMesh->VertexCount) * NewMesh->VertexStride;
+		UnpackedVertexSize	+= static_cast<UInt64>(NewMesh->VertexCount) * sizeof(Vertex);
+
+		// Setup new actor for this shape
+		Actor* NewActor = new Actor();
+		NewActor->SetDebugName(Shape.Name);
+		NewActor->GetTransform().SetScale(0.015f, 0.015f, 0.015f);
+
+		// Add a MeshComponent
+		MeshComponent NewComponent(NewActor);
+		NewComponent.Mesh = NewMesh;
+		for (UInt32 LOD = 1; LOD < Shape.Meshes.Size(); LOD++)
 		{
-			// Start a new mesh
-			Data.Indices.Clear();
-			Data.Vertices.Clear();
-
-			UniqueVertices.clear();
-
-			UInt32 Face = i / 3;
-			const Int32 MaterialID = Shape.mesh.material_ids[Face];
-			for (; i < Shape.mesh.indices.size(); i++)
-			{
-				// Break if material is not the same
-				Face = i / 3;
-				if (Shape.mesh.material_ids[Face] != MaterialID)
-				{
-					break;
-				}
-
-				const tinyobj::index_t& Index = Shape.mesh.indices[i];
-				Vertex TempVertex;
-
-				// Normals and texcoords are optional, Positions are required
-				VALIDATE(Index.vertex_index >= 0);
-
-				size_t PositionIndex = 3 * static_cast<size_t>(Index.vertex_index);
-				TempVertex.Position =
-				{
-					Attributes.vertices[PositionIndex + 0],
-					Attributes.vertices[PositionIndex + 1],
-					Attributes.vertices[PositionIndex + 2],
-				};
-
-				if (Index.normal_index >= 0)
-				{
-					size_t NormalIndex = 3 * static_cast<size_t>(Index.normal_index);
-					TempVertex.Normal =
-					{
-						Attributes.normals[NormalIndex + 0],
-						Attributes.normals[NormalIndex + 1],
-						Attributes.normals[NormalIndex + 2],
-					};
-				}
-
-				if (Index.texcoord_index >= 0)
-				{
-					size_t TexCoordIndex = 2 * static_cast<size_t>(Index.texcoord_index);
-					TempVertex.TexCoord =
-					{
-						Attributes.texcoords[TexCoordIndex + 0],
-						Attributes.texcoords[TexCoordIndex + 1],
-					};
-				}
-
-				if (UniqueVertices.count(TempVertex) == 0)
-				{
-					UniqueVertices[TempVertex] = static_cast<UInt32>(Data.Vertices.Size());
-					Data.Vertices.PushBack(TempVertex);
-				}
+			TSharedPtr<Mesh> LODMesh = Mesh::Make(Shape.Meshes[LOD]);
+			LODMesh->LODError = Shape.LODErrors[LOD];
+			VertexBufferSize	+= static_cast<UInt64>(LODMesh->VertexCount) * LODMesh->VertexStride;
+			UnpackedVertexSize	+= static_cast<UInt64>(LODMesh->VertexCount) * sizeof(Vertex);
+			NewComponent.LODs.EmplaceBack(LODMesh);
+		}
 
-				Data.Indices.EmplaceBack(UniqueVertices[TempVertex]);
-			}
+		auto MaterialIt = MaterialMap.find(Shape.MaterialName);
+		if (MaterialIt != MaterialMap.end())
+		{
+			LOG_INFO(Shape.Name + " got materialID=" + std::to_string(MaterialIt->second));
+			NewComponent.Material = LoadedMaterials[MaterialIt->second];
+		}
+		else
+		{
+			NewComponent.Material = BaseMaterial;
+		}
 
-			// Calculate tangents and create mesh
-			MeshFactory::CalculateTangents(Data);
-			TSharedPtr<Mesh> NewMesh = Mesh::Make(Data);
+		LoadedScene->AddActor(NewActor);
+		NewActor->AddComponent(NewComponent);
+	}
 
-			// Setup new actor for this shape
-			Actor* NewActor = new Actor();
-			NewActor->SetDebugName(Shape.name);
-			NewActor->GetTransform().SetScale(0.015f, 0.015f, 0.015f);
+	LoadClock.Tick();
+	LOG_INFO("[Scene]: Created " + std::to_string(Shapes.Size()) + " meshes in " + std::to_string(LoadClock.GetDeltaTime().AsMilliSeconds()) + " ms");
 
-			// Add a MeshComponent
-			MeshComponent* NewComponent = new MeshComponent(NewActor);
-			NewComponent->Mesh = NewMesh;
-			if (MaterialID >= 0)
-			{
-				LOG_INFO(Shape.name + " got materialID=" + std::to_string(MaterialID));
-				NewComponent->Material = LoadedMaterials[MaterialID];
-			}
-			else
-			{
-				NewComponent->Material = BaseMaterial;
-			}
-
-			NewActor->AddComponent(NewComponent);
-			LoadedScene->AddActor(NewActor);
-		}
+	// Every vertex that is fetched shrinks by the same ratio as the buffers
+	if (UnpackedVertexSize > 0)
+	{
+		const Float SizeInMB			= static_cast<Float>(VertexBufferSize) / (1024.0f * 1024.0f);
+		const Float UnpackedSizeInMB	= static_cast<Float>(UnpackedVertexSize) / (1024.0f * 1024.0f);
+		const Float Saved				= 100.0f * (1.0f - static_cast<Float>(VertexBufferSize) / static_cast<Float>(UnpackedVertexSize));
+		LOG_INFO("[Scene]: VertexBuffers use " + std::to_string(SizeInMB) + " MB instead of " + std::to_string(UnpackedSizeInMB) + " MB, vertex memory and fetch bandwidth reduced by " + std::to_string(Saved) + "%");
 	}
 
 	return LoadedScene.Release();
@@ -398,5 +500,43 @@ void Scene::AddMeshComponent(MeshComponent* Component)
 	Command.IndexCount		= Component->Mesh->IndexCount;
 	Command.Material		= Component->Material.Get();
 	Command.Mesh			= Component->Mesh.Get();
+	Command.Component		= Component;
 	MeshDrawCommands.PushBack(Command);
+
+	const UInt32 Index = MeshDrawCommands.Size() - 1;
+	WorldBounds.Resize(MeshDrawCommands.Size());
+	UpdateWorldBounds(Index, Index + 1);
+
+	SpatialProxies.EmplaceBack(SpatialTree.Insert(WorldBounds.Get(Index), Index));
+	BoundsVersions.EmplaceBack(Command.CurrentActor->GetTransform().GetVersion());
+	MovedCommands.EmplaceBack(UInt8(0));
+}
+
+void Scene::UpdateWorldBounds(UInt32 Begin, UInt32 End)
+{
+	for (UInt32 Index = Begin; Index < End; Index++)
+	{
+		const MeshDrawCommand& Command = MeshDrawCommands[Index];
+
+		const AABB& LocalBox = Command.Mesh->BoundingBox;
+		XMVECTOR XmTop		= XMLoadFloat3(&LocalBox.Top);
+		XMVECTOR XmBottom	= XMLoadFloat3(&LocalBox.Bottom);
+		XMVECTOR XmCenter	= XMVectorScale(XMVectorAdd(XmTop, XmBottom), 0.5f);
+		XMVECTOR XmExtent	= XMVectorAbs(XMVectorScale(XMVectorSubtract(XmTop, XmBottom), 0.5f));
+
+		// Transform the center and project the extents onto the world axes (Arvo), the result is a tight box for any rotation
+		const XMFLOAT4X4& Transform = Command.CurrentActor->GetTransform().GetMatrix();
+		XMMATRIX XmTransform = XMMatrixTranspose(XMLoadFloat4x4(&Transform));
+
+		XMVECTOR XmWorldCenter = XMVector3Transform(XmCenter, XmTransform);
+		XMVECTOR XmWorldExtent = XMVectorMultiply(XMVectorSplatX(XmExtent), XMVectorAbs(XmTransform.r[0]));
+		XmWorldExtent = XMVectorMultiplyAdd(XMVectorSplatY(XmExtent), XMVectorAbs(XmTransform.r[1]), XmWorldExtent);
+		XmWorldExtent = XMVectorMultiplyAdd(XMVectorSplatZ(XmExtent), XMVectorAbs(XmTransform.r[2]), XmWorldExtent);
+
+		XMFLOAT3 WorldCenter;
+		XMFLOAT3 WorldExtent;
+		XMStoreFloat3(&WorldCenter, XmWorldCenter);
+		XMStoreFloat3(&WorldExtent, XmWorldExtent);
+		WorldBounds.Set(Index, WorldCenter, WorldExtent);
+	}
 }
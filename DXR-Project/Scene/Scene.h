@@ -1,6 +1,11 @@
 #pragma once
 #include "Actor.h"
 #include "Camera.h"
+#include "AABB.h"
+#include "AABBTree.h"
+#include "TransformHierarchy.h"
+
+#include "Components/ComponentStorage.h"
 
 #include "Lights/Light.h"
 
@@ -25,6 +30,7 @@ public:
 	void AddLight(Light* InLight);
 
 	void OnAddedComponent(Component* NewComponent);
+	void OnActorParentChanged(Actor* InActor);
 
 	FORCEINLINE const TArray<Actor*>& GetActors() const
 	{
@@ -36,28 +42,45 @@ public:
 		return Lights;
 	}
 
+	FORCEINLINE ComponentStorage& GetComponentStorage()
+	{
+		return Components;
+	}
+
+	// The view is valid until a new component is added to the scene
 	template<typename TComponent>
-	FORCEINLINE const TArray<TComponent> GetAllComponentsOfType() const
+	FORCEINLINE TComponentView<TComponent> GetAllComponentsOfType() const
 	{
-		// TODO: Cache this result
-
-		TArray<TComponent> Components;
-		for (Actor* Actor : Actors)
-		{
-			TComponent* Component = Actor->GetComponentOfType<TComponent>();
-			if (Component)
-			{
-				Components.EmplaceBack(*Component);
-			}
-		}
-
-		return Move(Components);
+		return Components.GetComponentsOfType<TComponent>();
 	}
 
 	FORCEINLINE const TArray<MeshDrawCommand>& GetMeshDrawCommands() const
 	{
 		return MeshDrawCommands;
 	}
+
+	// World space bounds for each MeshDrawCommand, updated in Scene::Tick
+	FORCEINLINE const AABBList& GetWorldBounds() const
+	{
+		return WorldBounds;
+	}
+
+	// The transform version that the world bounds were calculated with, for each MeshDrawCommand
+	FORCEINLINE const TArray<UInt32>& GetBoundsVersions() const
+	{
+		return BoundsVersions;
+	}
+
+	FORCEINLINE const TransformHierarchy& GetTransformHierarchy() const
+	{
+		return Hierarchy;
+	}
+
+	// Contains the world space bounds, UserData is the index of the MeshDrawCommand
+	FORCEINLINE const AABBTree& GetSpatialTree() const
+	{
+		return SpatialTree;
+	}
 	 
 	FORCEINLINE Camera* GetCamera() const
 	{
@@ -72,9 +95,20 @@ public:
 private:
 	void AddMeshComponent(class MeshComponent* Component);
 
+	void UpdateWorldBounds(UInt32 Begin, UInt32 End);
+
 	TArray<Actor*> Actors;
 	TArray<Light*> Lights;
+	ComponentStorage Components;
 	TArray<MeshDrawCommand> MeshDrawCommands;
+	AABBList WorldBounds;
+	AABBTree SpatialTree;
+	TransformHierarchy Hierarchy;
+
+	// Per MeshDrawCommand
+	TArray<UInt32>	SpatialProxies;
+	TArray<UInt32>	BoundsVersions;
+	TArray<UInt8>	MovedCommands;
 
 	Camera* CurrentCamera = nullptr;
 
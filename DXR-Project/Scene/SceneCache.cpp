@@ -0,0 +1,457 @@
+#include "SceneCache.h"
+
+#include "Core/JobSystem.h"
+
+#include "Rendering/MeshFactory.h"
+
+#include <atomic>
+#include <fstream>
+
+// Increase when the layout of the file or the processing of the meshes changes
+#define SCENE_CACHE_VERSION		3
+#define SCENE_CACHE_MAGIC		0x48434358
+#define SCENE_CACHE_ALIGNMENT	16
+
+/*
+* File layout, every header, string and array starts at a multiple of SCENE_CACHE_ALIGNMENT:
+*	SceneCacheHeader, material library
+*	For each shape: SceneCacheShapeHeader, name, material name
+*		For each mesh: SceneCacheMeshHeader, vertices, indices, meshlets, meshlet vertices, meshlet triangles
+* The indices are compressed with MeshFactory::EncodeIndices.
+*/
+
+struct SceneCacheHeader
+{
+	UInt32 Magic					= 0;
+	UInt32 Version					= 0;
+	UInt64 SourceHash				= 0;
+	UInt64 FileSize					= 0;
+	UInt32 VertexStride				= 0;
+	UInt32 NumShapes				= 0;
+	UInt32 MaterialLibraryLength	= 0;
+	UInt32 Padding					= 0;
+};
+
+struct SceneCacheShapeHeader
+{
+	UInt32 NameLength			= 0;
+	UInt32 MaterialNameLength	= 0;
+	UInt32 NumMeshes			= 0;
+	UInt32 Padding				= 0;
+};
+
+struct SceneCacheMeshHeader
+{
+	UInt32 VertexCount			= 0;
+	UInt32 VertexStride			= 0;
+	UInt32 IndexCount			= 0;
+	UInt32 IndexFormat			= 0;
+	UInt32 EncodedIndexSize		= 0;
+
+	VertexQuantization	Quantization;
+	AABB				BoundingBox;
+
+	UInt32	NumMeshlets				= 0;
+	UInt32	NumMeshletVertices		= 0;
+	UInt32	MeshletTrianglesSize	= 0;
+	Float	LODError				= 0.0f;
+};
+
+static UInt32 GetVertexStride()
+{
+#if ENABLE_PACKED_VERTICES
+	return sizeof(PackedVertex);
+#else
+	return sizeof(Vertex);
+#endif
+}
+
+/*
+* Reading
+*/
+
+class SceneCacheReader
+{
+public:
+	FORCEINLINE SceneCacheReader(const Byte* InData, UInt64 InSize)
+		: Data(InData)
+		, Size(InSize)
+	{
+	}
+
+	// Returns nullptr if the file is too small
+	FORCEINLINE const Byte* Read(UInt64 InSize)
+	{
+		if (InSize > Size - Offset)
+		{
+			return nullptr;
+		}
+
+		const Byte* Result = Data + Offset;
+		Offset = std::min<UInt64>(Math::AlignUp<UInt64>(Offset + InSize, SCENE_CACHE_ALIGNMENT), Size);
+		return Result;
+	}
+
+	template<typename T>
+	FORCEINLINE bool ReadValue(T& OutValue)
+	{
+		const Byte* Ptr = Read(sizeof(T));
+		if (Ptr)
+		{
+			memcpy(&OutValue, Ptr, sizeof(T));
+		}
+
+		return (Ptr != nullptr);
+	}
+
+	FORCEINLINE bool ReadString(std::string& OutString, UInt32 Length)
+	{
+		const Byte* Ptr = Read(Length);
+		if (Ptr)
+		{
+			OutString.assign(reinterpret_cast<const Char*>(Ptr), Length);
+		}
+
+		return (Ptr != nullptr);
+	}
+
+	FORCEINLINE UInt64 GetRemainingSize() const
+	{
+		return Size - Offset;
+	}
+
+private:
+	const Byte* Data	= nullptr;
+	UInt64		Size	= 0;
+	UInt64		Offset	= 0;
+};
+
+// The indices are decoded later, OutEncodedIndices points to the compressed indices in the file
+static bool ReadMesh(SceneCacheReader& Reader, MeshUploadData& OutMesh, Float& OutLODError, const Byte*& OutEncodedIndices, UInt32& OutEncodedIndexSize)
+{
+	SceneCacheMeshHeader Header;
+	if (!Reader.ReadValue(Header))
+	{
+		return false;
+	}
+
+	if (Header.VertexStride != GetVertexStride())
+	{
+		return false;
+	}
+
+	if (Header.IndexFormat != DXGI_FORMAT_R16_UINT && Header.IndexFormat != DXGI_FORMAT_R32_UINT)
+	{
+		return false;
+	}
+
+	// The encoded indices start with one control byte for every four indices, this keeps a corrupt index count from
+	// allocating more than the file can hold
+	if ((static_cast<UInt64>(Header.IndexCount) + 3) / 4 > Header.EncodedIndexSize)
+	{
+		return false;
+	}
+
+	OutMesh.VertexCount				= Header.VertexCount;
+	OutMesh.VertexStride			= Header.VertexStride;
+	OutMesh.IndexCount				= Header.IndexCount;
+	OutMesh.IndexFormat				= static_cast<DXGI_FORMAT>(Header.IndexFormat);
+	OutMesh.Quantization			= Header.Quantization;
+	OutMesh.BoundingBox				= Header.BoundingBox;
+	OutMesh.NumMeshlets				= Header.NumMeshlets;
+	OutMesh.NumMeshletVertices		= Header.NumMeshletVertices;
+	OutMesh.MeshletTrianglesSize	= Header.MeshletTrianglesSize;
+	OutLODError						= Header.LODError;
+	OutEncodedIndexSize				= Header.EncodedIndexSize;
+
+	OutMesh.VertexData			= Reader.Read(static_cast<UInt64>(Header.VertexCount) * Header.VertexStride);
+	OutEncodedIndices			= Reader.Read(Header.EncodedIndexSize);
+	OutMesh.Meshlets			= reinterpret_cast<const Meshlet*>(Reader.Read(static_cast<UInt64>(Header.NumMeshlets) * sizeof(Meshlet)));
+	OutMesh.MeshletVertices		= reinterpret_cast<const UInt32*>(Reader.Read(static_cast<UInt64>(Header.NumMeshletVertices) * sizeof(UInt32)));
+	OutMesh.MeshletTriangles	= Reader.Read(Header.MeshletTrianglesSize);
+	return OutMesh.VertexData && OutEncodedIndices && OutMesh.Meshlets && OutMesh.MeshletVertices && OutMesh.MeshletTriangles;
+}
+
+// Meshlet ranges and vertex indices are used by the GPU without further checks, so everything has to be in bounds
+static bool AreMeshletsValid(const MeshUploadData& Mesh)
+{
+	// The checks are accumulated instead of returning early so that the loops can be vectorized
+	bool IsInRange = true;
+	for (UInt32 Index = 0; Index < Mesh.NumMeshletVertices; Index++)
+	{
+		IsInRange &= (Mesh.MeshletVertices[Index] < Mesh.VertexCount);
+	}
+
+	for (UInt32 Index = 0; Index < Mesh.NumMeshlets && IsInRange; Index++)
+	{
+		const Meshlet& CurrentMeshlet = Mesh.Meshlets[Index];
+		const UInt64 NumTriangleIndices = static_cast<UInt64>(CurrentMeshlet.TriangleCount) * 3;
+		if ((static_cast<UInt64>(CurrentMeshlet.VertexOffset) + CurrentMeshlet.VertexCount > Mesh.NumMeshletVertices) ||
+			(static_cast<UInt64>(CurrentMeshlet.TriangleOffset) * 3 + NumTriangleIndices > Mesh.MeshletTrianglesSize) ||
+			(static_cast<UInt64>(CurrentMeshlet.IndexOffset) + NumTriangleIndices > Mesh.IndexCount))
+		{
+			return false;
+		}
+
+		const UInt8* Triangles = Mesh.MeshletTriangles + static_cast<UInt64>(CurrentMeshlet.TriangleOffset) * 3;
+		for (UInt64 TriangleIndex = 0; TriangleIndex < NumTriangleIndices; TriangleIndex++)
+		{
+			IsInRange &= (Triangles[TriangleIndex] < CurrentMeshlet.VertexCount);
+		}
+	}
+
+	return IsInRange;
+}
+
+/*
+* Writing
+*/
+
+static void WriteAligned(std::ofstream& Stream, const Void* Data, UInt64 Size)
+{
+	static const Char Padding[SCENE_CACHE_ALIGNMENT] = { };
+
+	if (Size > 0)
+	{
+		Stream.write(reinterpret_cast<const Char*>(Data), static_cast<std::streamsize>(Size));
+	}
+
+	const UInt64 PaddingSize = Math::AlignUp<UInt64>(Size, SCENE_CACHE_ALIGNMENT) - Size;
+	Stream.write(Padding, static_cast<std::streamsize>(PaddingSize));
+}
+
+static void WriteMesh(std::ofstream& Stream, const MeshUploadData& Mesh, Float LODError)
+{
+	SceneCacheMeshHeader Header;
+	Header.VertexCount			= Mesh.VertexCount;
+	Header.VertexStride			= Mesh.VertexStride;
+	Header.IndexCount			= Mesh.IndexCount;
+	Header.IndexFormat			= static_cast<UInt32>(Mesh.IndexFormat);
+	Header.Quantization			= Mesh.Quantization;
+	Header.BoundingBox			= Mesh.BoundingBox;
+	Header.NumMeshlets			= Mesh.NumMeshlets;
+	Header.NumMeshletVertices	= Mesh.NumMeshletVertices;
+	Header.MeshletTrianglesSize	= Mesh.MeshletTrianglesSize;
+	Header.LODError				= LODError;
+
+	TArray<UInt32> Indices(Mesh.IndexCount);
+	if (Mesh.IndexFormat == DXGI_FORMAT_R16_UINT)
+	{
+		const UInt16* ShortIndices = reinterpret_cast<const UInt16*>(Mesh.IndexData);
+		for (UInt32 Index = 0; Index < Mesh.IndexCount; Index++)
+		{
+			Indices[Index] = ShortIndices[Index];
+		}
+	}
+	else if (Mesh.IndexCount > 0)
+	{
+		memcpy(Indices.Data(), Mesh.IndexData, Mesh.IndexCount * sizeof(UInt32));
+	}
+
+	TArray<UInt8> EncodedIndices;
+	MeshFactory::EncodeIndices(Indices, EncodedIndices);
+	Header.EncodedIndexSize = EncodedIndices.Size();
+	WriteAligned(Stream, &Header, sizeof(Header));
+
+	WriteAligned(Stream, Mesh.VertexData, static_cast<UInt64>(Mesh.VertexCount) * Mesh.VertexStride);
+	WriteAligned(Stream, EncodedIndices.Data(), EncodedIndices.Size());
+	WriteAligned(Stream, Mesh.Meshlets, static_cast<UInt64>(Mesh.NumMeshlets) * sizeof(Meshlet));
+	WriteAligned(Stream, Mesh.MeshletVertices, static_cast<UInt64>(Mesh.NumMeshletVertices) * sizeof(UInt32));
+	WriteAligned(Stream, Mesh.MeshletTriangles, Mesh.MeshletTrianglesSize);
+}
+
+/*
+* SceneCache
+*/
+
+bool SceneCache::Open(const std::string& Filepath, UInt64 SourceHash)
+{
+	Close();
+
+	if (!File.Open(Filepath))
+	{
+		return false;
+	}
+
+	SceneCacheReader Reader(File.GetData(), File.GetSize());
+
+	SceneCacheHeader Header;
+	const bool IsValid =
+		Reader.ReadValue(Header) &&
+		(Header.Magic			== SCENE_CACHE_MAGIC) &&
+		(Header.Version			== SCENE_CACHE_VERSION) &&
+		(Header.SourceHash		== SourceHash) &&
+		(Header.FileSize		== File.GetSize()) &&
+		(Header.VertexStride	== GetVertexStride()) &&
+		Reader.ReadString(MaterialLibrary, Header.MaterialLibraryLength);
+	if (!IsValid)
+	{
+		Close();
+		return false;
+	}
+
+	struct EncodedMeshIndices
+	{
+		MeshUploadData*	Mesh		= nullptr;
+		const Byte*		Data		= nullptr;
+		UInt32			Size		= 0;
+		UInt64			Offset		= 0;
+	};
+
+	TArray<EncodedMeshIndices> EncodedIndices;
+	UInt64 NumDecodedIndices = 0;
+
+	// Every shape and mesh starts with a header, so a corrupt count is rejected before anything is allocated
+	if (Header.NumShapes > Reader.GetRemainingSize() / sizeof(SceneCacheShapeHeader))
+	{
+		Close();
+		return false;
+	}
+
+	Shapes.Resize(Header.NumShapes);
+	for (SceneCacheShape& Shape : Shapes)
+	{
+		SceneCacheShapeHeader ShapeHeader;
+		if (!Reader.ReadValue(ShapeHeader) || !Reader.ReadString(Shape.Name, ShapeHeader.NameLength) || !Reader.ReadString(Shape.MaterialName, ShapeHeader.MaterialNameLength))
+		{
+			Close();
+			return false;
+		}
+
+		if (ShapeHeader.NumMeshes > Reader.GetRemainingSize() / sizeof(SceneCacheMeshHeader))
+		{
+			Close();
+			return false;
+		}
+
+		Shape.Meshes.Resize(ShapeHeader.NumMeshes);
+		Shape.LODErrors.Resize(ShapeHeader.NumMeshes);
+		for (UInt32 Index = 0; Index < ShapeHeader.NumMeshes; Index++)
+		{
+			EncodedMeshIndices& Encoded = EncodedIndices.EmplaceBack();
+			if (!ReadMesh(Reader, Shape.Meshes[Index], Shape.LODErrors[Index], Encoded.Data, Encoded.Size))
+			{
+				Close();
+				return false;
+			}
+
+			Encoded.Mesh	= &Shape.Meshes[Index];
+			Encoded.Offset	= NumDecodedIndices;
+			NumDecodedIndices += Shape.Meshes[Index].IndexCount;
+		}
+	}
+
+	if (NumDecodedIndices > UINT32_MAX)
+	{
+		Close();
+		return false;
+	}
+
+	// Every mesh gets room for 32-bit indices, 16-bit indices are narrowed in place after decoding
+	DecodedIndices.Resize(static_cast<UInt32>(NumDecodedIndices));
+
+	std::atomic<bool> IsDecoded(true);
+	ParallelFor(EncodedIndices.Size(), [&](UInt32 Index)
+	{
+		const EncodedMeshIndices& Encoded = EncodedIndices[Index];
+		MeshUploadData& Mesh = *Encoded.Mesh;
+
+		UInt32* Indices = DecodedIndices.Data() + Encoded.Offset;
+		if (!MeshFactory::DecodeIndices(Encoded.Data, Encoded.Size, Indices, Mesh.IndexCount) || !AreMeshletsValid(Mesh))
+		{
+			IsDecoded.store(false, std::memory_order_relaxed);
+			return;
+		}
+
+		// Indices outside the vertex buffer are rejected, 16-bit indices can not be above 0xffff either
+		const UInt32 IndexLimit = (Mesh.IndexFormat == DXGI_FORMAT_R16_UINT) ? std::min<UInt32>(Mesh.VertexCount, 0x10000) : Mesh.VertexCount;
+
+		bool IsInRange = true;
+		if (Mesh.IndexFormat == DXGI_FORMAT_R16_UINT)
+		{
+			// Index i is read before the bytes at 2 * i are written, so narrowing from the front never overwrites an index that is still needed
+			UInt16* ShortIndices = reinterpret_cast<UInt16*>(Indices);
+			for (UInt32 CurrentIndex = 0; CurrentIndex < Mesh.IndexCount; CurrentIndex++)
+			{
+				const UInt32 Value = Indices[CurrentIndex];
+				IsInRange &= (Value < IndexLimit);
+				ShortIndices[CurrentIndex] = static_cast<UInt16>(Value);
+			}
+		}
+		else
+		{
+			for (UInt32 CurrentIndex = 0; CurrentIndex < Mesh.IndexCount; CurrentIndex++)
+			{
+				IsInRange &= (Indices[CurrentIndex] < IndexLimit);
+			}
+		}
+
+		if (!IsInRange)
+		{
+			IsDecoded.store(false, std::memory_order_relaxed);
+			return;
+		}
+
+		Mesh.IndexData = Indices;
+	}, 1);
+
+	if (!IsDecoded.load())
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void SceneCache::Close()
+{
+	Shapes.Clear();
+	DecodedIndices.Clear();
+	MaterialLibrary.clear();
+	File.Close();
+}
+
+bool SceneCache::Write(const std::string& Filepath, UInt64 SourceHash, const std::string& MaterialLibrary, const TArray<SceneCacheShape>& Shapes)
+{
+	std::ofstream Stream(Filepath, std::ios::binary | std::ios::trunc);
+	if (!Stream)
+	{
+		return false;
+	}
+
+	// The header is written last, so a file that was not completely written is never valid
+	SceneCacheHeader Header;
+	WriteAligned(Stream, &Header, sizeof(Header));
+	WriteAligned(Stream, MaterialLibrary.data(), MaterialLibrary.size());
+
+	for (const SceneCacheShape& Shape : Shapes)
+	{
+		VALIDATE(Shape.Meshes.Size() == Shape.LODErrors.Size());
+
+		SceneCacheShapeHeader ShapeHeader;
+		ShapeHeader.NameLength			= static_cast<UInt32>(Shape.Name.size());
+		ShapeHeader.MaterialNameLength	= static_cast<UInt32>(Shape.MaterialName.size());
+		ShapeHeader.NumMeshes			= Shape.Meshes.Size();
+		WriteAligned(Stream, &ShapeHeader, sizeof(ShapeHeader));
+		WriteAligned(Stream, Shape.Name.data(), Shape.Name.size());
+		WriteAligned(Stream, Shape.MaterialName.data(), Shape.MaterialName.size());
+
+		for (UInt32 Index = 0; Index < Shape.Meshes.Size(); Index++)
+		{
+			WriteMesh(Stream, Shape.Meshes[Index], Shape.LODErrors[Index]);
+		}
+	}
+
+	Header.Magic					= SCENE_CACHE_MAGIC;
+	Header.Version					= SCENE_CACHE_VERSION;
+	Header.SourceHash				= SourceHash;
+	Header.FileSize					= static_cast<UInt64>(Stream.tellp());
+	Header.VertexStride				= GetVertexStride();
+	Header.NumShapes				= Shapes.Size();
+	Header.MaterialLibraryLength	= static_cast<UInt32>(MaterialLibrary.size());
+
+	Stream.seekp(0);
+	Stream.write(reinterpret_cast<const Char*>(&Header), sizeof(Header));
+	return Stream.good();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Core/MappedFile.h"
+
+#include "Rendering/Mesh.h"
+
+#include <string>
+
+/*
+* SceneCacheShape - A mesh of a scene together with its LODs
+*/
+
+struct SceneCacheShape
+{
+	std::string Name;
+	std::string MaterialName;
+
+	// The first mesh has full detail and is followed by the LODs
+	TArray<MeshUploadData>	Meshes;
+	TArray<Float>			LODErrors;
+};
+
+/*
+* SceneCache - Binary file with the processed meshes of a scene, stored in the format that they are uploaded in. The file
+* is memory mapped and the meshes point directly into it, so they stay valid until the cache is closed. Indices are
+* stored compressed and are decoded into memory owned by the cache when it is opened. A cache is only used if it was
+* written by the same version, with the same vertex format and from the same source content.
+*/
+
+class SceneCache
+{
+public:
+	SceneCache() = default;
+	~SceneCache() = default;
+
+	SceneCache(const SceneCache& Other) = delete;
+	SceneCache& operator=(const SceneCache& Other) = delete;
+
+	// Returns false if the file does not exist, is outdated or is corrupt
+	bool Open(const std::string& Filepath, UInt64 SourceHash);
+	void Close();
+
+	static bool Write(const std::string& Filepath, UInt64 SourceHash, const std::string& MaterialLibrary, const TArray<SceneCacheShape>& Shapes);
+
+	FORCEINLINE const TArray<SceneCacheShape>& GetShapes() const
+	{
+		return Shapes;
+	}
+
+	FORCEINLINE const std::string& GetMaterialLibrary() const
+	{
+		return MaterialLibrary;
+	}
+
+private:
+	MappedFile File;
+	TArray<SceneCacheShape> Shapes;
+	TArray<UInt32> DecodedIndices;
+	std::string MaterialLibrary;
+};
@@ -0,0 +1,260 @@
+#include "TransformHierarchy.h"
+#include "Actor.h"
+
+#include "Core/JobSystem.h"
+
+#include <atomic>
+
+// Versions are unique across all transforms so that copying a transform is also detected as a change. Transforms are
+// updated from several threads so the counter is atomic
+static std::atomic<UInt32> GlobalTransformVersion(0);
+
+/*
+* Helpers
+*/
+
+// Reorders Array so that element Index is the old element Order[Index]
+template<typename T>
+static void Reorder(TArray<T>& Array, const TArray<UInt32>& Order)
+{
+	TArray<T> Sorted(Order.Size());
+	for (UInt32 Index = 0; Index < Order.Size(); Index++)
+	{
+		Sorted[Index] = Array[Order[Index]];
+	}
+
+	Array = Move(Sorted);
+}
+
+/*
+* TransformHierarchy
+*/
+
+TransformHierarchy::TransformHierarchy()
+	: Actors()
+	, Translations()
+	, Rotations()
+	, Scales()
+	, Matrices()
+	, MatrixInverses()
+	, Versions()
+	, ParentIndices()
+	, DirtyFlags()
+	, UpdatedFlags()
+	, LevelOffsets()
+{
+}
+
+void TransformHierarchy::AddActor(Actor* InActor)
+{
+	VALIDATE(InActor != nullptr);
+
+	Transform& ActorTransform = InActor->GetTransform();
+	VALIDATE(ActorTransform.Hierarchy == nullptr);
+
+	Actors.EmplaceBack(InActor);
+	Translations.EmplaceBack(ActorTransform.Translation);
+	Rotations.EmplaceBack(ActorTransform.Rotation);
+	Scales.EmplaceBack(ActorTransform.Scale);
+	Matrices.EmplaceBack(ActorTransform.Matrix);
+	MatrixInverses.EmplaceBack(ActorTransform.MatrixInv);
+	Versions.EmplaceBack(ActorTransform.Version);
+	ParentIndices.EmplaceBack(TRANSFORM_HIERARCHY_NO_PARENT);
+	DirtyFlags.EmplaceBack(ActorTransform.Dirty ? UInt8(1) : UInt8(0));
+	UpdatedFlags.EmplaceBack(UInt8(0));
+
+	ActorTransform.Hierarchy	= this;
+	ActorTransform.Slot			= Actors.Size() - 1;
+	IsSorted = false;
+}
+
+void TransformHierarchy::OnParentChanged()
+{
+	IsSorted = false;
+}
+
+void TransformHierarchy::Update()
+{
+	if (!IsSorted)
+	{
+		Sort();
+	}
+
+	for (UInt32 Level = 0; Level + 1 < LevelOffsets.Size(); Level++)
+	{
+		const UInt32 LevelBegin	= LevelOffsets[Level];
+		const UInt32 LevelEnd	= LevelOffsets[Level + 1];
+		ParallelForBatch(LevelEnd - LevelBegin, [this, LevelBegin](UInt32 Begin, UInt32 End)
+		{
+			UpdateRange(LevelBegin + Begin, LevelBegin + End);
+		}, 256);
+	}
+
+	NumUpdated = 0;
+	for (UInt8 Updated : UpdatedFlags)
+	{
+		NumUpdated += Updated;
+	}
+}
+
+void TransformHierarchy::UpdateRange(UInt32 Begin, UInt32 End)
+{
+	UInt32 NumUpdatedInRange = 0;
+	for (UInt32 Index = Begin; Index < End; Index++)
+	{
+		const UInt32 ParentIndex	= ParentIndices[Index];
+		const bool HasParent		= (ParentIndex != TRANSFORM_HIERARCHY_NO_PARENT);
+		const bool IsUpdated		= DirtyFlags[Index] || (HasParent && UpdatedFlags[ParentIndex]);
+		if (IsUpdated)
+		{
+			CalculateMatrices(
+				Translations[Index],
+				Rotations[Index],
+				Scales[Index],
+				HasParent ? &Matrices[ParentIndex] : nullptr,
+				HasParent ? &MatrixInverses[ParentIndex] : nullptr,
+				Matrices[Index],
+				MatrixInverses[Index]);
+
+			DirtyFlags[Index] = 0;
+			NumUpdatedInRange++;
+		}
+
+		UpdatedFlags[Index] = IsUpdated ? 1 : 0;
+	}
+
+	// One atomic operation for the whole range instead of one for each transform
+	if (NumUpdatedInRange > 0)
+	{
+		UInt32 Version = AllocateVersions(NumUpdatedInRange);
+		for (UInt32 Index = Begin; Index < End; Index++)
+		{
+			if (UpdatedFlags[Index])
+			{
+				Versions[Index] = ++Version;
+			}
+		}
+	}
+}
+
+void TransformHierarchy::CalculateMatrices(
+	const XMFLOAT3& Translation,
+	const XMFLOAT3& Rotation,
+	const XMFLOAT3& Scale,
+	const XMFLOAT4X4* ParentMatrix,
+	const XMFLOAT4X4* ParentMatrixInv,
+	XMFLOAT4X4& OutMatrix,
+	XMFLOAT4X4& OutMatrixInv)
+{
+	XMVECTOR XmTranslation	= XMLoadFloat3(&Translation);
+	XMVECTOR XmScale		= XMLoadFloat3(&Scale);
+	// Convert into Roll, Pitch, Yaw
+	XMVECTOR XmRotation = XMVectorSet(Rotation.z, Rotation.y, Rotation.x, 0.0f);
+	XMMATRIX XmRotationMatrix = XMMatrixRotationRollPitchYawFromVector(XmRotation);
+
+	XMMATRIX XmMatrix = XMMatrixMultiply(
+		XMMatrixMultiply(XMMatrixScalingFromVector(XmScale), XmRotationMatrix),
+		XMMatrixTranslationFromVector(XmTranslation));
+
+	// The inverse of scale, rotation and translation is built directly instead of using a general inverse
+	XMMATRIX XmMatrixInv = XMMatrixMultiply(
+		XMMatrixMultiply(XMMatrixTranslationFromVector(XMVectorNegate(XmTranslation)), XMMatrixTranspose(XmRotationMatrix)),
+		XMMatrixScalingFromVector(XMVectorReciprocal(XmScale)));
+
+	if (ParentMatrix)
+	{
+		VALIDATE(ParentMatrixInv != nullptr);
+
+		XMMATRIX XmParent		= XMMatrixTranspose(XMLoadFloat4x4(ParentMatrix));
+		XMMATRIX XmParentInv	= XMMatrixTranspose(XMLoadFloat4x4(ParentMatrixInv));
+		XmMatrix	= XMMatrixMultiply(XmMatrix, XmParent);
+		XmMatrixInv	= XMMatrixMultiply(XmParentInv, XmMatrixInv);
+	}
+
+	XMStoreFloat4x4(&OutMatrix, XMMatrixTranspose(XmMatrix));
+	XMStoreFloat4x4(&OutMatrixInv, XMMatrixTranspose(XmMatrixInv));
+}
+
+UInt32 TransformHierarchy::AllocateVersions(UInt32 Count)
+{
+	return GlobalTransformVersion.fetch_add(Count, std::memory_order_relaxed);
+}
+
+void TransformHierarchy::Sort()
+{
+	// Depth is the number of ancestors, stored in slot order
+	TArray<UInt32> ActorDepths(Actors.Size());
+
+	UInt32 MaxDepth = 0;
+	for (UInt32 Index = 0; Index < Actors.Size(); Index++)
+	{
+		UInt32 Depth = 0;
+		for (Actor* Ancestor = Actors[Index]->GetParent(); Ancestor; Ancestor = Ancestor->GetParent())
+		{
+			Depth++;
+		}
+
+		ActorDepths[Index] = Depth;
+		MaxDepth = std::max(MaxDepth, Depth);
+	}
+
+	// Counting sort by depth
+	LevelOffsets.Resize(MaxDepth + 2);
+	for (UInt32& Offset : LevelOffsets)
+	{
+		Offset = 0;
+	}
+
+	for (UInt32 Depth : ActorDepths)
+	{
+		LevelOffsets[Depth + 1]++;
+	}
+
+	for (UInt32 Level = 1; Level < LevelOffsets.Size(); Level++)
+	{
+		LevelOffsets[Level] += LevelOffsets[Level - 1];
+	}
+
+	// Old slot of each new slot
+	TArray<UInt32> WriteOffsets = LevelOffsets;
+	TArray<UInt32> Order(Actors.Size());
+	for (UInt32 Index = 0; Index < Actors.Size(); Index++)
+	{
+		Order[WriteOffsets[ActorDepths[Index]]++] = Index;
+	}
+
+	Reorder(Actors, Order);
+	Reorder(Translations, Order);
+	Reorder(Rotations, Order);
+	Reorder(Scales, Order);
+	Reorder(Matrices, Order);
+	Reorder(MatrixInverses, Order);
+	Reorder(Versions, Order);
+	Reorder(DirtyFlags, Order);
+
+	// Parents are always stored before their children, so their slots are already updated
+	ParentIndices.Resize(Actors.Size());
+	for (UInt32 Index = 0; Index < Actors.Size(); Index++)
+	{
+		Actor* CurrentActor = Actors[Index];
+		CurrentActor->GetTransform().Slot = Index;
+
+		Actor* Parent = CurrentActor->GetParent();
+		if (Parent)
+		{
+			const Transform& ParentTransform = Parent->GetTransform();
+			VALIDATE(ParentTransform.Hierarchy == this);
+			VALIDATE(ParentTransform.Slot < Index);
+
+			ParentIndices[Index] = ParentTransform.Slot;
+		}
+		else
+		{
+			ParentIndices[Index] = TRANSFORM_HIERARCHY_NO_PARENT;
+		}
+	}
+
+	// Actors that changed parent are marked as dirty by Actor::SetParent
+	UpdatedFlags.Resize(Actors.Size());
+	IsSorted = true;
+}
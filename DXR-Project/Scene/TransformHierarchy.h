@@ -0,0 +1,82 @@
+#pragma once
+#include "Containers/TArray.h"
+
+#include <DirectXMath.h>
+
+#define TRANSFORM_HIERARCHY_NO_PARENT	(~0u)
+
+class Actor;
+class Transform;
+
+/*
+* TransformHierarchy - Owns the transforms of the actors in a scene and updates their world matrices once per frame.
+* Local translation, rotation and scale, the world matrices and the flags are stored in separate arrays sorted by depth,
+* each transform in the hierarchy reads and writes its slot in these arrays. Each level is updated in parallel after the
+* level above it. A transform is recalculated when it is dirty or when its parent was recalculated.
+*/
+
+class TransformHierarchy
+{
+	friend class Transform;
+
+public:
+	TransformHierarchy();
+	~TransformHierarchy() = default;
+
+	// Copies the actor's transform into a new slot, the transform refers to the slot from now on
+	void AddActor(Actor* InActor);
+
+	// Must be called when the parent of an actor in the hierarchy changes
+	void OnParentChanged();
+
+	void Update();
+
+	FORCEINLINE UInt32 GetNumLevels() const
+	{
+		return LevelOffsets.Size() > 0 ? (LevelOffsets.Size() - 1) : 0;
+	}
+
+	// Number of transforms that were recalculated during the last update
+	FORCEINLINE UInt32 GetNumUpdated() const
+	{
+		return NumUpdated;
+	}
+
+	// Calculates the transposed world matrix and its inverse from local translation, rotation and scale. The parent
+	// matrices are the transposed world matrices of the parent and can be nullptr
+	static void CalculateMatrices(
+		const XMFLOAT3& Translation,
+		const XMFLOAT3& Rotation,
+		const XMFLOAT3& Scale,
+		const XMFLOAT4X4* ParentMatrix,
+		const XMFLOAT4X4* ParentMatrixInv,
+		XMFLOAT4X4& OutMatrix,
+		XMFLOAT4X4& OutMatrixInv);
+
+private:
+	void Sort();
+
+	// Reserves Count unique transform versions, returns the version before the first one
+	static UInt32 AllocateVersions(UInt32 Count);
+
+	// Updates the transforms in [Begin, End), the parents must already be up to date
+	void UpdateRange(UInt32 Begin, UInt32 End);
+
+	// Indexed by slot, sorted by depth after Sort
+	TArray<Actor*>		Actors;
+	TArray<XMFLOAT3>	Translations;
+	TArray<XMFLOAT3>	Rotations;
+	TArray<XMFLOAT3>	Scales;
+	TArray<XMFLOAT4X4>	Matrices;
+	TArray<XMFLOAT4X4>	MatrixInverses;
+	TArray<UInt32>		Versions;
+	TArray<UInt32>		ParentIndices;
+	TArray<UInt8>		DirtyFlags;
+	TArray<UInt8>		UpdatedFlags;
+
+	// First slot of each level, the last element is the number of slots
+	TArray<UInt32> LevelOffsets;
+
+	UInt32 NumUpdated	= 0;
+	bool IsSorted		= true;
+};
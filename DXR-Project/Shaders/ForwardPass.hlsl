@@ -222,13 +222,23 @@ float CalculatePointLightShadow(float3 WorldPosition, float3 LightPosition, floa
 }
 
 // VertexShader
+#if ENABLE_PACKED_VERTICES
+struct VSInput
+{
+	float4 Position	: POSITION0;
+	float2 Normal	: NORMAL0;
+	float2 Tangent	: TANGENT0;
+	float2 TexCoord	: TEXCOORD0;
+};
+#else
 struct VSInput
 {
 	float3 Position	: POSITION0;
 	float3 Normal	: NORMAL0;
-	float3 Tangent	: TANGENT0;
+	float4 Tangent	: TANGENT0;
 	float2 TexCoord	: TEXCOORD0;
 };
+#endif
 
 struct VSOutput
 {
@@ -250,21 +260,33 @@ VSOutput VSMain(VSInput Input)
 {
 	VSOutput Output;
 	
-	float3 Normal = normalize(mul(float4(Input.Normal, 0.0f), TransformBuffer.Transform).xyz);
+#if ENABLE_PACKED_VERTICES
+	const float3 Position	= DequantizePosition(Input.Position, TransformBuffer.Quantization);
+	const float3 InNormal	= DecodeOctahedral(Input.Normal);
+	const float3 InTangent	= DecodeOctahedral(Input.Tangent);
+	const float TangentSign	= (Input.Position.w < 0.0f) ? -1.0f : 1.0f;
+#else
+	const float3 Position	= Input.Position;
+	const float3 InNormal	= Input.Normal;
+	const float3 InTangent	= Input.Tangent.xyz;
+	const float TangentSign	= (Input.Tangent.w < 0.0f) ? -1.0f : 1.0f;
+#endif
+
+	float3 Normal = normalize(mul(float4(InNormal, 0.0f), TransformBuffer.Transform).xyz);
 	Output.Normal = Normal;
 	
 #ifdef NORMAL_MAPPING_ENABLED
-	float3 Tangent	= normalize(mul(float4(Input.Tangent, 0.0f), TransformBuffer.Transform).xyz);
+	float3 Tangent	= normalize(mul(float4(InTangent, 0.0f), TransformBuffer.Transform).xyz);
 	Tangent			= normalize(Tangent - dot(Tangent, Normal) * Normal);
 	Output.Tangent	= Tangent;
 	
-	float3 Bitangent = normalize(cross(Output.Tangent, Output.Normal));
+	float3 Bitangent = normalize(cross(Output.Tangent, Output.Normal)) * TangentSign;
 	Output.Bitangent = Bitangent;
 #endif
 
 	Output.TexCoord = Input.TexCoord;
 
-	float4 WorldPosition	= mul(float4(Input.Position, 1.0f), TransformBuffer.Transform);
+	float4 WorldPosition	= mul(float4(Position, 1.0f), TransformBuffer.Transform);
 	Output.Position			= mul(WorldPosition, CameraBuffer.ViewProjection);
 	Output.WorldPosition	= WorldPosition.xyz;
 
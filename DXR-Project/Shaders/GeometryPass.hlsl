@@ -31,13 +31,23 @@ Texture2D<float4> MetallicMap	: register(t4, space0);
 Texture2D<float4> AOMap			: register(t5, space0);
 
 // VertexShader
+#if ENABLE_PACKED_VERTICES
+struct VSInput
+{
+	float4 Position : POSITION0;
+	float2 Normal	: NORMAL0;
+	float2 Tangent	: TANGENT0;
+	float2 TexCoord : TEXCOORD0;
+};
+#else
 struct VSInput
 {
 	float3 Position : POSITION0;
 	float3 Normal	: NORMAL0;
-	float3 Tangent	: TANGENT0;
+	float4 Tangent	: TANGENT0;
 	float2 TexCoord : TEXCOORD0;
 };
+#endif
 
 struct VSOutput
 {
@@ -58,22 +68,34 @@ VSOutput VSMain(VSInput Input)
 {
 	VSOutput Output;
 	
+#if ENABLE_PACKED_VERTICES
+	const float3 Position	= DequantizePosition(Input.Position, TransformBuffer.Quantization);
+	const float3 InNormal	= DecodeOctahedral(Input.Normal);
+	const float3 InTangent	= DecodeOctahedral(Input.Tangent);
+	const float TangentSign	= (Input.Position.w < 0.0f) ? -1.0f : 1.0f;
+#else
+	const float3 Position	= Input.Position;
+	const float3 InNormal	= Input.Normal;
+	const float3 InTangent	= Input.Tangent.xyz;
+	const float TangentSign	= (Input.Tangent.w < 0.0f) ? -1.0f : 1.0f;
+#endif
+
 	const float4x4 TransformInv = transpose(TransformBuffer.TransformInv);
-	float3 Normal = mul(float4(Input.Normal, 0.0f), TransformInv).xyz;
+	float3 Normal = mul(float4(InNormal, 0.0f), TransformInv).xyz;
 	Output.Normal = Normal;
 	
 #if defined(NORMAL_MAPPING_ENABLED) || defined(PARALLAX_MAPPING_ENABLED)
-	float3 Tangent	= normalize(mul(float4(Input.Tangent, 0.0f), TransformBuffer.Transform).xyz);
+	float3 Tangent	= normalize(mul(float4(InTangent, 0.0f), TransformBuffer.Transform).xyz);
 	Tangent			= normalize(Tangent - dot(Tangent, Normal) * Normal);
 	Output.Tangent	= Tangent;
 	
-	float3 Bitangent = normalize(cross(Output.Tangent, Output.Normal));
+	float3 Bitangent = normalize(cross(Output.Tangent, Output.Normal)) * TangentSign;
 	Output.Bitangent = Bitangent;
 #endif
 
 	Output.TexCoord = Input.TexCoord;
 
-	float4 WorldPosition	= mul(float4(Input.Position, 1.0f), TransformBuffer.Transform);
+	float4 WorldPosition	= mul(float4(Position, 1.0f), TransformBuffer.Transform);
 	Output.Position			= mul(WorldPosition, CameraBuffer.ViewProjection);
 	
 #ifdef PARALLAX_MAPPING_ENABLED
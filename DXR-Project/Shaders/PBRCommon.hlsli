@@ -1,3 +1,5 @@
+#include "PackedVertex.hlsli"
+
 /*
 * Common Constants
 */
@@ -60,7 +62,8 @@ struct Vertex
 {
 	float3 Position;
 	float3 Normal;
-	float3 Tangent;
+	// W is the handedness, Bitangent = cross(Normal, Tangent) * W
+	float4 Tangent;
 	float2 TexCoord;
 };
 
@@ -68,6 +71,9 @@ struct Transform
 {
 	float4x4 Transform;
 	float4x4 TransformInv;
+#if ENABLE_PACKED_VERTICES
+	VertexQuantization Quantization;
+#endif
 };
 
 struct Material
@@ -303,4 +309,20 @@ float3 PackNormal(float3 Normal)
 float3 WorldHitPosition()
 {
 	return WorldRayOrigin() + (RayTCurrent() * WorldRayDirection());
+}
+
+/*
+* Vertex Helpers
+*/
+
+// Used when the vertices are read from a buffer instead of the input assembler, the position stays quantized
+Vertex UnpackVertex(PackedVertex Packed)
+{
+	Vertex Result;
+	const float2 PositionZW = UnpackSnorm2(Packed.Position.y);
+	Result.Position	= float3(UnpackSnorm2(Packed.Position.x), PositionZW.x);
+	Result.Normal	= DecodeOctahedral(UnpackSnorm2(Packed.Normal));
+	Result.Tangent	= float4(DecodeOctahedral(UnpackSnorm2(Packed.Tangent)), (PositionZW.y < 0.0f) ? -1.0f : 1.0f);
+	Result.TexCoord	= f16tof32(uint2(Packed.TexCoord, Packed.TexCoord >> 16));
+	return Result;
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+/*
+* Packed Vertices
+*/
+
+// Must match ENABLE_PACKED_VERTICES in MeshFactory.h
+#define ENABLE_PACKED_VERTICES 0
+
+struct PackedVertex
+{
+	uint2	Position;
+	uint	Normal;
+	uint	Tangent;
+	uint	TexCoord;
+};
+
+struct VertexQuantization
+{
+	float4 Scale;
+	float4 Offset;
+};
+
+float3 DequantizePosition(float4 Position, VertexQuantization Quantization)
+{
+	return Position.xyz * Quantization.Scale.xyz + Quantization.Offset.xyz;
+}
+
+float3 DecodeOctahedral(float2 Encoded)
+{
+	float3 Direction = float3(Encoded, 1.0f - abs(Encoded.x) - abs(Encoded.y));
+	float Fold = saturate(-Direction.z);
+	Direction.xy += (Direction.xy >= 0.0f) ? -Fold : Fold;
+	return normalize(Direction);
+}
+
+float2 UnpackSnorm2(uint Packed)
+{
+	int2 Value = int2(Packed << 16, Packed) >> 16;
+	return max(float2(Value) / 32767.0f, -1.0f);
+}
@@ -4,22 +4,41 @@
 cbuffer TransformBuffer : register(b0, space0)
 {
 	float4x4 Transform;
+#if ENABLE_PACKED_VERTICES
+	VertexQuantization Quantization;
+#endif
 };
 
 // PerFrame DescriptorTable
 ConstantBuffer<Camera> Camera : register(b1, space0);
 
 // VertexShader
+#if ENABLE_PACKED_VERTICES
+struct VSInput
+{
+	float4 Position : POSITION0;
+	float2 Normal   : NORMAL0;
+	float2 Tangent  : TANGENT0;
+	float2 TexCoord : TEXCOORD0;
+};
+#else
 struct VSInput
 {
 	float3 Position : POSITION0;
 	float3 Normal   : NORMAL0;
-	float3 Tangent  : TANGENT0;
+	float4 Tangent  : TANGENT0;
 	float2 TexCoord : TEXCOORD0;
 };
+#endif
 
 float4 Main(VSInput Input) : SV_POSITION
 {
-	float4 WorldPosition = mul(float4(Input.Position, 1.0f), Transform);
+#if ENABLE_PACKED_VERTICES
+	const float3 Position = DequantizePosition(Input.Position, Quantization);
+#else
+	const float3 Position = Input.Position;
+#endif
+
+	float4 WorldPosition = mul(float4(Position, 1.0f), Transform);
 	return mul(WorldPosition, Camera.ViewProjection);
 }
\ No newline at end of file
@@ -32,9 +32,29 @@ Texture2D<float4> HeightMap		: register(t3, space1);
 Texture2D<float4> MetallicMap	: register(t4, space1);
 Texture2D<float4> AOMap			: register(t5, space1);
 
-StructuredBuffer<Vertex>	Vertices	: register(t6, space1);
+#if ENABLE_PACKED_VERTICES
+StructuredBuffer<PackedVertex>	PackedVertices	: register(t6, space1);
+#else
+StructuredBuffer<Vertex>		Vertices		: register(t6, space1);
+#endif
 ByteAddressBuffer			InIndices	: register(t7, space1);
 
+// Helpers
+uint3 Load16BitIndices(uint Offset)
+{
+	// Raw buffers can only be read in aligned 32-bit words
+	const uint AlignedOffset	= Offset & ~3;
+	const uint2 Words			= InIndices.Load2(AlignedOffset);
+	if (AlignedOffset == Offset)
+	{
+		return uint3(Words.x & 0xffff, Words.x >> 16, Words.y & 0xffff);
+	}
+	else
+	{
+		return uint3(Words.x >> 16, Words.y & 0xffff, Words.y >> 16);
+	}
+}
+
 // Shaders
 struct RayPayload
 {
@@ -100,14 +120,25 @@ void Miss(inout RayPayload PayLoad)
 [shader("closesthit")]
 void ClosestHit(inout RayPayload PayLoad, in BuiltInTriangleIntersectionAttributes IntersectionAttributes)
 {
-	// Get the base index of the triangle's first 16 bit index.
-	const uint IndexSizeInBytes		= 4;
+	// Get the offset of the triangle's first index, the InstanceID is the size of the indices in bytes
+	const uint IndexSizeInBytes		= InstanceID();
 	const uint IndicesPerTriangle	= 3;
 	const uint TriangleIndexStride	= IndicesPerTriangle * IndexSizeInBytes;
 	const uint BaseIndex			= PrimitiveIndex() * TriangleIndexStride;
 
 	// Load up three indices for the triangle.
-	uint3 Indices = InIndices.Load3(BaseIndex);
+	uint3 Indices = (IndexSizeInBytes == 2) ? Load16BitIndices(BaseIndex) : InIndices.Load3(BaseIndex);
+
+#if ENABLE_PACKED_VERTICES
+	// Only the vertices of this triangle are unpacked, so they are indexed locally
+	const Vertex Vertices[3] =
+	{
+		UnpackVertex(PackedVertices[Indices[0]]),
+		UnpackVertex(PackedVertices[Indices[1]]),
+		UnpackVertex(PackedVertices[Indices[2]])
+	};
+	Indices = uint3(0, 1, 2);
+#endif
 
 	// Retrieve corresponding vertex normals for the triangle vertices.
 	float3 TriangleNormals[3] =
@@ -122,7 +153,7 @@ void ClosestHit(inout RayPayload PayLoad, in BuiltInTriangleIntersectionAttribut
 	float3 Normal = (TriangleNormals[0] * BarycentricCoords.x) + (TriangleNormals[1] * BarycentricCoords.y) + (TriangleNormals[2] * BarycentricCoords.z);
 	Normal = normalize(Normal);
 	
-	float3 TriangleTangent[3] =
+	float4 TriangleTangent[3] =
 	{
 		Vertices[Indices[0]].Tangent,
 		Vertices[Indices[1]].Tangent,
@@ -141,16 +172,17 @@ void ClosestHit(inout RayPayload PayLoad, in BuiltInTriangleIntersectionAttribut
 		(TriangleTexCoords[1] * BarycentricCoords.y) + 
 		(TriangleTexCoords[2] * BarycentricCoords.z);
 	
-	float3 Tangent = 
+	float4 InterpolatedTangent = 
 		(TriangleTangent[0] * BarycentricCoords.x) + 
 		(TriangleTangent[1] * BarycentricCoords.y) + 
 		(TriangleTangent[2] * BarycentricCoords.z);
-	Tangent = normalize(Tangent);
+	float3 Tangent		= normalize(InterpolatedTangent.xyz);
+	float TangentSign	= (InterpolatedTangent.w < 0.0f) ? -1.0f : 1.0f;
 
 	float3 MappedNormal = NormalMap.SampleLevel(TextureSampler, TexCoords, 0).rgb;
 	MappedNormal = UnpackNormal(MappedNormal);
 	
-	float3 Bitangent = normalize(cross(Normal, Tangent));
+	float3 Bitangent = normalize(cross(Normal, Tangent)) * TangentSign;
 	Normal = ApplyNormalMapping(MappedNormal, Normal, Tangent, Bitangent);
 	
 	float3 AlbedoColor = AlbedoMap.SampleLevel(TextureSampler, TexCoords, 0).rgb;
@@ -1,7 +1,12 @@
+#include "PackedVertex.hlsli"
+
 // PerObject
 cbuffer TransformBuffer : register(b0, space0)
 {
 	float4x4 Transform;
+#if ENABLE_PACKED_VERTICES
+	VertexQuantization Quantization;
+#endif
 	float ShadowOffset;
 };
 
@@ -14,19 +19,49 @@ cbuffer LightBuffer : register(b1, space0)
 }
 
 // VS
+#if ENABLE_PACKED_VERTICES
+struct VSInput
+{
+	float4 Position : POSITION0;
+	float2 Normal	: NORMAL0;
+	float2 Tangent	: TANGENT0;
+	float2 TexCoord : TEXCOORD0;
+};
+
+float3 GetPosition(VSInput Input)
+{
+	return DequantizePosition(Input.Position, Quantization);
+}
+
+float3 GetNormal(VSInput Input)
+{
+	return DecodeOctahedral(Input.Normal);
+}
+#else
 struct VSInput
 {
 	float3 Position : POSITION0;
 	float3 Normal	: NORMAL0;
-	float3 Tangent	: TANGENT0;
+	float4 Tangent	: TANGENT0;
 	float2 TexCoord : TEXCOORD0;
 };
 
+float3 GetPosition(VSInput Input)
+{
+	return Input.Position;
+}
+
+float3 GetNormal(VSInput Input)
+{
+	return normalize(Input.Normal);
+}
+#endif
+
 // Normal ShadowMap Generation
 float4 Main(VSInput Input) : SV_POSITION
 {
-	float3 Normal	= normalize(Input.Normal);
-    float3 Position = Input.Position + (Normal * ShadowOffset);
+	float3 Normal	= GetNormal(Input);
+    float3 Position = GetPosition(Input) + (Normal * ShadowOffset);
 	
 	float4 WorldPosition = mul(float4(Position, 1.0f), Transform);
 	return mul(WorldPosition, LightProjection);
@@ -43,7 +78,7 @@ VSOutput VSMain(VSInput Input)
 {
 	VSOutput Output = (VSOutput)0;
 	
-	float4 WorldPosition	= mul(float4(Input.Position, 1.0f), Transform);
+	float4 WorldPosition	= mul(float4(GetPosition(Input), 1.0f), Transform);
 	Output.WorldPosition	= WorldPosition.xyz;
 	Output.Position			= mul(WorldPosition, LightProjection);
 	
@@ -60,7 +95,7 @@ float PSMain(float3 WorldPosition : POSITION0) : SV_Depth
 // Variance Shadow Generation
 float4 VSM_VSMain(VSInput Input) : SV_Position
 {
-	float4 WorldPosition = mul(float4(Input.Position, 1.0f), Transform);
+	float4 WorldPosition = mul(float4(GetPosition(Input), 1.0f), Transform);
 	return mul(WorldPosition, LightProjection);
 }
 
@@ -14,7 +14,7 @@ struct VSInput
 {
 	float3 Position	: POSITION0;
 	float3 Normal	: NORMAL0;
-	float3 Tangent	: TANGENT0;
+	float4 Tangent	: TANGENT0;
 	float2 TexCoord	: TEXCOORD0;
 };
 
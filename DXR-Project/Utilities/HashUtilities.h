@@ -1,6 +1,7 @@
 #pragma once
 #include <utility>
 #include <functional>
+#include <cstring>
 
 /*
 * HashHelpers
@@ -13,6 +14,89 @@ inline void HashCombine(size_t& OutHash, const T& Value)
 	OutHash ^= Hasher(Value) + 0x9e3779b9 + (OutHash << 6) + (OutHash >> 2);
 }
 
+/*
+* HashMemory - 64-bit hash of a block of memory (XXH64), four independent lanes keep it close to memory speed so that
+* whole files can be hashed
+*/
+
+inline UInt64 HashMemory(const Void* Data, UInt64 Size, UInt64 Seed = 0)
+{
+	constexpr UInt64 Prime1 = 0x9e3779b185ebca87ull;
+	constexpr UInt64 Prime2 = 0xc2b2ae3d27d4eb4full;
+	constexpr UInt64 Prime3 = 0x165667b19e3779f9ull;
+	constexpr UInt64 Prime4 = 0x85ebca77c2b2ae63ull;
+	constexpr UInt64 Prime5 = 0x27d4eb2f165667c5ull;
+
+	auto Rotate = [](UInt64 Value, UInt32 Bits)
+	{
+		return (Value << Bits) | (Value >> (64 - Bits));
+	};
+
+	auto Round = [&](UInt64 Accumulator, UInt64 Input)
+	{
+		return Rotate(Accumulator + Input * Prime2, 31) * Prime1;
+	};
+
+	auto Read64 = [](const Byte* Ptr)
+	{
+		UInt64 Value;
+		memcpy(&Value, Ptr, sizeof(Value));
+		return Value;
+	};
+
+	const Byte* It	= reinterpret_cast<const Byte*>(Data);
+	const Byte* End	= It + Size;
+
+	UInt64 Hash = 0;
+	if (Size >= 32)
+	{
+		UInt64 Lanes[4] = { Seed + Prime1 + Prime2, Seed + Prime2, Seed, Seed - Prime1 };
+		for (; It + 32 <= End; It += 32)
+		{
+			Lanes[0] = Round(Lanes[0], Read64(It + 0));
+			Lanes[1] = Round(Lanes[1], Read64(It + 8));
+			Lanes[2] = Round(Lanes[2], Read64(It + 16));
+			Lanes[3] = Round(Lanes[3], Read64(It + 24));
+		}
+
+		Hash = Rotate(Lanes[0], 1) + Rotate(Lanes[1], 7) + Rotate(Lanes[2], 12) + Rotate(Lanes[3], 18);
+		for (UInt64 Lane : Lanes)
+		{
+			Hash = (Hash ^ Round(0, Lane)) * Prime1 + Prime4;
+		}
+	}
+	else
+	{
+		Hash = Seed + Prime5;
+	}
+
+	Hash += Size;
+	for (; It + 8 <= End; It += 8)
+	{
+		Hash = Rotate(Hash ^ Round(0, Read64(It)), 27) * Prime1 + Prime4;
+	}
+
+	if (It + 4 <= End)
+	{
+		UInt32 Value;
+		memcpy(&Value, It, sizeof(Value));
+		Hash = Rotate(Hash ^ (static_cast<UInt64>(Value) * Prime1), 23) * Prime2 + Prime3;
+		It += 4;
+	}
+
+	for (; It < End; It++)
+	{
+		Hash = Rotate(Hash ^ (static_cast<UInt64>(*It) * Prime5), 11) * Prime1;
+	}
+
+	Hash ^= Hash >> 33;
+	Hash *= Prime2;
+	Hash ^= Hash >> 29;
+	Hash *= Prime3;
+	Hash ^= Hash >> 32;
+	return Hash;
+}
+
 /*
 * std::hash for DirectXMath
 */
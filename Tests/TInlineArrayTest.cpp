@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+
+#include "Containers/TInlineArray.h"
+
+/*
+* TCountingAllocator - TInlineArrayAllocator that counts the heap allocations made by the array
+*/
+
+static UInt32 NumAllocations	= 0;
+static UInt32 NumFrees			= 0;
+
+template<typename T, UInt32 InlineCapacity>
+class TCountingAllocator : public TInlineArrayAllocator<T, InlineCapacity>
+{
+public:
+	FORCEINLINE T* AllocateElements(UInt32 Capacity) noexcept
+	{
+		NumAllocations++;
+		return TInlineArrayAllocator<T, InlineCapacity>::AllocateElements(Capacity);
+	}
+
+	FORCEINLINE void FreeElements(T* Elements) noexcept
+	{
+		if (Elements)
+		{
+			NumFrees++;
+		}
+
+		TInlineArrayAllocator<T, InlineCapacity>::FreeElements(Elements);
+	}
+};
+
+template<typename T, UInt32 InlineCapacity>
+using TCountingInlineArray = TArray<T, TCountingAllocator<T, InlineCapacity>>;
+
+#define CHECK(Condition) \
+	if (!(Condition)) \
+	{ \
+		printf("FAILED: %s (line %d)\n", #Condition, __LINE__); \
+		return false; \
+	}
+
+/*
+* Tests
+*/
+
+// Filling, copying, moving, inserting and shrinking an array that fits never touches the heap
+static bool TestNoAllocationsWhileInline()
+{
+	NumAllocations = 0;
+
+	TCountingInlineArray<Int32, 8> Array;
+	for (Int32 Index = 0; Index < 8; Index++)
+	{
+		Array.EmplaceBack(Index);
+	}
+
+	TCountingInlineArray<Int32, 8> Copy = Array;
+	TCountingInlineArray<Int32, 8> Moved = Move(Copy);
+	Moved.Erase(Moved.Begin());
+	Moved.Insert(Moved.Begin() + 2, 42);
+
+	Array.Resize(3);
+	Array.ShrinkToFit();
+	Array.Reserve(2);
+
+	CHECK(NumAllocations == 0);
+	CHECK(Array.Size() == 3 && Array.Capacity() == 8 && Array[2] == 2);
+	CHECK(Moved.Size() == 8 && Moved[0] == 1 && Moved[2] == 42);
+	CHECK(Copy.Size() == 0);
+	return true;
+}
+
+// Growing past the inline storage allocates, moving steals the allocation and shrinking goes back to the inline storage
+static bool TestSpillToHeap()
+{
+	NumAllocations	= 0;
+	NumFrees		= 0;
+
+	{
+		TCountingInlineArray<Int32, 4> Array;
+		for (Int32 Index = 0; Index < 100; Index++)
+		{
+			Array.PushBack(Index);
+		}
+
+		CHECK(NumAllocations > 0);
+		CHECK(Array.Size() == 100 && Array[99] == 99);
+
+		const UInt32 AllocationsBeforeMove = NumAllocations;
+		TCountingInlineArray<Int32, 4> Moved = Move(Array);
+		CHECK(NumAllocations == AllocationsBeforeMove);
+		CHECK(Array.Size() == 0 && Array.Capacity() == 4 && Moved.Size() == 100);
+
+		Moved.Resize(3);
+		Moved.ShrinkToFit();
+		CHECK(Moved.Capacity() == 4 && Moved[2] == 2);
+	}
+
+	CHECK(NumAllocations == NumFrees);
+	return true;
+}
+
+// The common case in the engine, an actor with two components or a small batch of barriers
+static bool TestTypicalSizes()
+{
+	NumAllocations = 0;
+
+	for (UInt32 Iteration = 0; Iteration < 10000; Iteration++)
+	{
+		TCountingInlineArray<Void*, 4> Array;
+		Array.EmplaceBack(nullptr);
+		Array.EmplaceBack(nullptr);
+	}
+
+	CHECK(NumAllocations == 0);
+	return true;
+}
+
+/*
+* Main
+*/
+
+int main()
+{
+	struct TestCase
+	{
+		const Char* Name;
+		bool(*Func)();
+	};
+
+	const TestCase Tests[] =
+	{
+		{ "NoAllocationsWhileInline",	TestNoAllocationsWhileInline },
+		{ "SpillToHeap",				TestSpillToHeap },
+		{ "TypicalSizes",				TestTypicalSizes },
+	};
+
+	Int32 NumFailed = 0;
+	for (const TestCase& Test : Tests)
+	{
+		const bool Passed = Test.Func();
+		printf("%s: %s\n", Test.Name, Passed ? "Passed" : "Failed");
+		NumFailed += Passed ? 0 : 1;
+	}
+
+	return NumFailed;
+}
@@ -160,4 +160,68 @@ workspace "DXR-Project"
 			"%{prj.name}",
 			"%{prj.name}/Include",
         }
+
+	-- Tests
+	group "Tests"
+		project "ContainerTests"
+			language 		"C++"
+			cppdialect 		"C++17"
+			systemversion 	"latest"
+			location 		"Tests"
+			kind 			"ConsoleApp"
+			characterset 	"Ascii"
+
+			-- Targets
+			targetdir 	("Build/bin/" .. outputdir .. "/%{prj.name}")
+			objdir 		("Build/bin-int/" .. outputdir .. "/%{prj.name}")
+
+			-- Files
+			files
+			{
+				"Tests/**.cpp",
+			}
+
+			-- Includes
+			includedirs
+			{
+				"DXR-Project",
+			}
+
+		project "JobSystemBenchmark"
+			language 		"C++"
+			cppdialect 		"C++17"
+			systemversion 	"latest"
+			location 		"Benchmarks"
+			kind 			"ConsoleApp"
+			characterset 	"Ascii"
+
+			-- Targets
+			targetdir 	("Build/bin/" .. outputdir .. "/%{prj.name}")
+			objdir 		("Build/bin-int/" .. outputdir .. "/%{prj.name}")
+
+			-- The engine PCH pulls in D3D12, the benchmark only needs the core headers
+			forceincludes
+			{
+				"BenchmarkPreCompiled.h",
+			}
+
+			-- Files
+			files
+			{
+				"Benchmarks/**.h",
+				"Benchmarks/**.cpp",
+				"DXR-Project/Core/JobSystem.cpp",
+			}
+
+			-- Includes
+			includedirs
+			{
+				"Benchmarks",
+				"DXR-Project",
+			}
+
+			-- Always optimize, the numbers are meaningless otherwise
+			optimize "On"
+	group ""
+
     project "*"
\ No newline at end of file